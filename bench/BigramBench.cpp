@@ -0,0 +1,96 @@
+/* BigramBench.cpp
+   Cost of ranking suggestions in context with a bigram model.
+*/
+
+#include "../src/Suggest.hpp"
+#include "../src/BigramModel.hpp"
+#include <random>
+#include <chrono>
+#include <iomanip>
+
+/*! Misspells a word with one random substitution.
+  \param w The word to misspell.
+  \param rng The random number generator to use.
+  \return The misspelled word.
+*/
+static std::string misspell(std::string w, std::mt19937& rng) {
+	std::uniform_int_distribution<std::size_t> pos(0, w.size() - 1);
+	std::uniform_int_distribution<int> letter('a', 'z');
+	w[pos(rng)] = letter(rng);
+	return w;
+} // misspell
+
+int main(int argc, char** argv) {
+	if(argc < 3) {
+		std::cerr << "Usage: " << argv[0] << " MODELFILE CORPUSFILE [QUERIES]" << std::endl;
+		return 1;
+	}
+	const unsigned int queryCount(argc > 3 ? std::stoi(argv[3]) : 300);
+	auto start(std::chrono::steady_clock::now());
+	const BigramModel model(argv[1]);
+	const std::chrono::duration<double, std::micro> opened(std::chrono::steady_clock::now() - start);
+	std::cout << argv[1] << ": " << model.getWords() << " words, " << model.getPairs() << " pairs, "
+		  << std::fixed << std::setprecision(1) << 8.0 * model.getBytes() / std::max(1u, model.getPairs())
+		  << " bits per pair, opened in " << opened.count() << " us" << std::endl;
+	if(model.getWords() == 0) {
+		return 1;
+	}
+
+// scoring alone: lists of random candidates after random words
+	std::mt19937 rng(772451);
+	std::uniform_int_distribution<unsigned int> word(0, model.getWords() - 1);
+	std::cout << "candidates\tus/score" << std::endl;
+	for(unsigned int size(10); size <= 1000; size *= 10) {
+		std::vector<unsigned int> candidates(size);
+		std::vector<float> logProbs(size);
+		double found(0);
+		start = std::chrono::steady_clock::now();
+		for(unsigned int q(0); q < queryCount; ++q) {
+			for(auto c(candidates.begin()); c != candidates.end(); ++c) {
+				*c = word(rng);
+			}
+			model.score(word(rng), candidates.data(), size, logProbs.data());
+			for(auto l(logProbs.cbegin()); l != logProbs.cend(); ++l) {
+				found += *l != BigramModel::absent;
+			}
+		}
+		const std::chrono::duration<double, std::micro> elapsed(std::chrono::steady_clock::now() - start);
+		std::cout << size << '\t' << std::setprecision(2) << elapsed.count() / queryCount
+			  << "\t(" << found << " pairs found)" << std::endl;
+	} // for size
+
+// whole searches, with and without ranking in context
+	SuggestOptions plain(1), context(1);
+	context.bigrams = &model;
+	ProbabilitySuggest withoutModel(argv[2], plain), withModel(argv[2], context);
+	std::vector<std::string> words;
+	{
+		std::ifstream corpus(argv[2]);
+		for(std::string line; std::getline(corpus, line);) {
+			const std::size_t tab(line.find('\t'));
+			if(tab != std::string::npos && tab > 1) words.push_back(line.substr(0, tab));
+		}
+	}
+	std::uniform_int_distribution<std::size_t> pick(0, words.size() - 1);
+	std::vector<std::string> queries;
+	for(unsigned int q(0); q < queryCount; ++q) {
+		queries.push_back(misspell(words[pick(rng)], rng));
+	}
+	std::cout << "search\tus/word\tresults" << std::endl;
+	unsigned long results(0);
+	start = std::chrono::steady_clock::now();
+	for(auto q(queries.cbegin()); q != queries.cend(); ++q) {
+		results += withoutModel.ranked(*q).size();
+	}
+	std::chrono::duration<double, std::micro> elapsed(std::chrono::steady_clock::now() - start);
+	std::cout << "ranked\t" << elapsed.count() / queries.size() << '\t' << results << std::endl;
+	results = 0;
+	unsigned int previous(BigramModel::unknownWord);
+	start = std::chrono::steady_clock::now();
+	for(auto q(queries.cbegin()); q != queries.cend(); ++q) {
+		results += withModel.rankedInContext(*q, previous).size();
+	}
+	elapsed = std::chrono::steady_clock::now() - start;
+	std::cout << "in context\t" << elapsed.count() / queries.size() << '\t' << results << std::endl;
+	return 0;
+}
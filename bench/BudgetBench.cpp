@@ -0,0 +1,94 @@
+/* BudgetBench.cpp
+   Latency percentiles and result quality of searches within a budget
+   of search items or time.
+*/
+
+#include "../src/Suggest.hpp"
+#include <random>
+#include <chrono>
+#include <iomanip>
+
+//! A limit for all searches of one row of the output.
+struct Limit {
+	const char* name; /*!< For the output. */
+	unsigned long items; /*!< Items per search, or 0. */
+	long micros; /*!< Microseconds per search, or 0. */
+};
+
+int main(int argc, char** argv) {
+	if(argc < 2) {
+		std::cerr << "Usage: " << argv[0] << " CORPUSFILE [QUERIES] [EDITDISTANCE]" << std::endl;
+		return 1;
+	}
+	const unsigned int queryCount(argc > 2 ? std::stoi(argv[2]) : 200);
+	const unsigned int editDistance(argc > 3 ? std::stoi(argv[3]) : 3);
+	const ProbabilitySuggest dictionary(argv[1], editDistance);
+	std::vector<std::string> words;
+	{
+		std::ifstream corpus(argv[1]);
+		for(std::string line; std::getline(corpus, line);) {
+			const std::string word(line.substr(0, line.find('\t')));
+			if(word.size() >= 8) words.push_back(word);
+		}
+	}
+	if(words.empty()) {
+		std::cerr << "No long words in '" << argv[1] << "'." << std::endl;
+		return 1;
+	}
+// long words with two substitutions, the expensive end of the queries
+	std::mt19937 rng(772451);
+	std::uniform_int_distribution<std::size_t> pick(0, words.size() - 1);
+	std::uniform_int_distribution<int> letter('a', 'z');
+	std::vector<std::string> queries;
+	std::vector<std::vector<ProbabilitySuggest::result_type>> full;
+	for(unsigned int q(0); q < queryCount; ++q) {
+		std::string query(words[pick(rng)]);
+		query[q % query.size()] = letter(rng);
+		query[(q + 3) % query.size()] = letter(rng);
+		queries.push_back(query);
+		full.push_back(dictionary.ranked(query));
+	}
+
+	const Limit limits[] = {
+		{"none", 0, 0}, {"100000 items", 100000, 0}, {"10000 items", 10000, 0}, {"1000 items", 1000, 0},
+		{"10 ms", 0, 10000}, {"1 ms", 0, 1000}, {"100 us", 0, 100}
+	};
+	std::cout << argv[1] << ": " << queries.size() << " queries at edit distance " << editDistance << std::endl;
+	std::cout << "budget\tp50 us\tp99 us\tmax us\tincomplete\tsame best" << std::endl;
+	bool sound(true);
+	for(auto l(std::begin(limits)); l != std::end(limits); ++l) {
+		std::vector<double> latencies;
+		unsigned int incomplete(0), sameBest(0);
+		for(std::size_t q(0); q < queries.size(); ++q) {
+			const auto start(std::chrono::steady_clock::now());
+			SearchBudget budget(l->items, std::chrono::microseconds(l->micros));
+			const auto v(dictionary.ranked(queries[q], budget));
+			const std::chrono::duration<double, std::micro> elapsed(std::chrono::steady_clock::now() - start);
+			latencies.push_back(elapsed.count());
+			incomplete += budget.exhausted ? 1 : 0;
+// the best suggestion may be any of several that rank equally
+			sameBest += (v.empty() && full[q].empty())
+				|| (!v.empty() && !full[q].empty() && !ProbabilitySuggest::isBetter(full[q].front(), v.front()));
+// what is below completeBelow must be all there is below it
+			const unsigned int below(budget.exhausted ? budget.completeBelow : ~0u);
+			std::vector<std::string> partial, expected;
+			for(auto r(v.cbegin()); r != v.cend(); ++r) {
+				if(r->editDistance < below) partial.push_back(r->first);
+			}
+			for(auto r(full[q].cbegin()); r != full[q].cend(); ++r) {
+				if(r->editDistance < below) expected.push_back(r->first);
+			}
+			std::sort(partial.begin(), partial.end());
+			std::sort(expected.begin(), expected.end());
+			sound = sound && partial == expected;
+		}
+		std::sort(latencies.begin(), latencies.end());
+		std::cout << l->name << '\t' << std::fixed << std::setprecision(0) << latencies[latencies.size() / 2] << '\t'
+			  << latencies[latencies.size() * 99 / 100] << '\t' << latencies.back() << '\t'
+			  << incomplete << '\t' << sameBest << std::endl;
+	}
+	if(!sound) {
+		std::cout << "incomplete searches missed suggestions below completeBelow" << std::endl;
+	}
+	return sound ? 0 : 1;
+}
@@ -0,0 +1,129 @@
+/* BufferBench.cpp
+   Suggest::all into a reused Buffer against Suggest::all returning a
+   new vector: the time per query, and the allocations per query once
+   the Buffer has grown. Exits with 1 if the Buffer still allocates.
+*/
+
+#include "../src/Suggest.hpp"
+#include <random>
+#include <chrono>
+#include <iomanip>
+#include <atomic>
+#include <new>
+#include <cstdlib>
+
+//! The number of calls of operator new so far.
+static std::atomic<unsigned long> allocations(0);
+
+void* operator new(std::size_t size) {
+	++allocations;
+	void* p(std::malloc(size ? size : 1));
+	if(!p) {
+		throw std::bad_alloc();
+	}
+	return p;
+}
+
+// the memory of new expressions goes to free on purpose, as the
+// operator new above took it from malloc
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+void operator delete(void* p) noexcept {
+	std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+	std::free(p);
+}
+#pragma GCC diagnostic pop
+
+/*! Misspells a word with one random substitution.
+  \param w The word to misspell.
+  \param rng The random number generator to use.
+  \return The misspelled word.
+*/
+static std::string misspell(std::string w, std::mt19937& rng) {
+	std::uniform_int_distribution<std::size_t> pos(0, w.size() - 1);
+	std::uniform_int_distribution<int> letter('a', 'z');
+	w[pos(rng)] = letter(rng);
+	return w;
+} // misspell
+
+int main(int argc, char** argv) {
+	if(argc < 2) {
+		std::cerr << "Usage: " << argv[0] << " CORPUSFILE [QUERIES] [ROUNDS]" << std::endl;
+		return 1;
+	}
+	const unsigned int queryCount(argc > 2 ? std::stoi(argv[2]) : 500);
+	const unsigned int rounds(argc > 3 ? std::stoi(argv[3]) : 5);
+	std::vector<std::string> words;
+	{
+		std::ifstream corpus(argv[1]);
+		for(std::string line; std::getline(corpus, line);) {
+			const std::size_t tab(line.find('\t'));
+			if(tab != std::string::npos && tab > 0) words.push_back(line.substr(0, tab));
+		}
+	}
+	if(words.empty()) {
+		std::cerr << "No words in '" << argv[1] << "'." << std::endl;
+		return 1;
+	}
+	std::mt19937 rng(772451);
+	std::uniform_int_distribution<std::size_t> pick(0, words.size() - 1);
+	std::vector<std::string> queries;
+	while(queries.size() < queryCount) {
+		queries.push_back(misspell(words[pick(rng)], rng));
+	}
+
+	std::cout << argv[1] << ": " << words.size() << " words, " << queries.size() << " queries, " << rounds
+		  << " rounds" << std::endl;
+	std::cout << "dist\tvector us/q\tbuffer us/q\ttop10 us/q\tallocs/q" << std::endl;
+	bool allocating(false);
+	for(unsigned int d(1); d <= 2; ++d) {
+		const ProbabilitySuggest dictionary(argv[1], d);
+		std::size_t checksum(0);
+		auto start(std::chrono::steady_clock::now());
+		for(unsigned int r(0); r < rounds; ++r) {
+			for(auto q(queries.cbegin()); q != queries.cend(); ++q) {
+				checksum += dictionary.all(*q).size();
+			}
+		}
+		const std::chrono::duration<double> vectorTime(std::chrono::steady_clock::now() - start);
+// one round to grow the Buffer to the largest search, then the
+// allocations of the others are counted
+		ProbabilitySuggest::Buffer buffer;
+		for(auto q(queries.cbegin()); q != queries.cend(); ++q) {
+			dictionary.all(*q, buffer);
+		}
+		const unsigned long before(allocations);
+		start = std::chrono::steady_clock::now();
+		for(unsigned int r(0); r < rounds; ++r) {
+			for(auto q(queries.cbegin()); q != queries.cend(); ++q) {
+				dictionary.all(*q, buffer);
+				checksum -= buffer.results.size();
+			}
+		}
+		const std::chrono::duration<double> bufferTime(std::chrono::steady_clock::now() - start);
+		const unsigned long allocated(allocations - before);
+		start = std::chrono::steady_clock::now();
+		for(unsigned int r(0); r < rounds; ++r) {
+			for(auto q(queries.cbegin()); q != queries.cend(); ++q) {
+				dictionary.all(*q, buffer, 10);
+			}
+		}
+		const std::chrono::duration<double> topTime(std::chrono::steady_clock::now() - start);
+		if(checksum != 0) {
+			std::cerr << "The Buffer does not hold the results of Suggest::all." << std::endl;
+			return 1;
+		}
+		const double perQuery(1e6 / (double(rounds) * queries.size()));
+		std::cout << d << '\t' << std::fixed << std::setprecision(1) << vectorTime.count() * perQuery << '\t'
+			  << bufferTime.count() * perQuery << '\t' << topTime.count() * perQuery << '\t'
+			  << std::setprecision(3) << double(allocated) / (double(rounds) * queries.size()) << std::endl;
+		allocating = allocating || allocated;
+	} // for d
+	if(allocating) {
+		std::cout << "Suggest::all allocates with a grown Buffer" << std::endl;
+	}
+	return allocating ? 1 : 0;
+}
@@ -0,0 +1,92 @@
+/* CoalesceBench.cpp
+   Many threads asking about the same few misspellings at once, with
+   and without sharing searches that are in flight.
+*/
+
+#include "../src/Suggest.hpp"
+#include <random>
+#include <chrono>
+#include <iomanip>
+#include <thread>
+
+int main(int argc, char** argv) {
+	if(argc < 2) {
+		std::cerr << "Usage: " << argv[0] << " CORPUSFILE [THREADS] [REQUESTS] [EDITDISTANCE]" << std::endl;
+		return 1;
+	}
+	const unsigned int threads(argc > 2 ? std::stoi(argv[2]) : 8);
+	const unsigned int requests(argc > 3 ? std::stoi(argv[3]) : 200);
+	const unsigned int editDistance(argc > 4 ? std::stoi(argv[4]) : 2);
+	const ProbabilitySuggest dictionary(argv[1], editDistance);
+
+// a handful of trending typos, the first ones asked most often
+	std::vector<std::string> words;
+	{
+		std::ifstream corpus(argv[1]);
+		for(std::string line; std::getline(corpus, line);) {
+			const std::string word(line.substr(0, line.find('\t')));
+			if(word.size() > 5) words.push_back(word);
+		}
+	}
+	if(words.empty()) {
+		std::cerr << "No words in '" << argv[1] << "'." << std::endl;
+		return 1;
+	}
+	std::mt19937 rng(772451);
+	std::uniform_int_distribution<std::size_t> pickWord(0, words.size() - 1);
+	std::vector<std::string> typos;
+	std::vector<std::vector<std::string>> expected;
+	for(unsigned int t(0); t < 16; ++t) {
+		std::string typo(words[pickWord(rng)]);
+		std::swap(typo[1], typo[2]);
+		typos.push_back(typo);
+		expected.push_back(dictionary.all(typo));
+	}
+	std::vector<std::vector<unsigned int>> plans(threads);
+	for(auto p(plans.begin()); p != plans.end(); ++p) {
+		std::geometric_distribution<unsigned int> trend(0.3);
+		for(unsigned int r(0); r < requests; ++r) {
+			p->push_back(std::min<unsigned int>(trend(rng), typos.size() - 1));
+		}
+	}
+
+	std::cout << argv[1] << ": " << threads << " threads, " << requests << " requests each, edit distance "
+		  << editDistance << std::endl;
+	std::cout << "mode\tms\tsearches" << std::endl;
+	bool same(true);
+	for(unsigned int shared(0); shared < 2; ++shared) {
+		const unsigned long before(dictionary.getSingleFlight().getCalls() - dictionary.getSingleFlight().getShared());
+		std::atomic<bool> go(false);
+		std::atomic<unsigned long> wrong(0);
+		std::vector<std::thread> clients;
+		for(unsigned int t(0); t < threads; ++t) {
+			clients.push_back(std::thread([&, t]() {
+						while(!go) std::this_thread::yield();
+						for(auto q(plans[t].cbegin()); q != plans[t].cend(); ++q) {
+							if(shared) {
+								const auto v(dictionary.rankedShared(typos[*q]));
+								wrong += v->size() != expected[*q].size()
+									|| (!v->empty() && v->front().first != expected[*q].front());
+							} else {
+								wrong += dictionary.all(typos[*q]) != expected[*q];
+							}
+						}
+					}));
+		}
+		const auto start(std::chrono::steady_clock::now());
+		go = true;
+		for(auto c(clients.begin()); c != clients.end(); ++c) {
+			c->join();
+		}
+		const std::chrono::duration<double, std::milli> elapsed(std::chrono::steady_clock::now() - start);
+		const unsigned long searches(shared ? dictionary.getSingleFlight().getCalls() - dictionary.getSingleFlight().getShared() - before
+					     : (unsigned long)threads * requests);
+		std::cout << (shared ? "coalesced" : "separate") << '\t' << std::fixed << std::setprecision(1) << elapsed.count()
+			  << '\t' << searches << std::endl;
+		same = same && wrong == 0;
+	} // for shared
+	if(!same) {
+		std::cout << "shared results differ from separate searches" << std::endl;
+	}
+	return same ? 0 : 1;
+}
@@ -0,0 +1,128 @@
+/* CompleteBench.cpp
+   Typeahead: the time per keystroke of prefix completions with 0 to 2
+   edit operations, checked against a scan of the whole corpus.
+*/
+
+#include "../src/Suggest.hpp"
+#include "../src/Utf8.hpp"
+#include <random>
+#include <chrono>
+#include <iomanip>
+
+//! A word of the corpus for the scan.
+struct Entry {
+	std::u32string word; /*!< The code points of the word. */
+	double probability; /*!< Its value in the corpus. */
+};
+
+/*! The fewest unit edit operations, with transpositions, between a
+ *  prefix and any beginning of a word.
+ \param prefix The code points of the prefix.
+ \param word The code points of the word.
+ \param maxEdits Distances above this are not needed.
+ \return The distance, or maxEdits + 1 if it is greater than maxEdits.
+*/
+static unsigned int prefixDistance(const std::u32string& prefix, const std::u32string& word, const unsigned int maxEdits) {
+	const std::size_t n(prefix.size());
+	std::vector<std::vector<unsigned int>> rows(word.size() + 1, std::vector<unsigned int>(n + 1));
+	for(std::size_t j(0); j <= n; ++j) {
+		rows[0][j] = j;
+	}
+	unsigned int best(rows[0][n]);
+	for(std::size_t i(1); i <= word.size(); ++i) {
+		rows[i][0] = i;
+		unsigned int least(rows[i][0]);
+		for(std::size_t j(1); j <= n; ++j) {
+			unsigned int d(std::min(rows[i - 1][j - 1] + (prefix[j - 1] != word[i - 1]), std::min(rows[i - 1][j], rows[i][j - 1]) + 1));
+			if(i > 1 && j > 1 && prefix[j - 1] == word[i - 2] && prefix[j - 2] == word[i - 1]) {
+				d = std::min(d, rows[i - 2][j - 2] + 1);
+			}
+			rows[i][j] = d;
+			least = std::min(least, d);
+		}
+		best = std::min(best, rows[i][n]);
+		if(least > maxEdits) break;
+	}
+	return std::min(best, maxEdits + 1);
+} // prefixDistance
+
+int main(int argc, char** argv) {
+	if(argc < 2) {
+		std::cerr << "Usage: " << argv[0] << " CORPUSFILE [WORDS] [K]" << std::endl;
+		return 1;
+	}
+	const unsigned int wordCount(argc > 2 ? std::stoi(argv[2]) : 300);
+	const unsigned int k(argc > 3 ? std::stoi(argv[3]) : 10);
+	std::vector<Entry> entries;
+	std::vector<std::string> words;
+	{
+		std::ifstream corpus(argv[1]);
+		for(std::string line; std::getline(corpus, line);) {
+			const std::size_t tab(line.find('\t'));
+			if(tab == std::string::npos) continue;
+			entries.push_back(Entry{std::u32string(), std::stod(line.substr(tab + 1))});
+			Utf8::normalize(line.substr(0, tab), entries.back().word, false);
+			if(tab >= 4) words.push_back(line.substr(0, tab));
+		}
+	}
+	if(words.empty()) {
+		std::cerr << "No words in '" << argv[1] << "'." << std::endl;
+		return 1;
+	}
+	const ProbabilitySuggest dictionary(argv[1], 1);
+// words typed one character at a time; every third one with a typo
+// in its second character
+	std::mt19937 rng(772451);
+	std::uniform_int_distribution<std::size_t> pick(0, words.size() - 1);
+	std::uniform_int_distribution<int> letter('a', 'z');
+	std::vector<std::string> typed;
+	for(unsigned int w(0); w < wordCount; ++w) {
+		std::string word(words[pick(rng)]);
+		if(w % 3 == 0) {
+			word[1] = letter(rng);
+		}
+		typed.push_back(word);
+	}
+
+	std::cout << argv[1] << ": " << typed.size() << " words typed, top " << k << std::endl;
+	std::cout << "edits\tkeystrokes\tp50 us\tp99 us\tmax us\tchecked" << std::endl;
+	bool same(true);
+	for(unsigned int edits(0); edits <= 2; ++edits) {
+		std::vector<double> latencies;
+		unsigned int checked(0);
+		for(std::size_t w(0); w < typed.size(); ++w) {
+			for(std::size_t length(1); length <= typed[w].size(); ++length) {
+				const std::string prefix(typed[w].substr(0, length));
+				const auto start(std::chrono::steady_clock::now());
+				const auto v(dictionary.complete(prefix, k, edits));
+				const std::chrono::duration<double, std::micro> elapsed(std::chrono::steady_clock::now() - start);
+				latencies.push_back(elapsed.count());
+// the scan is slow; check the keystrokes of the first few words
+				if(w >= 10) continue;
+				std::u32string p;
+				Utf8::normalize(prefix, p, false);
+				std::vector<std::pair<unsigned int, double>> expected;
+				for(auto e(entries.cbegin()); e != entries.cend(); ++e) {
+					const unsigned int d(prefixDistance(p, e->word, edits));
+					if(d <= edits) expected.push_back(std::make_pair(d, -e->probability));
+				}
+				std::sort(expected.begin(), expected.end());
+				if(expected.size() > k) expected.resize(k);
+				std::vector<std::pair<unsigned int, double>> got;
+				for(auto r(v.cbegin()); r != v.cend(); ++r) {
+					got.push_back(std::make_pair(r->editDistance, -r->second));
+				}
+				same = same && got == expected;
+				++checked;
+			} // for length
+		} // for w
+		std::sort(latencies.begin(), latencies.end());
+		std::cout << edits << '\t' << latencies.size() << '\t' << std::fixed << std::setprecision(1)
+			  << latencies[latencies.size() / 2] << '\t' << latencies[latencies.size() * 99 / 100] << '\t'
+			  << latencies.back() << '\t' << checked << std::endl;
+	} // for edits
+	if(!same) {
+		std::cout << "completions differ from a scan of the corpus" << std::endl;
+	}
+	return same ? 0 : 1;
+}
@@ -0,0 +1,102 @@
+/* DeepeningBench.cpp
+   Best and top-K suggestions for mostly correct words: full searches
+   at edit distance 1 and 2 against searches that deepen one edit
+   distance at a time; and the best suggestion of the words with a
+   typo alone.
+*/
+
+#include "../src/Suggest.hpp"
+#include <random>
+#include <chrono>
+#include <iomanip>
+#include <functional>
+
+int main(int argc, char** argv) {
+	if(argc < 2) {
+		std::cerr << "Usage: " << argv[0] << " CORPUSFILE [QUERIES] [TOPK]" << std::endl;
+		return 1;
+	}
+	const unsigned int queryCount(argc > 2 ? std::stoi(argv[2]) : 2000);
+	const unsigned int k(argc > 3 ? std::stoi(argv[3]) : 5);
+	std::vector<std::string> words;
+	{
+		std::ifstream corpus(argv[1]);
+		for(std::string line; std::getline(corpus, line);) {
+			const std::string word(line.substr(0, line.find('\t')));
+			if(word.size() > 3) words.push_back(word);
+		}
+	}
+	if(words.empty()) {
+		std::cerr << "No words in '" << argv[1] << "'." << std::endl;
+		return 1;
+	}
+// nine in ten queries are spelled correctly, the rest have one typo
+	std::mt19937 rng(772451);
+	std::uniform_int_distribution<std::size_t> pick(0, words.size() - 1);
+	std::uniform_int_distribution<int> letter('a', 'z');
+	std::vector<std::string> queries, typos;
+	for(unsigned int q(0); q < queryCount; ++q) {
+		std::string query(words[pick(rng)]);
+		if(q % 10 == 0) {
+			query[q % query.size()] = letter(rng);
+			typos.push_back(query);
+		}
+		queries.push_back(query);
+	}
+	const ProbabilitySuggest e1(argv[1], 1), e2(argv[1], 2);
+
+	std::cout << argv[1] << ": " << queries.size() << " queries, top " << k << std::endl;
+	std::cout << "search\tus/query" << std::endl;
+	bool same(true);
+	std::vector<std::string> bestFull, bestDeepening;
+	std::vector<std::vector<std::string>> topFull, topDeepening;
+	auto timeOn = [](const std::vector<std::string>& on, const char* name, const std::function<void(const std::string&)>& f) {
+		const auto start(std::chrono::steady_clock::now());
+		for(auto q(on.cbegin()); q != on.cend(); ++q) {
+			f(*q);
+		}
+		const std::chrono::duration<double, std::micro> elapsed(std::chrono::steady_clock::now() - start);
+		std::cout << name << '\t' << std::fixed << std::setprecision(1) << elapsed.count() / on.size() << std::endl;
+	};
+	auto time = [&queries, &timeOn](const char* name, const std::function<void(const std::string&)>& f) {
+		timeOn(queries, name, f);
+	};
+	time("best e1 full", [&e1](const std::string& q) {
+			const auto v(e1.ranked(q));
+		});
+	time("best e2 full", [&e2, &bestFull](const std::string& q) {
+			const auto v(e2.ranked(q));
+			bestFull.push_back(v.empty() ? std::string() : v.front().first);
+		});
+	time("best e2 deepening", [&e2, &bestDeepening](const std::string& q) {
+			bestDeepening.push_back(e2.best(q));
+		});
+	time("top e2 full", [&e2, &topFull, k](const std::string& q) {
+			auto v(e2.all(q));
+			if(v.size() > k) v.resize(k);
+			topFull.push_back(v);
+		});
+	time("top e2 deepening", [&e2, &topDeepening, k](const std::string& q) {
+			const auto v(e2.top(q, k));
+			std::vector<std::string> t;
+			for(auto r(v.cbegin()); r != v.cend(); ++r) {
+				t.push_back(r->first);
+			}
+			topDeepening.push_back(t);
+		});
+// a typo takes the deepening search to distance 1, where it stops as
+// soon as it has the best key
+	std::vector<std::string> typoFull, typoDeepening;
+	timeOn(typos, "typos best e2 full", [&e2, &typoFull](const std::string& q) {
+			const auto v(e2.ranked(q));
+			typoFull.push_back(v.empty() ? std::string() : v.front().first);
+		});
+	timeOn(typos, "typos best e2 deepening", [&e2, &typoDeepening](const std::string& q) {
+			typoDeepening.push_back(e2.best(q));
+		});
+	same = bestFull == bestDeepening && topFull == topDeepening && typoFull == typoDeepening;
+	if(!same) {
+		std::cout << "deepening searches found other suggestions than full ones" << std::endl;
+	}
+	return same ? 0 : 1;
+}
@@ -0,0 +1,134 @@
+/* LayoutBench.cpp
+   Cache misses per search before and after Tri::compact , measured
+   with the hardware performance counters of Linux.
+*/
+
+#include "../src/Tri.hpp"
+#include "../src/ProbabilityCorpusParser.hpp"
+#include <fstream>
+#include <random>
+#include <chrono>
+#include <iomanip>
+#include <cstring>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+/*! A hardware counter of the calling thread, opened with
+ *  perf_event_open. If the kernel does not allow it (e.g. in a
+ *  container, or with a high perf_event_paranoid), the counter is
+ *  not available and reads as 0. */
+class Counter {
+private:
+	int _fd; /*!< The file descriptor of the counter, or -1. */
+public:
+	Counter(const Counter&) = delete;
+/*! Opens a counter.
+  \param type PERF_TYPE_HARDWARE or PERF_TYPE_HW_CACHE.
+  \param config The event of that type.
+*/
+	Counter(const unsigned int type, const unsigned long long config) : _fd(-1) {
+		perf_event_attr attr;
+		std::memset(&attr, 0, sizeof(attr));
+		attr.size = sizeof(attr);
+		attr.type = type;
+		attr.config = config;
+		attr.disabled = 1;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		_fd = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+	}
+	~Counter() {
+		if(_fd >= 0) close(_fd);
+	}
+	bool available() const {
+		return _fd >= 0;
+	}
+	void start() {
+		if(_fd < 0) return;
+		ioctl(_fd, PERF_EVENT_IOC_RESET, 0);
+		ioctl(_fd, PERF_EVENT_IOC_ENABLE, 0);
+	}
+	unsigned long long stop() {
+		if(_fd < 0) return 0;
+		ioctl(_fd, PERF_EVENT_IOC_DISABLE, 0);
+		unsigned long long count(0);
+		if(read(_fd, &count, sizeof(count)) != sizeof(count)) return 0;
+		return count;
+	}
+}; // Counter
+
+/*! Runs all queries at one edit distance and prints cache misses and
+ *  time per query.
+  \param name The layout, for the output.
+  \param tri The Tri to search.
+  \param queries The words to search for.
+  \param d The edit distance.
+*/
+static void run(const char* name, const Tri<double>& tri, const std::vector<std::string>& queries, const unsigned int d) {
+	Counter llc(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+	Counter l1d(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+		    | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+	unsigned long results(0);
+	llc.start();
+	l1d.start();
+	const auto start(std::chrono::steady_clock::now());
+	for(auto q(queries.cbegin()); q != queries.cend(); ++q) {
+		results += tri.tolerantFind(*q, d).size();
+	}
+	const std::chrono::duration<double, std::micro> elapsed(std::chrono::steady_clock::now() - start);
+	const double l1dMisses(l1d.stop()), llcMisses(llc.stop());
+	std::cout << d << '\t' << name << '\t' << std::fixed << std::setprecision(0);
+	if(l1d.available()) std::cout << l1dMisses / queries.size(); else std::cout << "n/a";
+	std::cout << '\t';
+	if(llc.available()) std::cout << llcMisses / queries.size(); else std::cout << "n/a";
+	std::cout << '\t' << std::setprecision(1) << elapsed.count() / queries.size() << '\t' << results << std::endl;
+} // run
+
+int main(int argc, char** argv) {
+	if(argc < 2) {
+		std::cerr << "Usage: " << argv[0] << " CORPUSFILE [QUERIES]" << std::endl;
+		return 1;
+	}
+	const std::string corpusFilename(argv[1]);
+	const unsigned int queryCount(argc > 2 ? std::stoi(argv[2]) : 300);
+
+	std::ifstream corpus(corpusFilename);
+	if(!corpus.is_open()) {
+		std::cerr << "Could not open '" << corpusFilename << "'." << std::endl;
+		return 1;
+	}
+	ProbabilityCorpusParser parser(corpusFilename);
+	Tri<double> tri;
+	std::vector<std::string> words;
+	for(std::string line; std::getline(corpus, line);) {
+		if(line.empty()) continue;
+		auto p(parser.parseLine(line));
+		tri.insert(p);
+		words.push_back(p.first);
+	}
+
+// one random substitution per word, so that every search leaves the
+// path of its word
+	std::mt19937 rng(772451);
+	std::uniform_int_distribution<std::size_t> pick(0, words.size() - 1);
+	std::vector<std::string> queries;
+	for(unsigned int i(0); i < queryCount; ++i) {
+		std::string q(words[pick(rng)]);
+		std::uniform_int_distribution<std::size_t> pos(0, q.size() - 1);
+		q[pos(rng)] = 'a' + i % 26;
+		queries.push_back(q);
+	}
+
+	std::cout << corpusFilename << ": " << tri.getStates() << " states, "
+		  << queries.size() << " queries" << std::endl;
+	std::cout << "dist\tlayout\tL1d misses\tLLC misses\tus\tresults   (per query)" << std::endl;
+	Tri<double> compacted(tri.makeCopy());
+	compacted.compact();
+	for(unsigned int d(1); d <= 2; ++d) {
+		run("insertion", tri, queries, d);
+		run("compact", compacted, queries, d);
+	}
+	return 0;
+}
@@ -0,0 +1,124 @@
+/* MetricsBench.cpp
+   The cost of counting a query in Metrics, against the time of the
+   query itself, and the cost when several threads count at once.
+*/
+
+#include "../src/Suggest.hpp"
+#include "../src/Metrics.hpp"
+#include <random>
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+
+/*! Misspells a word with one random substitution.
+  \param w The word to misspell.
+  \param rng The random number generator to use.
+  \return The misspelled word.
+*/
+static std::string misspell(std::string w, std::mt19937& rng) {
+	std::uniform_int_distribution<std::size_t> pos(0, w.size() - 1);
+	std::uniform_int_distribution<int> letter('a', 'z');
+	w[pos(rng)] = letter(rng);
+	return w;
+} // misspell
+
+/*! Counts queries from a number of threads at once, each with its
+ *  own Timer, like threads that answer queries would.
+ \param metrics Where to count.
+ \param threads The number of threads.
+ \param perThread Queries per thread.
+ \return The time per counted query, in nanoseconds.
+*/
+static double countFrom(Metrics& metrics, const unsigned int threads, const unsigned long perThread) {
+	const auto start(std::chrono::steady_clock::now());
+	std::vector<std::thread> running;
+	for(unsigned int t(0); t < threads; ++t) {
+		running.emplace_back([&metrics, perThread, t]() {
+				for(unsigned long i(0); i < perThread; ++i) {
+					Metrics::Timer timer(&metrics, QueryMode(i % queryModes), t);
+					timer.results(i & 63);
+				}
+			});
+	}
+	for(auto r(running.begin()); r != running.end(); ++r) {
+		r->join();
+	}
+	const std::chrono::duration<double> elapsed(std::chrono::steady_clock::now() - start);
+	return elapsed.count() * 1e9 / (double(threads) * perThread);
+} // countFrom
+
+int main(int argc, char** argv) {
+	if(argc < 2) {
+		std::cerr << "Usage: " << argv[0] << " CORPUSFILE [QUERIES] [ROUNDS]" << std::endl;
+		return 1;
+	}
+	const unsigned int queryCount(argc > 2 ? std::stoi(argv[2]) : 500);
+	const unsigned int rounds(argc > 3 ? std::stoi(argv[3]) : 5);
+	std::vector<std::string> words;
+	{
+		std::ifstream corpus(argv[1]);
+		for(std::string line; std::getline(corpus, line);) {
+			const std::size_t tab(line.find('\t'));
+			if(tab != std::string::npos && tab > 0) words.push_back(line.substr(0, tab));
+		}
+	}
+	if(words.empty()) {
+		std::cerr << "No words in '" << argv[1] << "'." << std::endl;
+		return 1;
+	}
+	std::mt19937 rng(772451);
+	std::uniform_int_distribution<std::size_t> pick(0, words.size() - 1);
+	std::vector<std::string> queries;
+	while(queries.size() < queryCount) {
+		queries.push_back(misspell(words[pick(rng)], rng));
+	}
+
+	std::cout << argv[1] << ": " << words.size() << " words, " << queries.size() << " queries, " << rounds
+		  << " rounds" << std::endl;
+	std::cout << "dist\tplain us/q\tcounted us/q\tcount ns/q\toverhead" << std::endl;
+	Metrics metrics;
+	const double countNs(countFrom(metrics, 1, 1000000));
+	for(unsigned int d(1); d <= 2; ++d) {
+		const ProbabilitySuggest dictionary(argv[1], d);
+		std::size_t results(0);
+		auto start(std::chrono::steady_clock::now());
+		for(unsigned int r(0); r < rounds; ++r) {
+			for(auto q(queries.cbegin()); q != queries.cend(); ++q) {
+				results += dictionary.all(*q).size();
+			}
+		}
+		const std::chrono::duration<double> plain(std::chrono::steady_clock::now() - start);
+		start = std::chrono::steady_clock::now();
+		for(unsigned int r(0); r < rounds; ++r) {
+			for(auto q(queries.cbegin()); q != queries.cend(); ++q) {
+				Metrics::Timer timer(&metrics, QueryMode::all, d);
+				const auto v(dictionary.all(*q));
+				timer.results(v.size());
+				results -= v.size();
+			}
+		}
+		const std::chrono::duration<double> counted(std::chrono::steady_clock::now() - start);
+		if(results != 0) {
+			std::cerr << "Counting changed the results." << std::endl;
+			return 1;
+		}
+// the difference of the two loops is within their noise; the cost of
+// counting alone says more
+		const double perQuery(1e6 / (double(rounds) * queries.size()));
+		std::cout << d << '\t' << std::fixed << std::setprecision(1) << plain.count() * perQuery << '\t'
+			  << counted.count() * perQuery << '\t' << countNs << '\t' << std::setprecision(3)
+			  << countNs * 1e-3 / (plain.count() * perQuery) * 100 << '%' << std::endl;
+	} // for d
+
+	std::cout << "threads\tcount ns/q" << std::endl;
+	for(unsigned int threads(1); threads <= 8; threads *= 2) {
+		std::cout << threads << '\t' << std::setprecision(1) << countFrom(metrics, threads, 1000000 / threads) << std::endl;
+	}
+	std::ostringstream exposition;
+	const auto start(std::chrono::steady_clock::now());
+	metrics.write(exposition);
+	const std::chrono::duration<double> written(std::chrono::steady_clock::now() - start);
+	std::cout << "writing " << metrics.getQueries() << " counted queries: " << std::setprecision(1) << written.count() * 1e6
+		  << " us, " << exposition.str().size() << " bytes" << std::endl;
+	return 0;
+}
@@ -0,0 +1,221 @@
+/* MicroBench.cpp
+   Time per operation of the hot paths one at a time: Tri::insert ,
+   Tri::unsafeGet , tolerant searches by edit distance and word length,
+   ProbabilityCorpusParser::parseLine and the ranking of Suggest::all .
+   The output is a baseline file that a later run can compare against.
+*/
+
+#include "../src/Suggest.hpp"
+#include <random>
+#include <chrono>
+#include <iomanip>
+#include <functional>
+#include <map>
+
+//! One measured hot path.
+struct Case {
+	std::string name; /*!< For the output and the baseline. */
+	std::size_t ops; /*!< Operations per run. */
+	std::function<std::size_t()> run; /*!< Does ops operations; the
+					    result is summed up so that
+					    the work is not optimized
+					    away. */
+};
+
+//! Sums the results of all runs.
+static volatile std::size_t sink(0);
+
+/*! Repeats the runs of a case until they took at least minTime and
+ *  there were at least five of them. The fastest run is the one least
+ *  disturbed by other processes, so it is the one reported.
+  \param c The case.
+  \param minTime Seconds to spend on the case.
+  \return The time of the fastest run, per operation, in nanoseconds.
+*/
+static double measure(const Case& c, const double minTime) {
+	double fastest(0), total(0);
+	for(unsigned int runs(0); runs < 5 || total < minTime; ++runs) {
+		const auto start(std::chrono::steady_clock::now());
+		sink += c.run();
+		const std::chrono::duration<double> elapsed(std::chrono::steady_clock::now() - start);
+		fastest = runs == 0 ? elapsed.count() : std::min(fastest, elapsed.count());
+		total += elapsed.count();
+	}
+	return fastest * 1e9 / c.ops;
+} // measure
+
+/*! Reads a baseline file: lines of a case name and its time per
+ *  operation, separated by a tab; lines starting with # are comments.
+  \param filename The file.
+  \return The times by case name; empty if the file cannot be read.
+*/
+static std::map<std::string, double> readBaseline(const std::string& filename) {
+	std::map<std::string, double> baseline;
+	std::ifstream in(filename);
+	for(std::string line; std::getline(in, line);) {
+		const std::size_t tab(line.find('\t'));
+		if(line.empty() || line[0] == '#' || tab == std::string::npos) continue;
+		baseline[line.substr(0, tab)] = std::stod(line.substr(tab + 1));
+	}
+	return baseline;
+} // readBaseline
+
+/*! Misspells a word with one random substitution.
+  \param w The word to misspell.
+  \param rng The random number generator to use.
+  \return The misspelled word.
+*/
+static std::string misspell(std::string w, std::mt19937& rng) {
+	std::uniform_int_distribution<std::size_t> pos(0, w.size() - 1);
+	std::uniform_int_distribution<int> letter('a', 'z');
+	w[pos(rng)] = letter(rng);
+	return w;
+} // misspell
+
+int main(int argc, char** argv) {
+	if(argc < 2) {
+		std::cerr << "Usage: " << argv[0] << " CORPUSFILE [BASELINEFILE] [QUERIES]" << std::endl;
+		return 1;
+	}
+	const std::string corpusFilename(argv[1]);
+	const std::map<std::string, double> baseline(argc > 2 ? readBaseline(argv[2]) : std::map<std::string, double>());
+	if(argc > 2 && baseline.empty()) {
+		std::cerr << "No baseline in '" << argv[2] << "'." << std::endl;
+		return 1;
+	}
+	const unsigned int queryCount(argc > 3 ? std::stoi(argv[3]) : 100);
+
+	std::ifstream corpus(corpusFilename);
+	if(!corpus.is_open()) {
+		std::cerr << "Could not open '" << corpusFilename << "'." << std::endl;
+		return 1;
+	}
+	std::vector<std::string> lines;
+	std::vector<std::pair<std::string, double>> entries;
+	{
+		ProbabilityCorpusParser parser(corpusFilename);
+		for(std::string line; std::getline(corpus, line);) {
+			if(line.empty()) continue;
+			lines.push_back(line);
+			entries.push_back(parser.parseLine(line));
+		}
+	}
+	if(entries.empty()) {
+		std::cerr << "No words in '" << corpusFilename << "'." << std::endl;
+		return 1;
+	}
+	Tri<double> tri;
+	for(auto e(entries.cbegin()); e != entries.cend(); ++e) {
+		tri.insert(*e);
+	}
+	tri.compact();
+	const ProbabilitySuggest dictionary(corpusFilename, 2);
+
+// lookups in a random order, of corpus words and of misspelled ones
+	std::mt19937 rng(772451);
+	std::vector<std::string> hits, misses;
+	for(auto e(entries.cbegin()); e != entries.cend(); ++e) {
+		hits.push_back(e->first);
+		misses.push_back(misspell(e->first, rng));
+	}
+	std::shuffle(hits.begin(), hits.end(), rng);
+// misspelled words of three lengths for the searches
+	std::uniform_int_distribution<std::size_t> pick(0, entries.size() - 1);
+	std::vector<std::string> queries[3];
+	const char* lengths[3] = {"short", "medium", "long"};
+	for(unsigned int tries(0); tries < 1000 * queryCount; ++tries) {
+		const std::string& w(entries[pick(rng)].first);
+		std::vector<std::string>& q(queries[w.size() <= 5 ? 0 : w.size() <= 9 ? 1 : 2]);
+		if(q.size() < queryCount) {
+			q.push_back(misspell(w, rng));
+		}
+	}
+// the results that Suggest::all sorts
+	std::vector<std::vector<ProbabilitySuggest::result_type>> unsorted;
+	for(auto q(queries[1].cbegin()); q != queries[1].cend(); ++q) {
+		unsorted.push_back(dictionary.ranked(*q));
+	}
+
+	std::vector<Case> cases;
+	cases.push_back(Case{"tri/insert", entries.size(), [&entries]() {
+				Tri<double> t;
+				for(auto e(entries.cbegin()); e != entries.cend(); ++e) {
+					t.insert(*e);
+				}
+				return std::size_t(t.getStates());
+			}});
+	cases.push_back(Case{"tri/unsafeGet/hit", hits.size(), [&tri, &hits]() {
+				std::size_t found(0);
+				for(auto w(hits.cbegin()); w != hits.cend(); ++w) {
+					found += tri.unsafeGet(*w) != NULL;
+				}
+				return found;
+			}});
+	cases.push_back(Case{"tri/unsafeGet/miss", misses.size(), [&tri, &misses]() {
+				std::size_t found(0);
+				for(auto w(misses.cbegin()); w != misses.cend(); ++w) {
+					found += tri.unsafeGet(*w) != NULL;
+				}
+				return found;
+			}});
+	for(unsigned int d(1); d <= 3; ++d) {
+		for(unsigned int l(0); l < 3; ++l) {
+			const std::vector<std::string>& q(queries[l]);
+			if(q.empty()) continue;
+			cases.push_back(Case{"tri/tolerantFind/e" + std::to_string(d) + "/" + lengths[l], q.size(), [&tri, &q, d]() {
+						std::size_t results(0);
+						for(auto w(q.cbegin()); w != q.cend(); ++w) {
+							results += tri.tolerantFind(*w, d).size();
+						}
+						return results;
+					}});
+		}
+	}
+	cases.push_back(Case{"parser/parseLine", lines.size(), [&lines, &corpusFilename]() {
+				ProbabilityCorpusParser parser(corpusFilename);
+				std::size_t length(0);
+				for(auto l(lines.cbegin()); l != lines.cend(); ++l) {
+					length += parser.parseLine(*l).first.size();
+				}
+				return length;
+			}});
+	if(!queries[1].empty()) {
+		cases.push_back(Case{"suggest/all/e2", queries[1].size(), [&dictionary, &queries]() {
+					std::size_t results(0);
+					for(auto w(queries[1].cbegin()); w != queries[1].cend(); ++w) {
+						results += dictionary.all(*w).size();
+					}
+					return results;
+				}});
+// results cannot be copied; they are shuffled again before every sort
+		cases.push_back(Case{"suggest/sort/e2", unsorted.size(), [&unsorted]() {
+					std::mt19937 order(772451);
+					std::size_t results(0);
+					for(auto v(unsorted.begin()); v != unsorted.end(); ++v) {
+						std::shuffle(v->begin(), v->end(), order);
+						std::sort(v->begin(), v->end(), ProbabilitySuggest::isBetter);
+						results += v->size();
+					}
+					return results;
+				}});
+	}
+
+	std::cout << "# " << corpusFilename << ": " << entries.size() << " words, " << queryCount << " queries per search"
+		  << std::endl;
+	std::cout << "# case\tns/op" << (baseline.empty() ? "" : "\tbaseline\tchange") << std::endl;
+	for(auto c(cases.cbegin()); c != cases.cend(); ++c) {
+		const double ns(measure(*c, 0.5));
+		std::cout << c->name << '\t' << std::fixed << std::setprecision(1) << ns;
+		if(!baseline.empty()) {
+			auto b(baseline.find(c->name));
+			if(b == baseline.cend()) {
+				std::cout << "\t-\t-";
+			} else {
+				std::cout << '\t' << b->second << '\t' << std::showpos << (ns / b->second - 1) * 100 << '%'
+					  << std::noshowpos;
+			}
+		}
+		std::cout << std::endl;
+	}
+	return 0;
+}
@@ -0,0 +1,106 @@
+/* MissBench.cpp
+   Queries without suggestions: the miss cache and the q-gram filter
+   against plain searches.
+*/
+
+#include "../src/Suggest.hpp"
+#include <random>
+#include <chrono>
+#include <iomanip>
+
+/*! A random string of characters from a set.
+  \param chars The characters to choose from.
+  \param rng The random number generator to use.
+  \return A string of 6 to 12 characters.
+*/
+static std::string randomString(const std::string& chars, std::mt19937& rng) {
+	std::uniform_int_distribution<std::size_t> length(6, 12), pick(0, chars.size() - 1);
+	std::string s(length(rng), ' ');
+	for(auto c(s.begin()); c != s.end(); ++c) {
+		*c = chars[pick(rng)];
+	}
+	return s;
+} // randomString
+
+int main(int argc, char** argv) {
+	if(argc < 2) {
+		std::cerr << "Usage: " << argv[0] << " CORPUSFILE [QUERIES]" << std::endl;
+		return 1;
+	}
+	const unsigned int queryCount(argc > 2 ? std::stoi(argv[2]) : 2000);
+	std::vector<std::string> words;
+	{
+		std::ifstream corpus(argv[1]);
+		for(std::string line; std::getline(corpus, line);) {
+			const std::string word(line.substr(0, line.find('\t')));
+			if(word.size() > 2) words.push_back(word);
+		}
+	}
+	if(words.empty()) {
+		std::cerr << "No words in '" << argv[1] << "'." << std::endl;
+		return 1;
+	}
+
+// a quarter of the distinct queries are misspelled words, the rest
+// ids, garbage and words run together; every one is asked about four
+// times, in random order
+	std::mt19937 rng(772451);
+	std::uniform_int_distribution<std::size_t> pickWord(0, words.size() - 1);
+	std::uniform_int_distribution<int> letter('a', 'z');
+	std::vector<std::string> queries;
+	for(unsigned int q(0); queries.size() < queryCount; ++q) {
+		std::string query;
+		switch(q % 4) {
+		case 0:
+			query = words[pickWord(rng)];
+			query[q % query.size()] = letter(rng);
+			break;
+		case 1:
+			query = randomString("0123456789abcdef", rng);
+			break;
+		case 2:
+			query = randomString("abcdefghijklmnopqrstuvwxyz", rng);
+			break;
+		default:
+			query = words[pickWord(rng)] + words[pickWord(rng)];
+		}
+		queries.insert(queries.end(), 4, query);
+	}
+	std::shuffle(queries.begin(), queries.end(), rng);
+
+	std::cout << argv[1] << ": " << words.size() << " words, " << queries.size() << " queries" << std::endl;
+	std::cout << "distance\tvariant\tus/query\tcache hits\tfilter rejections" << std::endl;
+	bool same(true);
+	for(unsigned int d(1); d <= 2; ++d) {
+		std::vector<std::vector<std::string>> expected;
+		for(unsigned int variant(0); variant < 4; ++variant) {
+			SuggestOptions options(d);
+			options.missCache = (variant & 1) ? queries.size() / 2 : 0;
+			options.qgrams = (variant & 2) ? defaultQ : 0;
+			const ProbabilitySuggest dictionary(argv[1], options);
+			std::vector<std::vector<std::string>> results;
+			results.reserve(queries.size());
+			const auto start(std::chrono::steady_clock::now());
+			for(auto q(queries.cbegin()); q != queries.cend(); ++q) {
+				results.push_back(dictionary.all(*q));
+			}
+			const std::chrono::duration<double, std::micro> elapsed(std::chrono::steady_clock::now() - start);
+			if(variant == 0) {
+				expected = results;
+			}
+			same = same && results == expected;
+			const MissCache* cache(dictionary.getMissCache());
+			const QGramFilter* filter(dictionary.getQGramFilter());
+			static const char* names[] = {"plain", "miss cache", "q-gram filter", "both"};
+			std::cout << d << '\t' << names[variant] << '\t' << std::fixed << std::setprecision(1)
+				  << elapsed.count() / queries.size() << '\t'
+				  << (cache ? std::to_string(cache->getHits()) + "/" + std::to_string(cache->getLookups()) : "-") << '\t'
+				  << (filter ? std::to_string(filter->getRejections()) + "/" + std::to_string(filter->getChecks()) : "-")
+				  << std::endl;
+		} // for variant
+	} // for d
+	if(!same) {
+		std::cout << "suggestions differ from plain searches" << std::endl;
+	}
+	return same ? 0 : 1;
+}
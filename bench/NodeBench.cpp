@@ -0,0 +1,194 @@
+/* NodeBench.cpp
+   Memory and lookup latency of the transitions of the States of a
+   Tri by node type, against the std::map they used to be.
+*/
+
+#include "../src/Tri.hpp"
+#include "../src/ProbabilityCorpusParser.hpp"
+#include <fstream>
+#include <chrono>
+#include <iomanip>
+#include <set>
+
+//! The names of the NodeTypes, for the output.
+static const char* const typeNames[nodeTypes] = {"node4", "node16", "node48", "node256"};
+
+//! Bytes allocated by all CountingAllocators that are in use.
+static std::size_t allocated(0);
+
+//! Counts what a std::map allocates, in allocated .
+template <class T>
+struct CountingAllocator {
+	typedef T value_type;
+	CountingAllocator() {}
+	template <class U>
+	CountingAllocator(const CountingAllocator<U>&) {}
+	T* allocate(const std::size_t n) {
+		allocated += n * sizeof(T);
+		return std::allocator<T>().allocate(n);
+	}
+	void deallocate(T* p, const std::size_t n) {
+		allocated -= n * sizeof(T);
+		std::allocator<T>().deallocate(p, n);
+	}
+	template <class U>
+	bool operator==(const CountingAllocator<U>&) const {
+		return true;
+	}
+	template <class U>
+	bool operator!=(const CountingAllocator<U>&) const {
+		return false;
+	}
+}; // CountingAllocator
+
+//! The transitions as they used to be kept.
+typedef std::map<unsigned char, unsigned, std::less<unsigned char>, CountingAllocator<std::pair<const unsigned char, unsigned>>> map_T;
+
+//! A lookup: the node to look in and the character to look for.
+typedef std::pair<unsigned int, unsigned char> probe_T;
+
+/*! Looks up characters in nodes, a number of times.
+ \param nodes The nodes.
+ \param probes The lookups.
+ \param rounds How often to do all of them.
+ \param sum Adds up the States found, so that nothing is optimized
+ away and both containers can be checked to find the same.
+ \return Nanoseconds per lookup.
+*/
+template <class container_T>
+static double lookups(const std::vector<container_T>& nodes, const std::vector<probe_T>& probes, const unsigned int rounds,
+		      unsigned long& sum) {
+	const auto start(std::chrono::steady_clock::now());
+	for(unsigned int r(0); r < rounds; ++r) {
+		for(auto p(probes.cbegin()); p != probes.cend(); ++p) {
+			const container_T& node(nodes[p->first]);
+			const auto i(node.find(p->second));
+			if(i != node.cend()) {
+				sum += i->second;
+			}
+		}
+	}
+	const std::chrono::duration<double, std::nano> elapsed(std::chrono::steady_clock::now() - start);
+	return elapsed.count() / (double(rounds) * probes.size());
+} // lookups
+
+/*! Goes through all transitions of nodes in order, a number of times.
+ \param nodes The nodes.
+ \param transitions The number of transitions in them.
+ \param rounds How often to go through all of them.
+ \param sum Adds up the States, like in lookups .
+ \return Nanoseconds per transition.
+*/
+template <class container_T>
+static double iterations(const std::vector<container_T>& nodes, const std::size_t transitions, const unsigned int rounds,
+			 unsigned long& sum) {
+	const auto start(std::chrono::steady_clock::now());
+	for(unsigned int r(0); r < rounds; ++r) {
+		for(auto n(nodes.cbegin()); n != nodes.cend(); ++n) {
+			for(auto t(n->cbegin()); t != n->cend(); ++t) {
+				sum += t->second;
+			}
+		}
+	}
+	const std::chrono::duration<double, std::nano> elapsed(std::chrono::steady_clock::now() - start);
+	return elapsed.count() / (double(rounds) * transitions);
+} // iterations
+
+int main(int argc, char** argv) {
+	if(argc < 2) {
+		std::cerr << "Usage: " << argv[0] << " CORPUSFILE [LOOKUPS]" << std::endl;
+		return 1;
+	}
+	const std::string corpusFilename(argv[1]);
+	const unsigned long lookupCount(argc > 2 ? std::stoul(argv[2]) : 2000000);
+
+	std::ifstream corpus(corpusFilename);
+	if(!corpus.is_open()) {
+		std::cerr << "Could not open '" << corpusFilename << "'." << std::endl;
+		return 1;
+	}
+	ProbabilityCorpusParser parser(corpusFilename);
+	Tri<double> tri;
+// the characters that follow every prefix of a word: the transitions
+// of the State of the prefix
+	std::map<std::string, std::set<unsigned char>> following;
+	std::set<unsigned char> alphabet;
+	for(std::string line; std::getline(corpus, line);) {
+		if(line.empty()) continue;
+		auto p(parser.parseLine(line));
+		tri.insert(p);
+		for(std::size_t i(0); i < p.first.size(); ++i) {
+			following[p.first.substr(0, i)].insert(p.first[i]);
+			alphabet.insert(p.first[i]);
+		}
+	}
+	tri.compact();
+
+// the same transitions in both containers, by the NodeType they take;
+// every present character is looked up as a hit, every other one of
+// the alphabet as a miss
+	std::vector<Transitions> nodes[nodeTypes];
+	std::vector<map_T> maps[nodeTypes];
+	std::vector<probe_T> hits[nodeTypes], misses[nodeTypes];
+	std::size_t transitions[nodeTypes] = {}, mapBytes[nodeTypes] = {};
+	unsigned int state(1);
+	for(auto f(following.cbegin()); f != following.cend(); ++f) {
+		Transitions t;
+		map_T m;
+		const std::size_t before(allocated);
+		for(auto c(f->second.cbegin()); c != f->second.cend(); ++c) {
+			t.insert(*c, state);
+			m.emplace(*c, state);
+			++state;
+		}
+		const unsigned int type(static_cast<unsigned int>(t.type()));
+		mapBytes[type] += allocated - before;
+		transitions[type] += t.size();
+		for(auto c(alphabet.cbegin()); c != alphabet.cend(); ++c) {
+			(f->second.count(*c) ? hits : misses)[type].push_back(probe_T(nodes[type].size(), *c));
+		}
+		nodes[type].push_back(std::move(t));
+		maps[type].push_back(std::move(m));
+	}
+
+	const Tri<double>::NodeStats stats(tri.getNodeStats());
+	std::cout << corpusFilename << ": " << tri.getStates() << " states, " << alphabet.size() << " characters; "
+		  << sizeof(Transitions) << " bytes per State for Transitions, " << sizeof(map_T) << " for a std::map" << std::endl;
+	std::cout << "type\tstates\tshare\tbytes/state\tmap\thit ns\tmap\tmiss ns\tmap\titerate ns\tmap" << std::endl;
+	unsigned long sum(0), mapSum(0);
+	std::size_t nodeBytes(0), allMapBytes(0);
+	for(unsigned int type(0); type < nodeTypes; ++type) {
+		const unsigned long n(stats.states[type]);
+		nodeBytes += n * sizeof(Transitions) + stats.heapBytes[type];
+// the States without transitions are not in the bench's nodes, but
+// in the Tri's node4 count
+		allMapBytes += n * sizeof(map_T) + mapBytes[type];
+		std::cout << typeNames[type] << '\t' << n << '\t' << std::fixed << std::setprecision(1)
+			  << 100.0 * n / tri.getStates() << "%\t";
+		if(!n || nodes[type].empty()) {
+			std::cout << '-' << std::endl;
+			continue;
+		}
+		std::cout << sizeof(Transitions) + double(stats.heapBytes[type]) / n << '\t'
+			  << sizeof(map_T) + double(mapBytes[type]) / n;
+		for(const std::vector<probe_T>* probes : {&hits[type], &misses[type]}) {
+			if(probes->empty()) {
+				std::cout << "\t-\t-";
+				continue;
+			}
+			const unsigned int rounds(std::max<unsigned long>(1, lookupCount / probes->size()));
+			const double node(lookups(nodes[type], *probes, rounds, sum));
+			std::cout << '\t' << node << '\t' << lookups(maps[type], *probes, rounds, mapSum);
+		}
+		const unsigned int rounds(std::max<unsigned long>(1, lookupCount / transitions[type]));
+		const double node(iterations(nodes[type], transitions[type], rounds, sum));
+		std::cout << '\t' << node << '\t' << iterations(maps[type], transitions[type], rounds, mapSum) << std::endl;
+	} // for type
+	if(sum != mapSum) {
+		std::cerr << "Transitions and std::map found different States." << std::endl;
+		return 1;
+	}
+	std::cout << "transitions of all States: " << nodeBytes / 1024 << " KiB, as std::maps " << allMapBytes / 1024
+		  << " KiB" << std::endl;
+	return 0;
+}
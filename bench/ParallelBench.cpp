@@ -0,0 +1,69 @@
+/* ParallelBench.cpp
+   Latency of single searches split over a growing number of threads.
+*/
+
+#include "../src/Tri.hpp"
+#include "../src/ProbabilityCorpusParser.hpp"
+#include <fstream>
+#include <random>
+#include <chrono>
+#include <iomanip>
+#include <algorithm>
+
+int main(int argc, char** argv) {
+	if(argc < 2) {
+		std::cerr << "Usage: " << argv[0] << " CORPUSFILE [QUERIES] [MAXTHREADS]" << std::endl;
+		return 1;
+	}
+	const std::string corpusFilename(argv[1]);
+	const unsigned int queryCount(argc > 2 ? std::stoi(argv[2]) : 50);
+	const unsigned int maxThreads(argc > 3 ? std::stoi(argv[3]) : std::max(2u, std::thread::hardware_concurrency()));
+
+	std::ifstream corpus(corpusFilename);
+	if(!corpus.is_open()) {
+		std::cerr << "Could not open '" << corpusFilename << "'." << std::endl;
+		return 1;
+	}
+	ProbabilityCorpusParser parser(corpusFilename);
+	Tri<double> tri;
+	std::vector<std::string> words;
+	for(std::string line; std::getline(corpus, line);) {
+		if(line.empty()) continue;
+		auto p(parser.parseLine(line));
+		tri.insert(p);
+		words.push_back(p.first);
+	}
+
+// misspell the first letter of random words, which makes the search
+// branch widely at the top of the Tri
+	std::mt19937 rng(772451);
+	std::uniform_int_distribution<std::size_t> pick(0, words.size() - 1);
+	std::vector<std::string> queries;
+	for(unsigned int i(0); i < queryCount; ++i) {
+		std::string q(words[pick(rng)]);
+		q[0] = q[0] == 'x' ? 'q' : 'x';
+		queries.push_back(q);
+	}
+
+	std::cout << corpusFilename << ": " << queries.size() << " queries, "
+		  << std::thread::hardware_concurrency() << " hardware threads" << std::endl;
+	std::cout << "dist\tthreads\tp50 us\tp99 us\tmax us" << std::endl;
+	for(unsigned int d(2); d <= 3; ++d) {
+		for(unsigned int threads(1); threads <= maxThreads; threads *= 2) {
+			ThreadPool pool(threads > 1 ? threads : 0);
+			std::vector<double> latencies;
+			for(auto q(queries.cbegin()); q != queries.cend(); ++q) {
+				const auto start(std::chrono::steady_clock::now());
+				tri.tolerantFindParallel(*q, d, pool);
+				const std::chrono::duration<double, std::micro> elapsed(std::chrono::steady_clock::now() - start);
+				latencies.push_back(elapsed.count());
+			}
+			std::sort(latencies.begin(), latencies.end());
+			std::cout << d << '\t' << threads << '\t' << std::fixed << std::setprecision(0)
+				  << latencies[latencies.size() / 2] << '\t'
+				  << latencies[latencies.size() * 99 / 100] << '\t'
+				  << latencies.back() << std::endl;
+		} // for threads
+	} // for d
+	return 0;
+}
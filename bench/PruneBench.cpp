@@ -0,0 +1,113 @@
+/* PruneBench.cpp
+   Counts how much of the Tri the CorrectionSearcher pre-filters save.
+*/
+
+#include "../src/Tri.hpp"
+#include "../src/ProbabilityCorpusParser.hpp"
+#include <fstream>
+#include <random>
+#include <chrono>
+#include <iomanip>
+
+/*! Misspells a word with a number of random unit edit operations.
+  \param w The word to misspell.
+  \param n The number of edit operations to apply.
+  \param rng The random number generator to use.
+  \return The misspelled word.
+*/
+static std::string misspell(std::string w, const unsigned int n, std::mt19937& rng) {
+	static const std::string alphabet("abcdefghijklmnopqrstuvwxyz");
+	std::uniform_int_distribution<int> op(0, 3);
+	std::uniform_int_distribution<std::size_t> letter(0, alphabet.size() - 1);
+	for(unsigned int k(0); k < n; ++k) {
+		std::uniform_int_distribution<std::size_t> pos(0, w.size());
+		const std::size_t i(pos(rng));
+		switch(op(rng)) {
+		case 0: // substitution
+			if(i < w.size()) w[i] = alphabet[letter(rng)];
+			break;
+		case 1: // insertion
+			w.insert(w.begin() + i, alphabet[letter(rng)]);
+			break;
+		case 2: // deletion
+			if(i < w.size() && w.size() > 1) w.erase(w.begin() + i);
+			break;
+		case 3: // transposition
+			if(i + 1 < w.size()) std::swap(w[i], w[i + 1]);
+			break;
+		} // switch
+	} // for
+	return w;
+} // misspell
+
+int main(int argc, char** argv) {
+	if(argc < 2) {
+		std::cerr << "Usage: " << argv[0] << " CORPUSFILE [QUERIES]" << std::endl;
+		return 1;
+	}
+	const std::string corpusFilename(argv[1]);
+	const unsigned int queryCount(argc > 2 ? std::stoi(argv[2]) : 300);
+
+	std::ifstream corpus(corpusFilename);
+	if(!corpus.is_open()) {
+		std::cerr << "Could not open '" << corpusFilename << "'." << std::endl;
+		return 1;
+	}
+	ProbabilityCorpusParser parser(corpusFilename);
+	Tri<double> tri;
+	std::vector<std::string> words;
+	for(std::string line; std::getline(corpus, line);) {
+		if(line.empty()) continue;
+		auto p(parser.parseLine(line));
+		tri.insert(p);
+		words.push_back(p.first);
+	}
+
+	std::mt19937 rng(772451);
+	std::uniform_int_distribution<std::size_t> pick(0, words.size() - 1);
+	std::vector<std::string> queries;
+	for(unsigned int i(0); i < queryCount; ++i) {
+		queries.push_back(misspell(words[pick(rng)], 1 + i % 3, rng));
+	}
+
+	const struct {
+		const char* name;
+		unsigned int flags;
+	} modes[] = {
+		{"none", CorrectionSearcher::pruneNone},
+		{"length", CorrectionSearcher::pruneLength},
+		{"letters", CorrectionSearcher::pruneLetters},
+		{"all", CorrectionSearcher::pruneAll}
+	};
+
+	std::cout << corpusFilename << ": " << words.size() << " words, "
+		  << tri.getStates() << " states, " << queries.size() << " queries" << std::endl;
+	std::cout << "dist\tpruning\texpanded\tpushed\tprunedLen\tprunedLet\tresults\tms" << std::endl;
+	for(unsigned int d(1); d <= 3; ++d) {
+		unsigned long unprunedExpanded(0);
+		for(auto m(std::begin(modes)); m != std::end(modes); ++m) {
+			SearchStats total;
+			unsigned long results(0);
+			const auto start(std::chrono::steady_clock::now());
+			for(auto q(queries.cbegin()); q != queries.cend(); ++q) {
+				CorrectionSearcher searcher(*q, d, m->flags);
+				results += tri.tolerantFindWith(searcher).size();
+				total += searcher.getStats();
+			}
+			const std::chrono::duration<double, std::milli> elapsed(std::chrono::steady_clock::now() - start);
+			if(m->flags == CorrectionSearcher::pruneNone)
+				unprunedExpanded = total.itemsExpanded;
+			std::cout << d << '\t' << m->name << '\t' << total.itemsExpanded
+				  << '\t' << total.itemsPushed << '\t' << total.prunedLength
+				  << '\t' << total.prunedLetters << '\t' << results << '\t'
+				  << std::fixed << std::setprecision(1) << elapsed.count();
+			if(unprunedExpanded > 0 && m->flags != CorrectionSearcher::pruneNone) {
+				std::cout << "\t(" << std::setprecision(1)
+					  << 100.0 * (1.0 - double(total.itemsExpanded) / unprunedExpanded)
+					  << "% fewer items)";
+			}
+			std::cout << std::endl;
+		} // for modes
+	} // for d
+	return 0;
+}
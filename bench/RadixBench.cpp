@@ -0,0 +1,108 @@
+/* RadixBench.cpp
+   Compares searches in a Tri and in the RadixTri built from it.
+*/
+
+#include "../src/RadixTri.hpp"
+#include "../src/ProbabilityCorpusParser.hpp"
+#include <fstream>
+#include <random>
+#include <chrono>
+#include <iomanip>
+#include <set>
+
+/*! Misspells a word with one random substitution and, for longer
+ *  words, a second one.
+  \param w The word to misspell.
+  \param rng The random number generator to use.
+  \return The misspelled word.
+*/
+static std::string misspell(std::string w, std::mt19937& rng) {
+	std::uniform_int_distribution<std::size_t> pos(0, w.size() - 1);
+	std::uniform_int_distribution<int> letter('a', 'z');
+	w[pos(rng)] = letter(rng);
+	if(w.size() > 8) {
+		w[pos(rng)] = letter(rng);
+	}
+	return w;
+} // misspell
+
+int main(int argc, char** argv) {
+	if(argc < 2) {
+		std::cerr << "Usage: " << argv[0] << " CORPUSFILE [QUERIES]" << std::endl;
+		return 1;
+	}
+	const std::string corpusFilename(argv[1]);
+	const unsigned int queryCount(argc > 2 ? std::stoi(argv[2]) : 300);
+
+	std::ifstream corpus(corpusFilename);
+	if(!corpus.is_open()) {
+		std::cerr << "Could not open '" << corpusFilename << "'." << std::endl;
+		return 1;
+	}
+	ProbabilityCorpusParser parser(corpusFilename);
+	Tri<double> tri;
+	std::vector<std::string> words;
+	for(std::string line; std::getline(corpus, line);) {
+		if(line.empty()) continue;
+		auto p(parser.parseLine(line));
+		tri.insert(p);
+		words.push_back(p.first);
+	}
+	tri.compact();
+	const RadixTri<double> radix(tri);
+	std::cout << corpusFilename << ": " << tri.getStates() << " states; radix: "
+		  << radix.getNodes() << " nodes, " << radix.getEdges() << " edges, "
+		  << radix.getLabelLength() << " label characters" << std::endl;
+
+// short and long words are searched separately; long ones have the
+// longest chains
+	std::mt19937 rng(772451);
+	std::uniform_int_distribution<std::size_t> pick(0, words.size() - 1);
+	std::vector<std::string> shortQueries, longQueries;
+	while(shortQueries.size() < queryCount || longQueries.size() < queryCount) {
+		const std::string& w(words[pick(rng)]);
+		std::vector<std::string>& queries(w.size() < 10 ? shortQueries : longQueries);
+		if(queries.size() < queryCount) {
+			queries.push_back(misspell(w, rng));
+		}
+	}
+
+	std::cout << "words\tdist\tsearch\titems/query\tus/query\tresults" << std::endl;
+	const struct {
+		const char* name;
+		const std::vector<std::string>* queries;
+	} sets[] = {{"short", &shortQueries}, {"long", &longQueries}};
+	unsigned long mismatches(0);
+	for(auto set(std::begin(sets)); set != std::end(sets); ++set) {
+		const std::vector<std::string>& queries(*set->queries);
+		for(unsigned int d(1); d <= 3; ++d) {
+			SearchStats triStats, radixStats;
+			unsigned long triResults(0), radixResults(0);
+			double triTime(0), radixTime(0);
+			for(auto q(queries.cbegin()); q != queries.cend(); ++q) {
+				auto start(std::chrono::steady_clock::now());
+				CorrectionSearcher searcher(*q, d);
+				const auto expected(tri.tolerantFindWith(searcher));
+				triTime += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+				triStats += searcher.getStats();
+				start = std::chrono::steady_clock::now();
+				const auto found(radix.tolerantFind(*q, d, &radixStats));
+				radixTime += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+				triResults += expected.size();
+				radixResults += found.size();
+// both must find the same keys at the same distances
+				std::set<std::pair<std::string, unsigned int>> a, b;
+				for(auto r(expected.cbegin()); r != expected.cend(); ++r) a.insert(std::make_pair(r->first, r->editDistance));
+				for(auto r(found.cbegin()); r != found.cend(); ++r) b.insert(std::make_pair(r->first, r->editDistance));
+				if(a != b) ++mismatches;
+			} // for queries
+			std::cout << std::fixed << std::setprecision(1)
+				  << set->name << '\t' << d << "\ttri\t" << double(triStats.itemsExpanded) / queries.size()
+				  << '\t' << triTime / queries.size() << '\t' << triResults << std::endl
+				  << set->name << '\t' << d << "\tradix\t" << double(radixStats.itemsExpanded) / queries.size()
+				  << '\t' << radixTime / queries.size() << '\t' << radixResults << std::endl;
+		} // for d
+	} // for sets
+	std::cout << mismatches << " queries with different results" << std::endl;
+	return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,79 @@
+/* SplitBench.cpp
+   Compares plain and split search on long words by typo position.
+*/
+
+#include "../src/SplitSearch.hpp"
+#include "../src/ProbabilityCorpusParser.hpp"
+#include <fstream>
+#include <random>
+#include <chrono>
+#include <iomanip>
+
+int main(int argc, char** argv) {
+	if(argc < 2) {
+		std::cerr << "Usage: " << argv[0] << " CORPUSFILE [QUERIES]" << std::endl;
+		return 1;
+	}
+	const std::string corpusFilename(argv[1]);
+	const unsigned int queryCount(argc > 2 ? std::stoi(argv[2]) : 100);
+
+	std::ifstream corpus(corpusFilename);
+	if(!corpus.is_open()) {
+		std::cerr << "Could not open '" << corpusFilename << "'." << std::endl;
+		return 1;
+	}
+	ProbabilityCorpusParser parser(corpusFilename);
+	Tri<double> tri, reversed;
+	std::vector<std::string> longWords;
+	for(std::string line; std::getline(corpus, line);) {
+		if(line.empty()) continue;
+		auto p(parser.parseLine(line));
+		tri.insert(p);
+		reversed.insert(std::string(p.first.crbegin(), p.first.crend()), p.second);
+		if(p.first.size() >= 12) longWords.push_back(p.first);
+	}
+	if(longWords.empty()) {
+		std::cerr << "No words of 12 or more characters in corpus." << std::endl;
+		return 1;
+	}
+
+	std::mt19937 rng(772451);
+	std::uniform_int_distribution<std::size_t> pick(0, longWords.size() - 1);
+	std::vector<std::string> words;
+	for(unsigned int i(0); i < queryCount; ++i) {
+		words.push_back(longWords[pick(rng)]);
+	}
+
+	std::cout << corpusFilename << ": " << longWords.size() << " words of 12 or more characters, "
+		  << words.size() << " queries" << std::endl;
+	std::cout << "dist\ttypos at\tplain us/query\tsplit us/query" << std::endl;
+	for(unsigned int d(1); d <= 3; ++d) {
+		const char* positions[] = {"start", "middle", "end"};
+		for(unsigned int where(0); where < 3; ++where) {
+// substitute d characters next to each other at the chosen position
+			std::vector<std::string> queries;
+			for(auto w(words.cbegin()); w != words.cend(); ++w) {
+				std::string q(*w);
+				const std::size_t first(where == 0 ? 0 : where == 1 ? q.size() / 2 - d / 2 : q.size() - d);
+				for(unsigned int k(0); k < d; ++k) {
+					q[first + k] = q[first + k] == 'x' ? 'q' : 'x';
+				}
+				queries.push_back(q);
+			}
+			double times[2];
+			for(unsigned int engine(0); engine < 2; ++engine) {
+				const auto start(std::chrono::steady_clock::now());
+				unsigned long results(0);
+				for(auto q(queries.cbegin()); q != queries.cend(); ++q) {
+					results += engine == 0 ? tri.tolerantFind(*q, d).size()
+						: splitTolerantFind(tri, reversed, *q, d).size();
+				}
+				const std::chrono::duration<double, std::micro> elapsed(std::chrono::steady_clock::now() - start);
+				times[engine] = elapsed.count() / queries.size();
+			}
+			std::cout << d << '\t' << positions[where] << '\t' << std::fixed << std::setprecision(1)
+				  << times[0] << '\t' << times[1] << std::endl;
+		} // for where
+	} // for d
+	return 0;
+}
@@ -0,0 +1,66 @@
+/* TextBench.cpp
+   Spell checking running text: a tolerant search for every word,
+   against the TextPipeline that searches only the distinct unknown
+   words of a batch.
+*/
+
+#include "../src/Suggest.hpp"
+#include "../src/TextPipeline.hpp"
+#include <sstream>
+#include <chrono>
+#include <iomanip>
+
+int main(int argc, char** argv) {
+	if(argc < 3) {
+		std::cerr << "Usage: " << argv[0] << " CORPUSFILE TEXTFILE [THREADS] [EDITDISTANCE]" << std::endl;
+		return 1;
+	}
+	const unsigned int threads(argc > 3 ? std::stoi(argv[3]) : 0);
+	const unsigned int editDistance(argc > 4 ? std::stoi(argv[4]) : 1);
+	std::string text;
+	{
+		std::ifstream file(argv[2]);
+		if(!file.is_open()) {
+			std::cerr << "Could not open '" << argv[2] << "'." << std::endl;
+			return 1;
+		}
+		std::ostringstream contents;
+		contents << file.rdbuf();
+		text = contents.str();
+	}
+	std::unique_ptr<ThreadPool> pool(threads > 1 ? new ThreadPool(threads) : nullptr);
+	const ProbabilitySuggest dictionary(argv[1], editDistance);
+
+// every word searched on one thread, like a loop over split sentences
+	unsigned long words(0), results(0);
+	auto start(std::chrono::steady_clock::now());
+	{
+		std::istringstream in(text);
+		std::vector<std::pair<std::size_t, std::size_t>> spans;
+		for(std::string line; std::getline(in, line);) {
+			Utf8::findWords(line, spans);
+			for(auto s(spans.cbegin()); s != spans.cend(); ++s) {
+				results += dictionary.ranked(line.substr(s->first, s->second)).size();
+			}
+			words += spans.size();
+		}
+	}
+	const std::chrono::duration<double> each(std::chrono::steady_clock::now() - start);
+
+	std::istringstream in(text);
+	std::ostringstream out;
+	TextPipeline<ProbabilitySuggest> pipeline(dictionary, pool.get(), TextMode::annotate, 0);
+	start = std::chrono::steady_clock::now();
+	const TextStats stats(pipeline.run(in, out));
+	const std::chrono::duration<double> piped(std::chrono::steady_clock::now() - start);
+
+	std::cout << argv[2] << ": " << text.size() << " bytes, " << stats.lines << " lines, " << stats.words
+		  << " words, " << stats.unknown << " unknown, " << stats.searched << " searched" << std::endl;
+	std::cout << std::fixed << std::setprecision(3);
+	std::cout << "mode\tsearches\tseconds\tMB/s" << std::endl;
+	std::cout << "every word\t" << words << '\t' << each.count() << '\t' << text.size() / each.count() / 1e6 << std::endl;
+	std::cout << "pipeline\t" << stats.searched << '\t' << piped.count() << '\t' << text.size() / piped.count() / 1e6
+		  << "\t(" << (pool ? pool->size() : 0) << " threads)" << std::endl;
+	std::cerr << "(checksum " << results + out.str().size() << ")" << std::endl;
+	return words == stats.words ? 0 : 1;
+}
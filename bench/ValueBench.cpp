@@ -0,0 +1,157 @@
+/* ValueBench.cpp
+   Memory and lookup time of the values of a Tri: a hash map from end
+   states to values, the dense value array and quantized 16 bit codes.
+*/
+
+#include "../src/Tri.hpp"
+#include "../src/ProbabilityCorpusParser.hpp"
+#include <fstream>
+#include <random>
+#include <chrono>
+#include <iomanip>
+#include <unordered_map>
+
+//! Bytes currently allocated through CountingAllocator.
+static std::size_t allocated(0);
+
+/*! An allocator that counts the bytes it hands out, to measure the
+ *  memory of a standard container. */
+template <class T>
+struct CountingAllocator {
+	typedef T value_type;
+	CountingAllocator() {}
+	template <class U>
+	CountingAllocator(const CountingAllocator<U>&) {}
+	T* allocate(const std::size_t n) {
+		allocated += n * sizeof(T);
+		return static_cast<T*>(::operator new(n * sizeof(T)));
+	}
+	void deallocate(T* p, const std::size_t n) {
+		allocated -= n * sizeof(T);
+		::operator delete(p);
+	}
+	template <class U>
+	bool operator==(const CountingAllocator<U>&) const { return true; }
+	template <class U>
+	bool operator!=(const CountingAllocator<U>&) const { return false; }
+}; // CountingAllocator
+
+//! The value table that Tris used to have: end state names to values.
+typedef std::unordered_map<unsigned int, double, std::hash<unsigned int>, std::equal_to<unsigned int>,
+			   CountingAllocator<std::pair<const unsigned int, double>>> valueMap_T;
+
+/*! Reads values in a random order and prints the time per read.
+  \param name The value storage, for the output.
+  \param order The indices to read, in the order to read them.
+  \param read Returns the value with an index.
+  \return The sum of the values, so that the reads are not optimized
+  away.
+*/
+template <typename read_T>
+static double timeReads(const char* name, const std::vector<unsigned int>& order, read_T read) {
+	double sum(0);
+	const auto start(std::chrono::steady_clock::now());
+	for(auto i(order.cbegin()); i != order.cend(); ++i) {
+		sum += read(*i);
+	}
+	const std::chrono::duration<double, std::nano> elapsed(std::chrono::steady_clock::now() - start);
+	std::cout << name << "\tns/read\t" << std::setprecision(1) << elapsed.count() / order.size() << std::endl;
+	return sum;
+} // timeReads
+
+/*! Sorts search results the way Suggest ranks them: by edit distance,
+ *  then by descending value; equal ones by key, so that the order is
+ *  total. */
+static void rank(std::vector<Tri<double>::TolerantResult>& results) {
+	std::sort(results.begin(), results.end(), [](const Tri<double>::TolerantResult& a, const Tri<double>::TolerantResult& b) {
+			if(a.editDistance != b.editDistance) return a.editDistance < b.editDistance;
+			if(a.second != b.second) return a.second > b.second;
+			return a.first < b.first;
+		});
+} // rank
+
+int main(int argc, char** argv) {
+	if(argc < 2) {
+		std::cerr << "Usage: " << argv[0] << " CORPUSFILE [QUERIES]" << std::endl;
+		return 1;
+	}
+	const std::string corpusFilename(argv[1]);
+	const unsigned int queryCount(argc > 2 ? std::stoi(argv[2]) : 300);
+
+	std::ifstream corpus(corpusFilename);
+	if(!corpus.is_open()) {
+		std::cerr << "Could not open '" << corpusFilename << "'." << std::endl;
+		return 1;
+	}
+	ProbabilityCorpusParser parser(corpusFilename);
+	Tri<double> tri;
+	std::vector<std::string> words;
+	valueMap_T map;
+	for(std::string line; std::getline(corpus, line);) {
+		if(line.empty()) continue;
+		auto p(parser.parseLine(line));
+		tri.insert(p);
+		words.push_back(p.first);
+// the state names do not matter for the size of the map
+		map[words.size()] = p.second;
+	}
+	tri.compact();
+	Tri<double> quantized(tri.makeCopy());
+	quantized.quantize();
+
+	std::cout << corpusFilename << ": " << words.size() << " words" << std::endl;
+	std::cout << std::fixed;
+	std::cout << "hash map\tbytes\t" << allocated << std::endl;
+	std::cout << "array\tbytes\t" << tri.getValueBytes() << std::endl;
+	std::cout << "quantized\tbytes\t" << quantized.getValueBytes() << std::endl;
+
+// the three ways to get the value of a found key, without the walk
+// through the Tri that finds it; the array and the codes are built
+// like Tri::compact and Tri::quantize build theirs
+	std::vector<double> array(words.size());
+	for(auto kv(map.cbegin()); kv != map.cend(); ++kv) {
+		array[kv->first - 1] = kv->second;
+	}
+	std::vector<double> codebook(array);
+	std::sort(codebook.begin(), codebook.end());
+	codebook.erase(std::unique(codebook.begin(), codebook.end()), codebook.end());
+	std::vector<std::uint16_t> codes;
+	for(auto v(array.cbegin()); v != array.cend(); ++v) {
+		codes.push_back(std::lower_bound(codebook.cbegin(), codebook.cend(), *v) - codebook.cbegin());
+	}
+	std::vector<unsigned int> order(words.size());
+	for(unsigned int i(0); i < order.size(); ++i) {
+		order[i] = i;
+	}
+	std::mt19937 rng(772451);
+	std::shuffle(order.begin(), order.end(), rng);
+	double sum(0);
+	sum += timeReads("hash map", order, [&](const unsigned int i) { return map.at(i + 1); });
+	sum += timeReads("array", order, [&](const unsigned int i) { return array[i]; });
+	sum += timeReads("quantized", order, [&](const unsigned int i) { return codebook[codes[i]]; });
+	std::shuffle(words.begin(), words.end(), rng);
+
+// quantized values must rank suggestions like the exact ones
+	double maxError(0);
+	for(auto w(words.cbegin()); w != words.cend(); ++w) {
+		maxError = std::max(maxError, std::fabs(*tri.unsafeGet(*w) - *quantized.unsafeGet(*w)));
+	}
+	unsigned long reordered(0);
+	for(unsigned int i(0); i < queryCount && i < words.size(); ++i) {
+		std::string q(words[i]);
+		q[i % q.size()] = 'a' + i % 26;
+		auto exact(tri.tolerantFind(q, 2)), coded(quantized.tolerantFind(q, 2));
+		rank(exact);
+		rank(coded);
+		bool same(exact.size() == coded.size());
+		for(std::size_t r(0); same && r < exact.size(); ++r) {
+			same = exact[r].first == coded[r].first;
+		}
+		reordered += same ? 0 : 1;
+	}
+	std::cout << "quantized\tmax error\t" << std::setprecision(9) << maxError << std::endl;
+	std::cout << "quantized\treordered\t" << reordered << " of " << std::min<std::size_t>(queryCount, words.size())
+		  << " rankings at edit distance 2" << std::endl;
+	std::cerr << "(checksum " << sum << ")" << std::endl;
+	return reordered ? 1 : 0;
+}
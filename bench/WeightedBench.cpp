@@ -0,0 +1,127 @@
+/* WeightedBench.cpp
+   Compares a unit edit distance search with a cost-bounded weighted
+   search on keyboard typing errors.
+*/
+
+#include "../src/Tri.hpp"
+#include "../src/ProbabilityCorpusParser.hpp"
+#include "../src/WeightedCorrectionSearcher.hpp"
+#include <fstream>
+#include <random>
+#include <chrono>
+#include <iomanip>
+#include <map>
+
+/*! Misspells a word like a typist: each error either hits a key
+ *  next to the intended one or swaps two adjacent keys.
+  \param w The word to misspell.
+  \param n The number of errors to make.
+  \param neighbours Adjacent keys for every key.
+  \param rng The random number generator to use.
+  \return The misspelled word.
+*/
+static std::string mistype(std::string w, const unsigned int n, const std::map<char, std::string>& neighbours, std::mt19937& rng) {
+	for(unsigned int k(0); k < n; ++k) {
+		std::uniform_int_distribution<std::size_t> pos(0, w.size() - 1);
+		const std::size_t i(pos(rng));
+		auto keys(neighbours.find(w[i]));
+		if(i + 1 < w.size() && (k % 2 == 1 || keys == neighbours.end())) {
+			std::swap(w[i], w[i + 1]);
+		} else if(keys != neighbours.end()) {
+			std::uniform_int_distribution<std::size_t> key(0, keys->second.size() - 1);
+			w[i] = keys->second[key(rng)];
+		}
+	} // for
+	return w;
+} // mistype
+
+/*! Runs all queries with one kind of searcher and prints a line of
+ *  totals.
+  \param name The name of the search in the output.
+  \param tri The Tri to search.
+  \param queries Misspelled words and the words they were made from.
+  \param make Creates a searcher for a query.
+*/
+template <typename searcher_T, typename make_T>
+static void run(const char* name, const Tri<double>& tri, const std::vector<std::pair<std::string, std::string>>& queries, make_T make) {
+	SearchStats total;
+	unsigned long results(0), recalled(0), top(0);
+	const auto start(std::chrono::steady_clock::now());
+	for(auto q(queries.cbegin()); q != queries.cend(); ++q) {
+		std::unique_ptr<searcher_T> searcher(make(q->first));
+		const auto found(tri.tolerantFindWith(*searcher));
+		total += searcher->getStats();
+		results += found.size();
+// the best result has the lowest cost, then the highest probability
+		auto best(found.cend());
+		for(auto r(found.cbegin()); r != found.cend(); ++r) {
+			if(r->first == q->second) ++recalled;
+			if(best == found.cend() || r->cost < best->cost - 1e-6
+			   || (r->cost < best->cost + 1e-6 && r->second > best->second)) {
+				best = r;
+			}
+		}
+		if(best != found.cend() && best->first == q->second) ++top;
+	} // for
+	const std::chrono::duration<double, std::milli> elapsed(std::chrono::steady_clock::now() - start);
+	std::cout << name << '\t' << total.itemsExpanded << '\t' << results << '\t'
+		  << recalled << '\t' << top << '\t'
+		  << std::fixed << std::setprecision(1) << elapsed.count() << std::endl;
+} // run
+
+int main(int argc, char** argv) {
+	if(argc < 3) {
+		std::cerr << "Usage: " << argv[0] << " CORPUSFILE COSTFILE [QUERIES]" << std::endl;
+		return 1;
+	}
+	const std::string corpusFilename(argv[1]);
+	const CostMatrix costs(argv[2]);
+	const unsigned int queryCount(argc > 3 ? std::stoi(argv[3]) : 300);
+
+	std::ifstream corpus(corpusFilename);
+	if(!corpus.is_open()) {
+		std::cerr << "Could not open '" << corpusFilename << "'." << std::endl;
+		return 1;
+	}
+	ProbabilityCorpusParser parser(corpusFilename);
+	Tri<double> tri;
+	std::vector<std::string> words;
+	for(std::string line; std::getline(corpus, line);) {
+		if(line.empty()) continue;
+		auto p(parser.parseLine(line));
+		tri.insert(p);
+		if(p.first.size() > 2) words.push_back(p.first);
+	}
+
+// neighbours are the keys whose substitution is cheaper than a unit edit
+	std::map<char, std::string> neighbours;
+	for(unsigned int a('a'); a <= 'z'; ++a) {
+		for(unsigned int b('a'); b <= 'z'; ++b) {
+			if(a != b && costs.substitution(a, b) < 1.0f) {
+				neighbours[a].push_back(b);
+			}
+		}
+	}
+
+	std::mt19937 rng(772451);
+	std::uniform_int_distribution<std::size_t> pick(0, words.size() - 1);
+	std::vector<std::pair<std::string, std::string>> queries;
+	for(unsigned int i(0); i < queryCount; ++i) {
+		const std::string& w(words[pick(rng)]);
+		queries.push_back(std::make_pair(mistype(w, 2, neighbours, rng), w));
+	}
+
+	std::cout << corpusFilename << ": " << words.size() << " words, "
+		  << queries.size() << " queries with two typing errors each" << std::endl;
+	std::cout << "search\texpanded\tresults\trecalled\ttop1\tms" << std::endl;
+	run<CorrectionSearcher>("unit e2", tri, queries, [](const std::string& q) {
+			return new CorrectionSearcher(q, 2);
+		});
+	run<WeightedCorrectionSearcher>("cost 1.0", tri, queries, [&costs](const std::string& q) {
+			return new WeightedCorrectionSearcher(q, costs, 1.0);
+		});
+	run<WeightedCorrectionSearcher>("cost 2.0", tri, queries, [&costs](const std::string& q) {
+			return new WeightedCorrectionSearcher(q, costs, 2.0);
+		});
+	return 0;
+}
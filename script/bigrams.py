@@ -0,0 +1,32 @@
+#! /usr/bin/python
+
+# Writes a bigram corpus for bin/buildbigrams to standard output: one
+# line PREVIOUS<TAB>NEXT<TAB>LOGPROB for every pair of words that
+# follow each other in the input, with the log of the probability of
+# NEXT after PREVIOUS. The input has one word per line, like the input
+# of corpus.py; lines that are not words (empty lines, punctuation)
+# separate sentences, and no pair spans them.
+
+import sys
+from math import log
+from collections import Counter
+
+def main(argv):
+    filename = argv[1]
+    pairs = Counter()
+    firsts = Counter()
+    previous = None
+    for w in open(filename, "r").read().split("\n"):
+        if not w.isalpha():
+            previous = None
+            continue
+        if previous is not None:
+            pairs[(previous, w)] += 1
+            firsts[previous] += 1
+        previous = w
+
+    for ((first, second), count) in sorted(pairs.items()):
+        print(first + "\t" + second + "\t" + str(log(count / float(firsts[first]))))
+
+if(__name__=="__main__"):
+    main(sys.argv)
@@ -0,0 +1,36 @@
+#! /usr/bin/python
+
+# Writes a cost file for dym --costs to standard output: substituting
+# a key by one of its neighbours on a QWERTY keyboard is cheaper than
+# other substitutions, and so are transpositions of two keys.
+
+import sys
+
+ROWS = ["qwertyuiop", "asdfghjkl", "zxcvbnm"]
+# horizontal offset of each row, in key widths
+OFFSETS = [0.0, 0.25, 0.75]
+
+def neighbours():
+    pos = {}
+    for (r, row) in enumerate(ROWS):
+        for (c, key) in enumerate(row):
+            pos[key] = (r, c + OFFSETS[r])
+    for a in sorted(pos):
+        for b in sorted(pos):
+            (ra, ca) = pos[a]
+            (rb, cb) = pos[b]
+            if a != b and abs(ra - rb) <= 1 and abs(ca - cb) <= 1.0:
+                yield (a, b)
+
+def main(argv):
+    adjacent = argv[1] if len(argv) > 1 else "0.5"
+    print("# QWERTY keyboard adjacency costs, written by script/keyboard.py")
+    print("default sub 1")
+    print("default ins 1")
+    print("default del 1")
+    print("default trans 0.5")
+    for (a, b) in neighbours():
+        print("sub " + a + " " + b + " " + adjacent)
+
+if(__name__=="__main__"):
+    main(sys.argv)
@@ -0,0 +1,68 @@
+
+#include "Alphabet.hpp"
+#include "Utf8.hpp"
+#include <stdexcept>
+
+Alphabet::Alphabet(const bool foldCase)
+	: _foldCase(foldCase), _latin(256, unknown), _symbols(), _codePoints(1, 0), _scratch() {}
+
+/*! \param word A word in UTF-8.
+ \return The symbols of the normalized word.
+*/
+std::string Alphabet::learn(const std::string& word) {
+	if(!Utf8::normalize(word, _scratch, _foldCase)) {
+		throw std::runtime_error("error in Alphabet: '" + word + "' is not valid UTF-8.");
+	}
+	std::string symbols;
+	symbols.reserve(_scratch.size());
+	for(auto c(_scratch.cbegin()); c != _scratch.cend(); ++c) {
+		unsigned char s(symbol(*c));
+		if(s == unknown) {
+			if(_codePoints.size() > 255) {
+				throw std::runtime_error("error in Alphabet: more than 255 different characters.");
+			}
+			s = (unsigned char)_codePoints.size();
+			_codePoints.push_back(*c);
+			if(*c < 256) {
+				_latin[*c] = s;
+			} else {
+				_symbols.insert(std::make_pair(*c, s));
+			}
+		}
+		symbols.push_back(char(s));
+	} // for
+	return symbols;
+} // learn
+
+/*! Queries are normalized like the words of the dictionary; a query
+ *  that is not well-formed UTF-8 becomes one unknown symbol per byte.
+ \param word A word in UTF-8.
+ \return The symbols of the normalized word.
+*/
+std::string Alphabet::encode(const std::string& word) const {
+	std::string symbols;
+	std::u32string codePoints;
+	encode(word, symbols, codePoints);
+	return symbols;
+} // encode
+
+void Alphabet::encode(const std::string& word, std::string& symbols, std::u32string& codePoints) const {
+	if(!Utf8::normalize(word, codePoints, _foldCase)) {
+		symbols.assign(word.size(), char(unknown));
+		return;
+	}
+	symbols.clear();
+	symbols.reserve(codePoints.size());
+	for(auto c(codePoints.cbegin()); c != codePoints.cend(); ++c) {
+		symbols.push_back(char(symbol(*c)));
+	}
+} // encode
+
+std::string Alphabet::decode(const std::string& symbols) const {
+	std::string word;
+	word.reserve(symbols.size() * 2);
+	for(auto s(symbols.cbegin()); s != symbols.cend(); ++s) {
+		Utf8::append(word, _codePoints[(unsigned char)*s]);
+	}
+	return word;
+} // decode
@@ -0,0 +1,100 @@
+/* Alphabet.hpp
+   Dense symbols for the code points of a dictionary.
+*/
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#ifndef __ALPHABET_HPP__
+#define __ALPHABET_HPP__
+
+/*! Maps the code points of a dictionary to a dense range of one byte
+ *  symbols.
+
+  A Tri stores its keys byte by byte, so a word in UTF-8 would take
+  two transitions for every umlaut, and one wrong umlaut would count
+  as two edit operations. An Alphabet gives every code point that
+  occurs in a dictionary its own symbol instead, in the order of first
+  appearance, starting at 1. Keys in the Tri are strings of symbols:
+  every edit operation applies to a whole code point, the transitions
+  of a State only use the few symbols of the dictionary, and the
+  letter sets of CorrectionSearcher rarely collide for alphabets of
+  less than 64 letters.
+
+  Words are normalized before they are mapped: combining marks are
+  composed with their letter (see Utf8::normalize) and, if the
+  Alphabet folds case, upper case letters are mapped to lower case.
+  This is done once for every word of the dictionary when it is
+  loaded, and once for every query.
+
+  Code points of a query that do not occur in the dictionary are
+  mapped to the symbol \cword unknown , which no key contains, so
+  they can only be substituted or deleted. A dictionary can have at
+  most 255 different code points.
+  \sa Utf8
+*/
+class Alphabet {
+private:
+	bool _foldCase; /*!< Whether upper case letters are folded to
+			  lower case. */
+	std::vector<unsigned char> _latin; /*!< Symbols of the code
+					     points below 256, for fast
+					     lookups; 0 if not assigned. */
+	std::unordered_map<char32_t, unsigned char> _symbols; /*!<
+					Symbols of the other code
+					points. */
+	std::vector<char32_t> _codePoints; /*!< Code point of every
+					     symbol. */
+	std::u32string _scratch; /*!< Reused buffer for normalized
+				   words while learning. */
+
+public:
+//! The symbol of code points that are not part of the alphabet.
+	static const unsigned char unknown = 0;
+
+/*! Creates an empty alphabet.
+  \param foldCase Whether words are folded to lower case.
+*/
+	explicit Alphabet(const bool foldCase = false);
+
+/*! Maps a word to symbols, adding its new code points to the
+ *  alphabet. Throws std::runtime_error if the word is not well-formed
+ *  UTF-8 or the alphabet would grow beyond 255 code points. */
+	std::string learn(const std::string& word);
+/*! Maps a word to symbols without changing the alphabet; unknown
+ *  code points and malformed bytes become \cword unknown . */
+	std::string encode(const std::string& word) const;
+/*! Like encode , into strings of the caller, so that a caller that
+ *  keeps them does not allocate once they are long enough.
+  \param word A word in UTF-8.
+  \param symbols Set to the symbols of the normalized word.
+  \param codePoints Holds the code points of the normalized word on
+  the way.
+*/
+	void encode(const std::string& word, std::string& symbols, std::u32string& codePoints) const;
+//! Maps a string of symbols back to UTF-8.
+	std::string decode(const std::string& symbols) const;
+//! The symbol of a (normalized) code point, or \cword unknown .
+	unsigned char symbol(const char32_t codePoint) const {
+		if(codePoint < 256) {
+			return _latin[codePoint];
+		}
+		auto found(_symbols.find(codePoint));
+		return found == _symbols.end() ? unknown : found->second;
+	}
+//! The code point of a symbol.
+	char32_t codePoint(const unsigned char symbol) const {
+		return _codePoints[symbol];
+	}
+//! The number of code points in the alphabet.
+	std::size_t size() const {
+		return _codePoints.size() - 1;
+	}
+//! Whether words are folded to lower case.
+	bool foldsCase() const {
+		return _foldCase;
+	}
+}; // Alphabet
+
+#endif
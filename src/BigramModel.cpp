@@ -0,0 +1,328 @@
+
+#include "BigramModel.hpp"
+#include "CorpusParser.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+const unsigned int BigramModel::unknownWord;
+const float BigramModel::absent = -std::numeric_limits<float>::infinity();
+
+//! One bit in this many ones of the high bit vector is sampled.
+static const unsigned int selectSample = 256;
+//! The model files this version reads and writes.
+static const char modelMagic[8] = {'d', 'y', 'm', 'b', 'i', 'g', 'r', '1'};
+//! The most codes of 16 bits.
+static const unsigned int codeLevels = 1u << 16;
+
+//! Sections of a model file start at multiples of 8 bytes.
+static std::size_t padded(const std::size_t bytes) {
+	return (bytes + 7) & ~std::size_t(7);
+}
+
+/*! The sections are checked against the file size before any of them
+ *  is touched, so that a truncated file is an error and not a crash.
+ \param filename A file written by build .
+*/
+BigramModel::BigramModel(const std::string& filename)
+	: _mapping(nullptr), _size(0), _words(0), _pairs(0), _lowBits(0), _spellingOffsets(nullptr), _spellings(nullptr),
+	  _firstPair(nullptr), _low(nullptr), _high(nullptr), _samples(nullptr), _codes(nullptr), _codebook(nullptr) {
+	const int fd(open(filename.c_str(), O_RDONLY));
+	if(fd < 0) {
+		throw std::runtime_error("error in BigramModel: File '" + filename + "' could not be opened.");
+	}
+	struct stat status;
+	if(fstat(fd, &status) != 0 || std::size_t(status.st_size) < sizeof(_Header)) {
+		close(fd);
+		throw std::runtime_error("error in BigramModel: '" + filename + "' is not a bigram model.");
+	}
+	_size = status.st_size;
+	_mapping = mmap(nullptr, _size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if(_mapping == MAP_FAILED) {
+		_mapping = nullptr;
+		throw std::runtime_error("error in BigramModel: File '" + filename + "' could not be mapped.");
+	}
+	const char* data(static_cast<const char*>(_mapping));
+	_Header header;
+	std::memcpy(&header, data, sizeof(header));
+	_words = header.words;
+	_pairs = header.pairs;
+	_lowBits = header.lowBits;
+	std::size_t offset(sizeof(header));
+	const std::size_t spellingOffsets(offset);
+	offset += padded(4 * (std::size_t(_words) + 1));
+	const std::size_t spellings(offset);
+	offset += padded(header.spellingBytes);
+	const std::size_t firstPair(offset);
+	offset += padded(4 * (std::size_t(_words) + 1));
+	const std::size_t low(offset);
+	offset += 8 * ((std::uint64_t(_pairs) * _lowBits + 63) / 64);
+	const std::size_t high(offset);
+	offset += 8 * ((header.highBits + 63) / 64);
+	const std::size_t samples(offset);
+	offset += 8 * ((std::size_t(_pairs) + selectSample - 1) / selectSample);
+	const std::size_t codes(offset);
+	offset += padded(2 * std::size_t(_pairs));
+	const std::size_t codebook(offset);
+	offset += padded(4 * std::size_t(header.codebookSize));
+	if(std::memcmp(header.magic, modelMagic, sizeof(modelMagic)) != 0 || _lowBits > 32 || offset != _size) {
+		munmap(_mapping, _size);
+		_mapping = nullptr;
+		throw std::runtime_error("error in BigramModel: '" + filename + "' is not a bigram model.");
+	}
+	_spellingOffsets = reinterpret_cast<const std::uint32_t*>(data + spellingOffsets);
+	_spellings = data + spellings;
+	_firstPair = reinterpret_cast<const std::uint32_t*>(data + firstPair);
+	_low = reinterpret_cast<const std::uint64_t*>(data + low);
+	_high = reinterpret_cast<const std::uint64_t*>(data + high);
+	_samples = reinterpret_cast<const std::uint64_t*>(data + samples);
+	_codes = reinterpret_cast<const std::uint16_t*>(data + codes);
+	_codebook = reinterpret_cast<const float*>(data + codebook);
+	if(_spellingOffsets[_words] != header.spellingBytes || _firstPair[_words] != _pairs) {
+		munmap(_mapping, _size);
+		_mapping = nullptr;
+		throw std::runtime_error("error in BigramModel: '" + filename + "' is damaged.");
+	}
+} // BigramModel ctor
+
+BigramModel::~BigramModel() {
+	if(_mapping) {
+		munmap(_mapping, _size);
+	}
+} // BigramModel dtor
+
+std::uint64_t BigramModel::_select(const std::uint32_t i) const {
+	const std::uint64_t sampled(_samples[i / selectSample]);
+	unsigned int rest(i % selectSample);
+	std::uint64_t word(sampled / 64);
+	std::uint64_t bits(_high[word] & (~0ull << (sampled % 64)));
+	for(unsigned int ones(__builtin_popcountll(bits)); rest >= ones; ones = __builtin_popcountll(bits)) {
+		rest -= ones;
+		bits = _high[++word];
+	}
+	for(; rest > 0; --rest) {
+		bits &= bits - 1;
+	}
+	return word * 64 + __builtin_ctzll(bits);
+} // _select
+
+std::uint64_t BigramModel::_lowOf(const std::uint32_t i) const {
+	if(_lowBits == 0) {
+		return 0;
+	}
+	const std::uint64_t bit(std::uint64_t(i) * _lowBits);
+	const unsigned int shift(bit % 64);
+	std::uint64_t value(_low[bit / 64] >> shift);
+	if(shift + _lowBits > 64) {
+		value |= _low[bit / 64 + 1] << (64 - shift);
+	}
+	return value & ((1ull << _lowBits) - 1);
+} // _lowOf
+
+unsigned int BigramModel::id(const std::string& word) const {
+	std::uint32_t first(0), last(_words);
+	while(first < last) {
+		const std::uint32_t middle(first + (last - first) / 2);
+		const int order(word.compare(0, word.size(), _spellings + _spellingOffsets[middle],
+					     _spellingOffsets[middle + 1] - _spellingOffsets[middle]));
+		if(order == 0) {
+			return middle;
+		} else if(order < 0) {
+			last = middle;
+		} else {
+			first = middle + 1;
+		}
+	}
+	return unknownWord;
+} // id
+
+/*! The pairs of the previous word are consecutive in the Elias-Fano
+ *  sequence: the first one is found with _select , the others by
+ *  scanning to the next one bits. The decoded successor ids are
+ *  sorted, so every candidate is a binary search in them.
+*/
+void BigramModel::score(const unsigned int previous, const unsigned int* candidates, const std::size_t count, float* logProbs) const {
+	std::fill(logProbs, logProbs + count, absent);
+	if(previous >= _words || _firstPair[previous] == _firstPair[previous + 1]) {
+		return;
+	}
+	const std::uint32_t begin(_firstPair[previous]), end(_firstPair[previous + 1]);
+	const std::uint64_t base(std::uint64_t(previous) * _words);
+	std::vector<std::uint32_t> next(end - begin);
+	std::uint64_t position(_select(begin));
+	for(std::uint32_t i(begin); i < end; ++i) {
+		if(i > begin) {
+			++position;
+			std::uint64_t word(position / 64);
+			std::uint64_t bits(_high[word] & (~0ull << (position % 64)));
+			while(!bits) {
+				bits = _high[++word];
+			}
+			position = word * 64 + __builtin_ctzll(bits);
+		}
+		next[i - begin] = std::uint32_t((((position - i) << _lowBits) | _lowOf(i)) - base);
+	} // for
+	for(std::size_t c(0); c < count; ++c) {
+		auto found(std::lower_bound(next.cbegin(), next.cend(), candidates[c]));
+		if(found != next.cend() && *found == candidates[c]) {
+			logProbs[c] = _codebook[_codes[begin + (found - next.cbegin())]];
+		}
+	}
+} // score
+
+void BigramModel::build(std::istream& in, const std::string& name, std::ostream& out) {
+	struct Line {
+		std::string previous, next;
+		float logProb;
+	};
+	std::vector<Line> lines;
+	unsigned int lineNumber(0);
+	for(std::string line; std::getline(in, line);) {
+		++lineNumber;
+		if(line.empty()) continue;
+		const std::size_t tab1(line.find('\t'));
+		const std::size_t tab2(tab1 == std::string::npos ? tab1 : line.find('\t', tab1 + 1));
+		bool ok(tab1 != std::string::npos && tab2 != std::string::npos && tab1 > 0 && tab2 > tab1 + 1);
+		double logProb(0);
+		if(ok) {
+			std::size_t end(0);
+			try {
+				logProb = std::stod(line.substr(tab2 + 1), &end);
+			} catch(std::exception&) {
+				end = 0;
+			}
+			ok = end > 0 && tab2 + 1 + end == line.size() && std::isfinite(logProb) && logProb <= 0;
+		}
+		if(!ok) {
+			std::ostringstream message;
+			message << name << ", line:" << lineNumber << std::endl
+				<< "Malformed bigram '" << line << "'.";
+			throw ParseError(message.str());
+		}
+		lines.push_back(Line{line.substr(0, tab1), line.substr(tab1 + 1, tab2 - tab1 - 1), float(logProb)});
+	} // for
+
+// ids in the byte order of the spellings, as id looks them up
+	std::vector<std::string> words;
+	words.reserve(2 * lines.size());
+	for(auto l(lines.cbegin()); l != lines.cend(); ++l) {
+		words.push_back(l->previous);
+		words.push_back(l->next);
+	}
+	std::sort(words.begin(), words.end());
+	words.erase(std::unique(words.begin(), words.end()), words.end());
+	std::unordered_map<std::string, std::uint32_t> ids;
+	for(std::uint32_t i(0); i < words.size(); ++i) {
+		ids.insert(std::make_pair(words[i], i));
+	}
+	const std::uint64_t wordCount(words.size());
+	std::vector<std::pair<std::uint64_t, float>> pairs;
+	pairs.reserve(lines.size());
+	for(auto l(lines.cbegin()); l != lines.cend(); ++l) {
+		pairs.push_back(std::make_pair(ids[l->previous] * wordCount + ids[l->next], l->logProb));
+	}
+	std::vector<Line>().swap(lines);
+	std::sort(pairs.begin(), pairs.end());
+	for(std::size_t i(1); i < pairs.size(); ++i) {
+		if(pairs[i].first == pairs[i - 1].first) {
+			throw ParseError(name + ": the pair '" + words[pairs[i].first / wordCount] + "' '"
+					 + words[pairs[i].first % wordCount] + "' is given twice.");
+		}
+	}
+
+	_Header header;
+	std::memcpy(header.magic, modelMagic, sizeof(modelMagic));
+	header.words = words.size();
+	header.pairs = pairs.size();
+	const std::uint64_t universe(std::max<std::uint64_t>(wordCount * wordCount, 1));
+	header.lowBits = 0;
+	while(!pairs.empty() && (universe / pairs.size()) >> (header.lowBits + 1)) {
+		++header.lowBits;
+	}
+	header.highBits = pairs.empty() ? 0 : ((universe - 1) >> header.lowBits) + pairs.size() + 1;
+
+	std::vector<std::uint32_t> spellingOffsets(1, 0);
+	std::string spellings;
+	for(auto w(words.cbegin()); w != words.cend(); ++w) {
+		spellings += *w;
+		spellingOffsets.push_back(spellings.size());
+	}
+	header.spellingBytes = spellings.size();
+	std::vector<std::uint32_t> firstPair(words.size() + 1, 0);
+	for(auto p(pairs.cbegin()); p != pairs.cend(); ++p) {
+		++firstPair[p->first / wordCount + 1];
+	}
+	for(std::size_t w(1); w < firstPair.size(); ++w) {
+		firstPair[w] += firstPair[w - 1];
+	}
+	std::vector<std::uint64_t> low((pairs.size() * header.lowBits + 63) / 64 + 1, 0);
+	std::vector<std::uint64_t> high((header.highBits + 63) / 64, 0);
+	std::vector<std::uint64_t> samples;
+	for(std::size_t i(0); i < pairs.size(); ++i) {
+		const std::uint64_t x(pairs[i].first);
+		if(header.lowBits > 0) {
+			const std::uint64_t bit(i * header.lowBits);
+			const std::uint64_t bits(x & ((1ull << header.lowBits) - 1));
+			low[bit / 64] |= bits << (bit % 64);
+			if(bit % 64 + header.lowBits > 64) {
+				low[bit / 64 + 1] |= bits >> (64 - bit % 64);
+			}
+		}
+		const std::uint64_t position((x >> header.lowBits) + i);
+		high[position / 64] |= 1ull << (position % 64);
+		if(i % selectSample == 0) {
+			samples.push_back(position);
+		}
+	} // for
+	low.resize((pairs.size() * header.lowBits + 63) / 64);
+
+// log-probabilities as codes, exact for up to codeLevels distinct
+// ones and evenly spaced levels otherwise, as in Tri::quantize
+	std::vector<float> codebook;
+	for(auto p(pairs.cbegin()); p != pairs.cend(); ++p) {
+		codebook.push_back(p->second);
+	}
+	std::sort(codebook.begin(), codebook.end());
+	codebook.erase(std::unique(codebook.begin(), codebook.end()), codebook.end());
+	std::vector<std::uint16_t> codes;
+	codes.reserve(pairs.size());
+	if(codebook.size() <= codeLevels) {
+		for(auto p(pairs.cbegin()); p != pairs.cend(); ++p) {
+			codes.push_back(std::lower_bound(codebook.cbegin(), codebook.cend(), p->second) - codebook.cbegin());
+		}
+	} else {
+		const double lowest(codebook.front()), step((double(codebook.back()) - lowest) / (codeLevels - 1));
+		for(auto p(pairs.cbegin()); p != pairs.cend(); ++p) {
+			codes.push_back((std::uint16_t)std::llround((p->second - lowest) / step));
+		}
+		codebook.resize(codeLevels);
+		for(unsigned int c(0); c < codeLevels; ++c) {
+			codebook[c] = float(lowest + c * step);
+		}
+	}
+	header.codebookSize = codebook.size();
+
+	auto section = [&out](const void* data, const std::size_t bytes) {
+		static const char zeros[8] = {0};
+		out.write(static_cast<const char*>(data), bytes);
+		out.write(zeros, padded(bytes) - bytes);
+	};
+	section(&header, sizeof(header));
+	section(spellingOffsets.data(), 4 * spellingOffsets.size());
+	section(spellings.data(), spellings.size());
+	section(firstPair.data(), 4 * firstPair.size());
+	section(low.data(), 8 * low.size());
+	section(high.data(), 8 * high.size());
+	section(samples.data(), 8 * samples.size());
+	section(codes.data(), 2 * codes.size());
+	section(codebook.data(), 4 * codebook.size());
+} // build
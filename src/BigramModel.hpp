@@ -0,0 +1,145 @@
+/* BigramModel.hpp
+   Conditional probabilities of word pairs, in a compressed file that
+   is mapped into memory.
+*/
+
+#include <string>
+#include <vector>
+#include <istream>
+#include <ostream>
+#include <cstdint>
+
+#ifndef __BIGRAMMODEL_HPP__
+#define __BIGRAMMODEL_HPP__
+
+/*! Weight of the unigram probability of a word that never follows the
+ *  word before it in the bigram corpus ("stupid backoff"). */
+const double bigramBackoff = 0.4;
+/*! Log-probability that one edit operation costs when suggestions are
+ *  ranked in context; see SuggestOptions::editWeight . */
+const double defaultEditWeight = 5.0;
+
+/*! Log-probabilities of a word given the word before it.
+
+  A bigram corpus has one line per pair of words that follow each
+  other in some text, with the log of the probability of the second
+  word after the first:
+
+      PREVIOUS<TAB>NEXT<TAB>LOGPROB
+
+  script/bigrams.py writes such a corpus, and bin/buildbigrams turns it
+  into a model file with build . Words get ids in the byte order of
+  their spelling. A pair is the number previous * words + next, and
+  all pairs, sorted, are stored with Elias-Fano coding: the low bits
+  of every number are packed into an array, the high bits are written
+  in unary into a bit vector, and every 256th one bit of that vector
+  is sampled so that the pairs of a previous word are found without
+  scanning. That needs about 2 + log2(words * words / pairs) bits per
+  pair. Log-probabilities are 16 bit codes into a codebook, like the
+  values of Tri::quantize .
+
+  A model is read with mmap and never copied: the file is laid out
+  like the arrays in memory (in the byte order of the machine that
+  built it), so opening it only checks its sizes, and processes that
+  use the same model share its pages.
+  Scoring a list of candidates decodes the pairs of the previous word
+  once and looks every candidate id up in them; callers keep the ids
+  of their words in an array and never look up strings per candidate.
+*/
+class BigramModel {
+public:
+//! The id of words that are not in the model.
+	static const unsigned int unknownWord = ~0u;
+//! The score of pairs that are not in the model.
+	static const float absent;
+
+private:
+//! The start of a model file.
+	struct _Header {
+		char magic[8]; /*!< "dymbigr1". */
+		std::uint32_t words; /*!< Number of words. */
+		std::uint32_t pairs; /*!< Number of pairs. */
+		std::uint32_t lowBits; /*!< Low bits per pair. */
+		std::uint32_t codebookSize; /*!< Number of distinct
+					      log-probabilities. */
+		std::uint64_t highBits; /*!< Length of the high bit vector. */
+		std::uint64_t spellingBytes; /*!< Length of all spellings. */
+	};
+
+	void* _mapping; /*!< The mapped file. */
+	std::size_t _size; /*!< Length of the mapped file. */
+	std::uint32_t _words; /*!< Number of words. */
+	std::uint32_t _pairs; /*!< Number of pairs. */
+	unsigned int _lowBits; /*!< Low bits per pair. */
+	const std::uint32_t* _spellingOffsets; /*!< Start of the spelling
+						 of every word, and the
+						 end of the last one. */
+	const char* _spellings; /*!< Spellings of all words, in id order. */
+	const std::uint32_t* _firstPair; /*!< Index of the first pair of
+					   every previous word, and the
+					   number of pairs. */
+	const std::uint64_t* _low; /*!< Packed low bits of the pairs. */
+	const std::uint64_t* _high; /*!< Unary high bits of the pairs. */
+	const std::uint64_t* _samples; /*!< Position of every 256th one
+					 bit in _high. */
+	const std::uint16_t* _codes; /*!< Log-probability code of every
+				       pair. */
+	const float* _codebook; /*!< Log-probabilities of the codes. */
+
+/*! Position of a one bit in the high bit vector.
+  \param i The number of the one bit, counted from 0.
+  \return Its position in _high.
+*/
+	std::uint64_t _select(const std::uint32_t i) const;
+//! The low bits of a pair.
+	std::uint64_t _lowOf(const std::uint32_t i) const;
+
+public:
+	BigramModel() = delete;
+	BigramModel(const BigramModel&) = delete;
+/*! Maps a model file into memory; throws std::runtime_error if it
+ *  cannot be read or is not a model file.
+ \param filename A file written by build .
+*/
+	explicit BigramModel(const std::string& filename);
+	~BigramModel();
+
+/*! Looks a word up with binary search over the spellings.
+ \param word A word in UTF-8.
+ \return Its id, or unknownWord.
+*/
+	unsigned int id(const std::string& word) const;
+
+/*! Scores the candidates for the word after another word.
+ \param previous The id of the word before, or unknownWord.
+ \param candidates Ids of the candidates, in any order; unknownWord
+ is allowed.
+ \param count Number of candidates.
+ \param logProbs Set to the log-probability of each candidate after
+ previous, or to absent for pairs that are not in the model.
+*/
+	void score(const unsigned int previous, const unsigned int* candidates, const std::size_t count, float* logProbs) const;
+
+//! The number of words.
+	unsigned int getWords() const {
+		return _words;
+	}
+//! The number of pairs.
+	unsigned int getPairs() const {
+		return _pairs;
+	}
+//! The size of the model file in bytes.
+	std::size_t getBytes() const {
+		return _size;
+	}
+
+/*! Compiles a bigram corpus into a model file. Throws ParseError on
+ *  malformed lines and on pairs that are given twice.
+ \param in The bigram corpus.
+ \param name Name of the corpus, for error messages.
+ \param out The stream to write the model to; should be binary.
+*/
+	static void build(std::istream& in, const std::string& name, std::ostream& out);
+}; // BigramModel
+
+#endif
@@ -24,17 +24,18 @@
  * measured through a number of unit edit-operations that are necessary
  * to turn one string into another. The cutoff edit-distance threshold is
  * used to prune the search tree.
- * CorrectionSearcher accumulates strings that can be reached through
- * these edit operations as its results, which must be extracted with
- * getResults.
+ * CorrectionSearcher accumulates the end states of keys that can be
+ * reached through these edit operations as its results, which must be
+ * extracted with getResults.
  * 
  * Although the search is realized through a stack, CorrectionSearcher
  * does not maintain its own stack. This, as well as the iteration, has
  * to be provided by the user of CorrectionSearcher.
  * 
- * Results (\cword result_type ) is an unordered_map with the winning candidate
- * strings as keys and values as pairs of corresponding edit distance and
- * state number (for value extraction in the Tri). 
+ * Results (\cword result_type ) are SearchResults: the end states
+ * of the winning candidates with their edit distance (the state
+ * number is used for value extraction in the Tri). Items do not carry the candidate string, only its
+ * length; the Tri spells the keys of results from their states.
  * 
  * \todo This class is somewhat needlessly templated. I originally
  * introduced the state_T type parameter because the State type of Tri is
@@ -59,19 +60,37 @@
  */
 class CorrectionSearcher : public Searcher<CorrectionSearcher> {
 public:
+//! Bitwise flags to select which pre-filters prune the search.
+	/*! Both filters use annotations that the Tri keeps in its
+	  States (minDepth, maxDepth and letters). They never prune an
+	  item that could still lead to a result within the cutoff
+	  distance, so they only change how much work a search does,
+	  not what it finds.
+	*/
+	enum Pruning {
+		pruneNone = 0, /*!< Only prune on the cutoff distance. */
+		pruneLength = 1, /*!< Prune items whose remaining input
+				   is too long or too short for any key below
+				   their state. */
+		pruneLetters = 2, /*!< Prune items whose remaining input
+				    has more characters that do not occur below
+				    their state than the edit budget allows. */
+		pruneAll = 3 /*!< Use all pre-filters (default). */
+	};
+
 //! Data tuples that are put on the stack to perform the search.
 	/*! Items are used to incrementally compute edit distance
 	  between certain strings, rather than calculating the edit
 	  distance between two given strings monolithically over and
 	  over again.
-	  To do this, they carry a count of edit operations performed, a
-	  candidate string that is being incrementally concatenated in
-	  certain edit operations and a pointer into the original input
-	  string, representing roughly the amount of the string consumed
-	  and the next input character.
+	  To do this, they carry a count of edit operations performed, the
+	  length of the candidate string that the path to their state
+	  spells and a pointer into the original input string,
+	  representing roughly the amount of the string consumed and the
+	  next input character.
 	  Different edit operations are distinguished (almost) only by wether or
 	  not they advance the pointer into the input string (nextChar)
-	  or what they append to the candidate string.
+	  or how many characters they append to the candidate.
 	*/
 	template<typename state_T>
 	struct item {
@@ -85,76 +104,116 @@ public:
 		std::string::const_iterator nextChar; /*!< Iterator
 						       * pointing to the next char in the original input
 						       * string. */
-		std::string candidate; /*!< The correction candidate
-					* that has been built so far. */
+		const unsigned int depth; /*!< The length of the
+					    correction candidate that has
+					    been built so far. */
 
 //! Empty items make no sense.
 		item() = delete;
-		//! No copies allowed.
-		item(const item&) = delete;
 //! To construct an item, all its member fields must be fully provided
 //! with values. These are guaranteed not to be changed.
 		item(const state_T& newStateData, const unsigned int newState, const unsigned int newEditDistance,
-		     std::string::const_iterator newNextChar, std::string newCandidate)
-			: stateData(newStateData), state(newState), editDistance(newEditDistance), nextChar(newNextChar), candidate(newCandidate) {}
+		     std::string::const_iterator newNextChar, const unsigned int newDepth)
+			: stateData(newStateData), state(newState), editDistance(newEditDistance), nextChar(newNextChar), depth(newDepth) {}
 	};
+//! The search stack, see Searcher::stack .
+	template <typename state_T>
+	using itemStack = std::stack<item<state_T>, std::vector<item<state_T>>>;
 private:
-	const std::string _word; /*!< The original input string,
-				   possibly misspelled. items point
-				   into this with nextChar . */
-	const unsigned int _cutoffDistance; /*!< The maximum number of
-					      edit operations for any item to be legal. */
+	std::string _word; /*!< The original input string,
+			     possibly misspelled. items point
+			     into this with nextChar . */
+	unsigned int _cutoffDistance; /*!< The maximum number of
+					edit operations for any item to be legal. */
 	result_type _results; /* Successful corrections and their data
 			       * are stored here. */
+	const unsigned int _pruning; /*!< Pruning flags in use. */
+	unsigned int _prefixLength; /*!< Length of the input prefix
+				      whose edits are limited to
+				      _prefixBudget; 0 if unrestricted. */
+	unsigned int _prefixBudget; /*!< Maximum number of edit
+				      operations while consuming the
+				      restricted prefix. */
+	SearchStats _stats; /*!< Instrumentation counters. */
 
 private:
 	//! Creates item representing no-operation or successful
 	//! transition over input string.
 	template <typename state_T>
-	std::unique_ptr<item<state_T>> _noopItem(const unsigned char transChar, const state_T& newStateData, const unsigned int newState, const item<state_T>& top) const;
+	item<state_T> _noopItem(const unsigned char transChar, const state_T& newStateData, const unsigned int newState, const item<state_T>& top) const;
 
 //! Creates item representing the substitution of a character in the
 //! input string by another character.
 	template <typename state_T>
-	std::unique_ptr<item<state_T>> _substitutionItem(const unsigned char transChar, const state_T& newStateData, const unsigned int newState, const item<state_T>& top) const;
+	item<state_T> _substitutionItem(const unsigned char transChar, const state_T& newStateData, const unsigned int newState, const item<state_T>& top) const;
 
 //! Creates item representing the insertion of a new character at a
 //! position in the input string.
 	template <typename state_T>
-	std::unique_ptr<item<state_T>> _insertionItem(const unsigned char transChar, const state_T& newStateData, const unsigned int newState, const item<state_T>& top) const;
+	item<state_T> _insertionItem(const unsigned char transChar, const state_T& newStateData, const unsigned int newState, const item<state_T>& top) const;
 
 //! Creates item representing the deletion of a character at a
 //! position in the input string.
 	template <typename state_T>
-	std::unique_ptr<item<state_T>> _deletionItem(const state_T& newStateData, const unsigned int newState, const item<state_T>& top) const;
+	item<state_T> _deletionItem(const state_T& newStateData, const unsigned int newState, const item<state_T>& top) const;
 //! Creates item representing the swapping of two consecutive characters in the input string.
 	template <typename state_T>
-	std::unique_ptr<item<state_T>> _transpositionItem(const unsigned char thisWasPutLeft, const unsigned char thisWasPutRight, const state_T& newStateData, const unsigned int newState, const item<state_T>& top) const;
+	item<state_T> _transpositionItem(const unsigned char thisWasPutLeft, const unsigned char thisWasPutRight, const state_T& newStateData, const unsigned int newState, const item<state_T>& top) const;
+
+//! Checks the pre-filters for an item that is about to be created;
+//! counts pruned items.
+	template <typename state_T>
+	bool _viable(const state_T& newStateData, std::string::const_iterator newNextChar, const unsigned int newEditDistance);
+
+//! Pushes an item onto the stack and counts it.
+	template <typename state_T>
+	void _push(itemStack<state_T>& s, const item<state_T>& i);
 
 //! Pushes certain edit operation items for a given character
 //! transition in the current state on the stack.
 	template <typename state_T>
-	void _pushEditOperations(const unsigned char transChar, const unsigned int nextState, const item<state_T>& top, std::stack<std::unique_ptr<item<state_T>>>& s, const std::vector<std::unique_ptr<state_T>>& v) const;
+	void _pushEditOperations(const unsigned char transChar, const unsigned int nextState, const item<state_T>& top, itemStack<state_T>& s, const std::vector<state_T>& v);
 
 public:
 //! Can't correct nothing!
 	CorrectionSearcher() = delete;
 //! Makes no sense.
 	CorrectionSearcher(const CorrectionSearcher&) = delete;
-//! A CorrectionSearcher always requires a word to be corrected and a maximum edit distance to search.
-	CorrectionSearcher(const std::string w, const unsigned int cutoff) : _word(w), _cutoffDistance(cutoff), _results() {}
+//! A CorrectionSearcher always requires a word to be corrected and a
+//! maximum edit distance to search; the pre-filters can be chosen
+//! with Pruning flags.
+	CorrectionSearcher(const std::string w, const unsigned int cutoff, const unsigned int pruning = pruneAll) : _word(w), _cutoffDistance(cutoff), _results(), _pruning(pruning), _prefixLength(0), _prefixBudget(0), _stats() {}
+
+//! Restricts the number of edit operations allowed on a prefix of
+//! the input; used to split queries.
+	inline void restrictPrefix(const unsigned int length, const unsigned int budget);
+
+//! Starts over with another word and maximum edit distance, keeping
+//! the memory of the results for the next search.
+	inline void reset(const std::string& w, const unsigned int cutoff);
+
+//! Lowers the maximum edit distance while searching; items beyond it
+//! are no longer produced.
+	inline void lowerCutoff(const unsigned int cutoff);
+
+//! Copies an item of another CorrectionSearcher for the same word,
+//! so that this searcher can continue its search.
+	template <typename state_T>
+	item<state_T> adopt(const item<state_T>& i, const CorrectionSearcher& owner) const;
 
 //! Creates the initial item to seed a stack for further searching.
 	template <typename state_T>
-	std::unique_ptr<item<state_T>> initialItem(const unsigned int startState, const std::vector<std::unique_ptr<state_T>>& v) const;
+	item<state_T> initialItem(const unsigned int startState, const std::vector<state_T>& v) const;
 
 //! \brief Given a transition vector and a top item, destructively feeds the
 //! given stack with new search items based on the top item. Pushes
 //! multiple items but does not loop.
 	template <typename state_T>
-	void feedStack(std::stack<std::unique_ptr<item<state_T>>>& s, const std::vector<std::unique_ptr<state_T> >& v, const item<state_T>& top); 
-//! Extract possible correction strings found during search.
+	void feedStack(itemStack<state_T>& s, const std::vector<state_T>& v, const item<state_T>& top); 
+//! Extract the end states of the corrections found during search.
 	inline const result_type& getResults() const;
+//! Counters of the work done and pruned during search.
+	inline const SearchStats& getStats() const;
 };  // CorrectionSearcher
 
 
@@ -165,9 +224,11 @@ public:
 
 #define item CorrectionSearcher::item
 #define result_type CorrectionSearcher::result_type
+#define hit_type CorrectionSearcher::hit_type
 
 #include "CorrectionSearcher.tpp.hpp"
 
+#undef hit_type
 #undef result_type
 #undef item
 
@@ -2,7 +2,7 @@
 
 /*! For NoOp items, the current transChar (which is the character
  *  normally expected at the current position in the input string) is
- *  appended to the candidate string and the pointer into the input
+ *  appended to the candidate and the pointer into the input
  *  string is advanced by one.
  This is the only item that does not increase the edit operation count.
  \param transChar A character for which there is a guaranteed
@@ -14,18 +14,12 @@
  of the input string. 
 */
 template <typename state_T>
-std::unique_ptr<item<state_T>> CorrectionSearcher::_noopItem(const unsigned char transChar, const state_T& newStateData, const unsigned int newState, const item<state_T>& top) const {
-	std::string newCandidate(top.candidate);
-	newCandidate.push_back(transChar);
-
-	// unique_ptr is created as rvalue, so this invokes the move
-	// constructor rather than copy ctor(which is illegal)
-	return std::unique_ptr<item<state_T>>(
-		new item<state_T>(newStateData,
-				  newState,
-				  top.editDistance,
-				  std::next(top.nextChar),
-				  newCandidate));
+item<state_T> CorrectionSearcher::_noopItem(const unsigned char transChar, const state_T& newStateData, const unsigned int newState, const item<state_T>& top) const {
+	return item<state_T>(newStateData,
+			     newState,
+			     top.editDistance,
+			     std::next(top.nextChar),
+			     top.depth + 1);
 }
 
 /*! For substitution items, the substitutor character transChar is
@@ -42,15 +36,12 @@ std::unique_ptr<item<state_T>> CorrectionSearcher::_noopItem(const unsigned char
  current position in the input string held in the current item.
 */
 template <typename state_T>
-std::unique_ptr<item<state_T>> CorrectionSearcher::_substitutionItem(const unsigned char transChar, const state_T& newStateData, const unsigned int newState, const item<state_T>& top) const {
-	std::string newCandidate(top.candidate);
-	newCandidate.push_back(transChar);
-	return std::unique_ptr<item<state_T>>(
-		new item<state_T>(newStateData,
-				  newState,
-				  top.editDistance + 1,
-				  std::next(top.nextChar),
-				  newCandidate));
+item<state_T> CorrectionSearcher::_substitutionItem(const unsigned char transChar, const state_T& newStateData, const unsigned int newState, const item<state_T>& top) const {
+	return item<state_T>(newStateData,
+			     newState,
+			     top.editDistance + 1,
+			     std::next(top.nextChar),
+			     top.depth + 1);
 }
 
 /*! For insertion items, transChar is appended to the current
@@ -65,15 +56,12 @@ std::unique_ptr<item<state_T>> CorrectionSearcher::_substitutionItem(const unsig
  string at the position held in the item.
 */
 template <typename state_T>
-std::unique_ptr<item<state_T>> CorrectionSearcher::_insertionItem(const unsigned char transChar, const state_T& newStateData, const unsigned int newState, const item<state_T>& top) const {
-	std::string newCandidate(top.candidate);
-	newCandidate.push_back(transChar);
-	return std::unique_ptr<item<state_T>>(
-		new item<state_T>(newStateData,
-				  newState,
-				  top.editDistance + 1,
-				  top.nextChar,
-				  newCandidate));
+item<state_T> CorrectionSearcher::_insertionItem(const unsigned char transChar, const state_T& newStateData, const unsigned int newState, const item<state_T>& top) const {
+	return item<state_T>(newStateData,
+			     newState,
+			     top.editDistance + 1,
+			     top.nextChar,
+			     top.depth + 1);
 }
 
 /*! For a deletion item, nothing is appended to the candidate string,
@@ -86,13 +74,12 @@ std::unique_ptr<item<state_T>> CorrectionSearcher::_insertionItem(const unsigned
   \return An item representing the deletion of one character.
 */
 template <typename state_T>
-std::unique_ptr<item<state_T>> CorrectionSearcher::_deletionItem(const state_T& newStateData, const unsigned int newState, const item<state_T>& top) const {
-	return std::unique_ptr<item<state_T>>(
-		new item<state_T>(newStateData,
-				  newState,
-				  top.editDistance + 1,
-				  std::next(top.nextChar),
-				  top.candidate));
+item<state_T> CorrectionSearcher::_deletionItem(const state_T& newStateData, const unsigned int newState, const item<state_T>& top) const {
+	return item<state_T>(newStateData,
+			     newState,
+			     top.editDistance + 1,
+			     std::next(top.nextChar),
+			     top.depth);
 }
 
 
@@ -112,18 +99,59 @@ std::unique_ptr<item<state_T>> CorrectionSearcher::_deletionItem(const state_T&
  \return A new item representing the successful transposition.
 */
 template <typename state_T>
-std::unique_ptr<item<state_T>> CorrectionSearcher::_transpositionItem(const unsigned char thisWasPutLeft, const unsigned char thisWasPutRight, const state_T& newStateData, const unsigned int newState, const item<state_T>& top) const {
-	std::string newCandidate(top.candidate);
-	newCandidate.push_back(thisWasPutLeft);
-	newCandidate.push_back(thisWasPutRight);
-
-	return std::unique_ptr<item<state_T>>(
-		new item<state_T>(newStateData,
-				  newState,
-				  top.editDistance + 1,
-				  std::next(std::next(top.nextChar)),
-				  newCandidate));
+item<state_T> CorrectionSearcher::_transpositionItem(const unsigned char thisWasPutLeft, const unsigned char thisWasPutRight, const state_T& newStateData, const unsigned int newState, const item<state_T>& top) const {
+	return item<state_T>(newStateData,
+			     newState,
+			     top.editDistance + 1,
+			     std::next(std::next(top.nextChar)),
+			     top.depth + 2);
 }
+/*! The length filter uses that every edit operation changes the
+ *  length difference between the rest of the input and the rest of a
+ *  candidate by at most one. The letter filter uses that every
+ *  remaining input character that does not occur below the new state
+ *  has to be deleted or substituted, at the cost of one edit each.
+ \param newStateData The state the new item would be in.
+ \param newNextChar The input position the new item would be at.
+ \param newEditDistance The edit distance of the new item.
+ \return False if the item cannot lead to a result within the cutoff
+ distance.
+*/
+template <typename state_T>
+bool CorrectionSearcher::_viable(const state_T& newStateData, std::string::const_iterator newNextChar, const unsigned int newEditDistance) {
+	if(newEditDistance > _cutoffDistance) {
+		return false;
+	}
+	if(newEditDistance > _prefixBudget && (unsigned int)(newNextChar - _word.cbegin()) < _prefixLength) {
+		++_stats.prunedPrefix;
+		return false;
+	}
+	const unsigned int budget(_cutoffDistance - newEditDistance);
+	const unsigned int remaining(_word.cend() - newNextChar);
+	if(_pruning & pruneLength) {
+		if(remaining > newStateData.maxDepth + budget || newStateData.minDepth > remaining + budget) {
+			++_stats.prunedLength;
+			return false;
+		}
+	}
+	if(_pruning & pruneLetters) {
+		unsigned int missing(0);
+		for(auto c(newNextChar); c != _word.cend(); ++c) {
+			if(!(newStateData.letters & letterBit(*c)) && ++missing > budget) {
+				++_stats.prunedLetters;
+				return false;
+			}
+		}
+	}
+	return true;
+} // _viable
+
+template <typename state_T>
+void CorrectionSearcher::_push(itemStack<state_T>& s, const item<state_T>& i) {
+	++_stats.itemsPushed;
+	s.push(i);
+} // _push
+
 /*! If conditions are met, pushes items for transposition, insertion
  *  and substitution onto the stack. These items are created only for
  *  one character that is guaranteed to be a transition of the current state.
@@ -136,14 +164,17 @@ std::unique_ptr<item<state_T>> CorrectionSearcher::_transpositionItem(const unsi
  \param v A vector containing state data.
 */
 template <typename state_T>
-void CorrectionSearcher::_pushEditOperations(const unsigned char transChar, const unsigned int nextState, const item<state_T>& top, std::stack<std::unique_ptr<item<state_T>>>& s, const std::vector<std::unique_ptr<state_T>>& v) const {
+void CorrectionSearcher::_pushEditOperations(const unsigned char transChar, const unsigned int nextState, const item<state_T>& top, itemStack<state_T>& s, const std::vector<state_T>& v) {
 // transposition
 	// A transposition item is only pushed if there are
 	// transitions for the resulting swapped characters. To check
 	// this, we look ahead one char.
-	auto putMeLeft(top.nextChar + 1); // putMeLeft is the char
+	// At the end of the input there is nothing left to transpose
+	// or substitute; only insertions are possible.
+	const bool atEnd(top.nextChar == _word.cend());
+	auto putMeLeft(atEnd ? top.nextChar : top.nextChar + 1); // putMeLeft is the char
 					  // that was formerly on the right
-	if(putMeLeft != _word.cend() && *putMeLeft == transChar) {
+	if(!atEnd && putMeLeft != _word.cend() && *putMeLeft == transChar) {
 		// we have enough chars ahead to actually transpose
 		// and there is a transition for the formerly right one
 
@@ -151,16 +182,22 @@ void CorrectionSearcher::_pushEditOperations(const unsigned char transChar, cons
 // putMeRight is on the left before the transposition
 		const unsigned char putMeRight(*top.nextChar);  
 // pretend we transpose and look ahead for the resulting state
-		auto stateAfterPutMeRight(v[nextState]->transitions.find(putMeRight));
-		if(stateAfterPutMeRight != v[nextState]->transitions.cend()) {
+		auto stateAfterPutMeRight(v[nextState].transitions.find(putMeRight));
+		if(stateAfterPutMeRight != v[nextState].transitions.cend()
+		   && _viable(v[stateAfterPutMeRight->second], top.nextChar + 2, top.editDistance + 1)) {
 			// a transition exists; push the item
-			s.push(std::move(_transpositionItem(*putMeLeft, putMeRight, *(v[stateAfterPutMeRight->second]), stateAfterPutMeRight->second, top)));
+			_push(s, _transpositionItem(*putMeLeft, putMeRight, v[stateAfterPutMeRight->second], stateAfterPutMeRight->second, top));
 		}
 	}
 
 // push other items
-	s.push(std::move(_substitutionItem(transChar, *(v[nextState]), nextState, top)));
-	s.push(std::move(_insertionItem(transChar, *(v[nextState]), nextState, top)));
+	const state_T& nextStateData(v[nextState]);
+	if(!atEnd && _viable(nextStateData, top.nextChar + 1, top.editDistance + 1)) {
+		_push(s, _substitutionItem(transChar, nextStateData, nextState, top));
+	}
+	if(_viable(nextStateData, top.nextChar, top.editDistance + 1)) {
+		_push(s, _insertionItem(transChar, nextStateData, nextState, top));
+	}
 }
 
 
@@ -172,16 +209,31 @@ void CorrectionSearcher::_pushEditOperations(const unsigned char transChar, cons
  *  string as candidate for the correction. 
  \param startState The name(as number) of the initial state.
  \param v A vector of states, indices corresponding to names of states.
- \return A unique_ptr to an item, that can be used to seed a stack for searching. 
+ \return An item that can be used to seed a stack for searching.
 */
 template <typename state_T>
-std::unique_ptr<item<state_T>> CorrectionSearcher::initialItem(const unsigned int startState, const std::vector<std::unique_ptr<state_T>>& v) const {
-	return std::unique_ptr<item<state_T>>(
-		new item<state_T>(*(v[startState]),
-				  startState,
-				  0,
-				  _word.cbegin(),
-				  ""));
+item<state_T> CorrectionSearcher::initialItem(const unsigned int startState, const std::vector<state_T>& v) const {
+	return item<state_T>(v[startState],
+			     startState,
+			     0,
+			     _word.cbegin(),
+			     0);
+}
+
+/*! Items point into the input word of the searcher that created
+ *  them, so their position is translated to this searcher's copy of
+ *  the word. Both searchers must search for the same word.
+ \param i An item created by owner.
+ \param owner The searcher that created i.
+ \return A copy of i for this searcher.
+*/
+template <typename state_T>
+item<state_T> CorrectionSearcher::adopt(const item<state_T>& i, const CorrectionSearcher& owner) const {
+	return item<state_T>(i.stateData,
+			     i.state,
+			     i.editDistance,
+			     _word.cbegin() + (i.nextChar - owner._word.cbegin()),
+			     i.depth);
 }
 
 /*!
@@ -199,8 +251,7 @@ std::unique_ptr<item<state_T>> CorrectionSearcher::initialItem(const unsigned in
   This function would be much neater if it returned a list/vector of
   produced items instead of mutating the stack state. However, this would create need for additional
   boxing/unboxing, which seems wasteful :(
-  \param s A stack of unique_ptrs to items; this will be updated
-  destructively.
+  \param s A stack of items; this will be updated destructively.
   \param v A vector that provides a mapping from state numbers to state
   data.
   \param top The item that will be examined; supposed to be the already
@@ -208,16 +259,21 @@ std::unique_ptr<item<state_T>> CorrectionSearcher::initialItem(const unsigned in
   \sa _pushEditOperations
 */
 template <typename state_T>
-void CorrectionSearcher::feedStack(std::stack<std::unique_ptr<item<state_T>>>& s, const std::vector<std::unique_ptr<state_T> >& v, const item<state_T>& top) {
+void CorrectionSearcher::feedStack(itemStack<state_T>& s, const std::vector<state_T>& v, const item<state_T>& top) {
+	++_stats.itemsExpanded;
 // Successful candidate?
 	if(top.nextChar == _word.cend() && top.stateData.endState) {
 		// item represents end state and we have reached end
 		// of input string
-		auto i(_results.find(top.candidate));
-		if(i == _results.cend() || i->second.second > top.editDistance) {
+		hit_type* found(_results.find(top.state));
+		if(!found) {
+			const hit_type hit = {top.state, top.editDistance, double(top.editDistance)};
+			_results.insert(hit);
+		} else if(found->editDistance > top.editDistance) {
 			// if the same candidate was already found, we
 			// only replace it if we have better edit distance
-			_results.insert(std::make_pair(top.candidate, std::make_pair(top.state, top.editDistance)));
+			found->editDistance = top.editDistance;
+			found->cost = top.editDistance;
 		}
 	} // if success
 
@@ -225,11 +281,12 @@ void CorrectionSearcher::feedStack(std::stack<std::unique_ptr<item<state_T>>>& s
 	if(top.nextChar != _word.cend()) {
 		// we are not at the end of input
 		auto foundState(top.stateData.transitions.find(*top.nextChar));
-		if(foundState != top.stateData.transitions.end()) {
-			s.push(std::move(_noopItem(*top.nextChar,
-						   *(v[foundState->second]),
-						   foundState->second,
-						   top)));
+		if(foundState != top.stateData.transitions.end()
+		   && _viable(v[foundState->second], top.nextChar + 1, top.editDistance)) {
+			_push(s, _noopItem(*top.nextChar,
+					   v[foundState->second],
+					   foundState->second,
+					   top));
 		} // if foundState
 	} // if _word.cend()
 
@@ -239,9 +296,11 @@ void CorrectionSearcher::feedStack(std::stack<std::unique_ptr<item<state_T>>>& s
 		if(top.nextChar != _word.cend()) { // not at end of input
 // we can only delete what is in the input string, so this happens
 // outside of the loop below
-			s.push(std::move(_deletionItem(top.stateData,
+			if(_viable(top.stateData, top.nextChar + 1, top.editDistance + 1)) {
+				_push(s, _deletionItem(top.stateData,
 						       top.state,
-						       top)));
+						       top));
+			}
 		} // nextChar != cend
 // for all transitions in this state
 		for(auto t(top.stateData.transitions.cbegin()); t != top.stateData.transitions.cend(); ++t) {
@@ -256,7 +315,49 @@ void CorrectionSearcher::feedStack(std::stack<std::unique_ptr<item<state_T>>>& s
 	}  // if editDistance
 } // feedStack
 
+/*! After a call to this, the search only keeps items that have not
+ *  yet consumed the first \cword length characters of the input if
+ *  they used at most \cword budget edit operations. Operations that
+ *  consume the last character of the prefix, and insertions right
+ *  after it, are not counted towards the prefix. The cutoff distance
+ *  still applies to the whole input.
+ \param length The length of the restricted prefix of the input.
+ \param budget The edit operations allowed on the prefix.
+ \sa SplitSearch.hpp
+*/
+void CorrectionSearcher::restrictPrefix(const unsigned int length, const unsigned int budget) {
+	_prefixLength = length;
+	_prefixBudget = budget;
+} // restrictPrefix
+
+/*! The pruning flags stay as they are; a restricted prefix is lifted.
+ \param w The word to be corrected.
+ \param cutoff The maximum edit distance.
+*/
+void CorrectionSearcher::reset(const std::string& w, const unsigned int cutoff) {
+	_word.assign(w);
+	_cutoffDistance = cutoff;
+	_results.clear();
+	_prefixLength = 0;
+	_prefixBudget = 0;
+	_stats = SearchStats();
+} // reset
+
+/*! Items that are already on a stack are still expanded, but only
+ *  with the operations that stay within the new cutoff; used once a
+ *  search knows that keys further away cannot rank among its results.
+ \param cutoff The maximum edit distance; a greater one than the
+ current one is ignored.
+*/
+void CorrectionSearcher::lowerCutoff(const unsigned int cutoff) {
+	_cutoffDistance = std::min(_cutoffDistance, cutoff);
+} // lowerCutoff
+
 const result_type& CorrectionSearcher::getResults() const {
 	return _results;
 }
 
+
+const SearchStats& CorrectionSearcher::getStats() const {
+	return _stats;
+}
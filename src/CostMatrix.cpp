@@ -0,0 +1,136 @@
+
+#include "CostMatrix.hpp"
+#include "CorpusParser.hpp"
+#include "Utf8.hpp"
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <limits>
+
+CostMatrix::CostMatrix()
+	: _entries(), _defaultSub(1.0f), _defaultIns(1.0f), _defaultDel(1.0f), _defaultTrans(1.0f),
+	  _sub(256 * 256), _trans(256 * 256), _ins(256), _del(256),
+	  _minSub(1.0f), _minIns(1.0f), _minDel(1.0f), _minTrans(1.0f) {
+	_build(nullptr);
+} // CostMatrix ctor
+
+CostMatrix::CostMatrix(const std::string& filename) : CostMatrix() {
+	std::ifstream in(filename);
+	if(!in.is_open()) {
+		throw std::runtime_error("error in CostMatrix: File '" + filename + "' could not be opened.");
+	}
+	*this = CostMatrix(in, filename);
+} // CostMatrix ctor
+
+/*! Reads one character field of a cost line.
+ \param field The field.
+ \param c Set to the code point of the field.
+ \return False unless the field is exactly one code point in UTF-8.
+*/
+static bool parseCharacter(const std::string& field, char32_t& c) {
+	std::u32string codePoints;
+	if(!Utf8::normalize(field, codePoints, false) || codePoints.size() != 1) {
+		return false;
+	}
+	c = codePoints[0];
+	return true;
+} // parseCharacter
+
+/*! Explicit costs and defaults are collected first and combined at
+ *  the end, so default lines may appear anywhere in the file.
+ \param in The stream to read cost lines from.
+ \param name Name of the stream, for error messages.
+*/
+CostMatrix::CostMatrix(std::istream& in, const std::string& name) : CostMatrix() {
+	unsigned int lineNumber(0);
+	for(std::string line; std::getline(in, line);) {
+		++lineNumber;
+		if(line.empty() || line[0] == '#') continue;
+		std::istringstream fields(line);
+		std::string op, a, b;
+		float cost(0.0f);
+		fields >> op;
+		if(op.empty()) continue;
+		bool ok(false);
+		_Entry entry = {0, 0, 0, 0.0f};
+		if(op == "default") {
+			ok = bool(fields >> a >> cost);
+			if(a == "sub") _defaultSub = cost;
+			else if(a == "ins") _defaultIns = cost;
+			else if(a == "del") _defaultDel = cost;
+			else if(a == "trans") _defaultTrans = cost;
+			else ok = false;
+		} else if(op == "sub" || op == "trans") {
+			ok = bool(fields >> a >> b >> cost) && parseCharacter(a, entry.first) && parseCharacter(b, entry.second);
+			entry.op = op[0] == 's' ? 's' : 't';
+		} else if(op == "ins" || op == "del") {
+			ok = bool(fields >> a >> cost) && parseCharacter(a, entry.first);
+			entry.op = op[0];
+		}
+		std::string rest;
+		if(!ok || cost < 0.0f || (fields >> rest)) {
+			std::ostringstream message;
+			message << name << ", line:" << lineNumber << std::endl
+				<< "Malformed cost '" << line << "'.";
+			throw ParseError(message.str());
+		}
+		if(entry.op) {
+			entry.cost = cost;
+			_entries.push_back(entry);
+		}
+	} // for
+	_build(nullptr);
+} // CostMatrix ctor
+
+/*! Characters that are not in the alphabet cannot occur in a key, so
+ *  their costs are dropped; queries map them to Alphabet::unknown ,
+ *  which gets the default costs.
+ \param alphabet The alphabet of the Tri that will be searched.
+ \return A matrix indexed by symbols.
+*/
+CostMatrix CostMatrix::forAlphabet(const Alphabet& alphabet) const {
+	CostMatrix remapped(*this);
+	remapped._build(&alphabet);
+	return remapped;
+} // forAlphabet
+
+void CostMatrix::_build(const Alphabet* alphabet) {
+	std::fill(_sub.begin(), _sub.end(), _defaultSub);
+	std::fill(_trans.begin(), _trans.end(), _defaultTrans);
+	std::fill(_ins.begin(), _ins.end(), _defaultIns);
+	std::fill(_del.begin(), _del.end(), _defaultDel);
+	for(unsigned int c(0); c < 256; ++c) {
+		_sub[(c << 8) | c] = 0.0f;
+	}
+// maps a character to its index, or to 256 if it has none
+	auto index = [alphabet](char32_t c) -> unsigned int {
+		if(!alphabet) {
+			return c < 256 ? c : 256;
+		}
+		const unsigned char s(alphabet->symbol(alphabet->foldsCase() ? Utf8::foldCase(c) : c));
+		return s == Alphabet::unknown ? 256 : s;
+	};
+	for(auto e(_entries.cbegin()); e != _entries.cend(); ++e) {
+		const unsigned int a(index(e->first));
+		if(a > 255) continue;
+		if(e->op == 'i') {
+			_ins[a] = e->cost;
+		} else if(e->op == 'd') {
+			_del[a] = e->cost;
+		} else {
+			const unsigned int b(index(e->second));
+			if(b > 255 || (e->op == 's' && a == b)) continue;
+			(e->op == 's' ? _sub : _trans)[(a << 8) | b] = e->cost;
+		}
+	} // for
+
+	_minSub = _minTrans = _minIns = _minDel = std::numeric_limits<float>::max();
+	for(unsigned int i(0); i < 256 * 256; ++i) {
+		if((i >> 8) != (i & 255)) _minSub = std::min(_minSub, _sub[i]);
+		_minTrans = std::min(_minTrans, _trans[i]);
+	}
+	for(unsigned int c(0); c < 256; ++c) {
+		_minIns = std::min(_minIns, _ins[c]);
+		_minDel = std::min(_minDel, _del[c]);
+	}
+} // _build
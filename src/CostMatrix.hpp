@@ -0,0 +1,122 @@
+/* CostMatrix.hpp
+   Costs of edit operations per character.
+*/
+
+#include <string>
+#include <vector>
+#include <istream>
+#include "Alphabet.hpp"
+
+#ifndef __COSTMATRIX_HPP__
+#define __COSTMATRIX_HPP__
+
+/*! Costs of the edit operations of an error-tolerant search, per
+ *  character or pair of characters.
+
+  A plain search charges one edit for every substitution, insertion,
+  deletion and transposition. A CostMatrix can make likely typing
+  errors cheaper (e.g. substituting a key by its neighbour on the
+  keyboard) and unlikely ones more expensive. Costs are non-negative
+  floating point numbers; every operation has a default cost that
+  applies to characters that are not listed explicitly.
+  The operations are named from the point of view of the input word:
+  a substitution replaces a typed character by the intended one, an
+  insertion inserts a character the writer left out, a deletion
+  removes a character the writer typed by mistake and a transposition
+  swaps two adjacent typed characters.
+
+  Cost files are read line by line; empty lines and lines starting
+  with '#' are ignored. Other lines have one of the forms
+
+      default OP COST       (OP is sub, ins, del or trans)
+      sub TYPED INTENDED COST
+      ins CHAR COST
+      del CHAR COST
+      trans FIRST SECOND COST   (the input has FIRST SECOND, the word SECOND FIRST)
+
+  with fields separated by whitespace; characters are single code
+  points in UTF-8. Default lines only apply to characters that are not
+  given explicitly, wherever they appear in the file. Lookups are
+  array reads, indexed by the code point for code points below 256.
+  Tris of a Suggest store symbols of an Alphabet instead of code
+  points; forAlphabet creates a matrix indexed by those symbols.
+  \sa WeightedCorrectionSearcher
+*/
+class CostMatrix {
+private:
+//! A cost given explicitly in a cost file.
+	struct _Entry {
+		char op; /*!< 's', 'i', 'd' or 't'. */
+		char32_t first; /*!< The (typed) character. */
+		char32_t second; /*!< The intended or second character
+				   of substitutions and transpositions. */
+		float cost; /*!< The cost of the operation. */
+	};
+	std::vector<_Entry> _entries; /*!< Explicit costs, in the order
+					of the file. */
+	float _defaultSub; /*!< Cost of unlisted substitutions. */
+	float _defaultIns; /*!< Cost of unlisted insertions. */
+	float _defaultDel; /*!< Cost of unlisted deletions. */
+	float _defaultTrans; /*!< Cost of unlisted transpositions. */
+	std::vector<float> _sub; /*!< 256x256 substitution costs,
+				   indexed [typed][intended]. */
+	std::vector<float> _trans; /*!< 256x256 transposition costs,
+				     indexed [first][second]. */
+	std::vector<float> _ins; /*!< Insertion costs by character. */
+	std::vector<float> _del; /*!< Deletion costs by character. */
+	float _minSub; /*!< Lowest substitution cost of two different
+			 characters. */
+	float _minIns; /*!< Lowest insertion cost. */
+	float _minDel; /*!< Lowest deletion cost. */
+	float _minTrans; /*!< Lowest transposition cost. */
+
+//! Fills the tables from defaults and entries, mapping characters
+//! to symbols of an alphabet, or to code points if it is null.
+	void _build(const Alphabet* alphabet);
+
+public:
+//! Creates a matrix with unit costs for all operations.
+	CostMatrix();
+/*! Reads a cost file; throws ParseError on malformed lines and
+ *  std::runtime_error if the file cannot be opened. */
+	explicit CostMatrix(const std::string& filename);
+//! Reads costs from a stream; name is used in error messages.
+	CostMatrix(std::istream& in, const std::string& name);
+//! The same costs, indexed by the symbols of an alphabet.
+	CostMatrix forAlphabet(const Alphabet& alphabet) const;
+
+//! Cost of replacing the typed character by the intended one; 0 if equal.
+	float substitution(const unsigned char typed, const unsigned char intended) const {
+		return _sub[(typed << 8) | intended];
+	}
+//! Cost of inserting a character that was left out.
+	float insertion(const unsigned char c) const {
+		return _ins[c];
+	}
+//! Cost of deleting a character that was typed by mistake.
+	float deletion(const unsigned char c) const {
+		return _del[c];
+	}
+//! Cost of swapping the typed characters first and second.
+	float transposition(const unsigned char first, const unsigned char second) const {
+		return _trans[(first << 8) | second];
+	}
+//! Lowest cost of substituting a character by a different one.
+	float minSubstitution() const {
+		return _minSub;
+	}
+//! Lowest cost of any insertion.
+	float minInsertion() const {
+		return _minIns;
+	}
+//! Lowest cost of any deletion.
+	float minDeletion() const {
+		return _minDel;
+	}
+//! Lowest cost of any transposition.
+	float minTransposition() const {
+		return _minTrans;
+	}
+}; // CostMatrix
+
+#endif
@@ -0,0 +1,219 @@
+/* Dictionaries.hpp
+   Several named Suggest instances in one process.
+*/
+
+#include "Suggest.hpp"
+#include <map>
+#include <memory>
+#include <queue>
+#include <unordered_set>
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+#ifndef __DICTIONARIES_HPP__
+#define __DICTIONARIES_HPP__
+
+/*! A set of named dictionaries that share one process.
+
+  Every dictionary is a Suggest instance that is read in once and then
+  only used through its const interface, so it can be shared between
+  names and between threads. Naming the same corpus file twice loads
+  it only once.
+  Requests select a dictionary by name, or several dictionaries joined
+  by '+' for a merged lookup. A merged lookup searches every selected
+  Tri and merges the ranked results of all of them, like the merge
+  step of a merge sort over k inputs, instead of concatenating and
+  sorting them again. Words that are found in more than one
+  dictionary are only returned once, with their best ranking.
+
+  All dictionaries use the same corpus parser type; a file named twice
+  keeps the options it was first loaded with.
+  \sa Suggest
+*/
+template <typename parser_T>
+class Dictionaries {
+public:
+//! The type of the dictionaries.
+	typedef Suggest<parser_T> suggest_type;
+//! The type of ranked search results.
+	typedef typename suggest_type::result_type result_type;
+//! A list of dictionaries to search, as returned by select.
+	typedef std::vector<const suggest_type*> selection_type;
+
+private:
+	std::map<std::string, std::shared_ptr<const suggest_type>> _byName; /*!< Dictionaries by their name. */
+	std::map<std::string, std::shared_ptr<const suggest_type>> _byFile; /*!< Dictionaries by their corpus
+									     filename, to load every file only once. */
+	std::string _defaultName; /*!< Name of the dictionary used when a
+				    request does not select one; the first
+				    one loaded. */
+
+//! An entry of the merge heap: the next unmerged result of one input.
+	struct _head {
+		std::size_t input; /*!< Index of the input vector. */
+		std::size_t position; /*!< Index of the result in the input. */
+	};
+
+public:
+	Dictionaries() : _byName(), _byFile(), _defaultName() {}
+	Dictionaries(const Dictionaries&) = delete;
+
+/*! Loads a corpus file under a name. The first dictionary loaded
+  becomes the default dictionary.
+
+  Throws if the name is already in use, and on any error that the
+  Suggest constructor throws on.
+  \param name The name requests use to select the dictionary.
+  \param filename The corpus file.
+  \param options Maximum edit distance, search algorithm and threads.
+*/
+	void load(const std::string& name, const std::string& filename, const SuggestOptions& options) {
+		if(name.empty() || name.find_first_of("+\t") != std::string::npos) {
+			throw std::runtime_error("Invalid dictionary name '" + name + "'.");
+		}
+		if(_byName.count(name)) {
+			throw std::runtime_error("Dictionary '" + name + "' is given twice.");
+		}
+		auto f(_byFile.find(filename));
+		if(f == _byFile.end()) {
+			f = _byFile.insert(std::make_pair(filename, std::make_shared<const suggest_type>(filename, options))).first;
+		}
+		_byName.insert(std::make_pair(name, f->second));
+		if(_defaultName.empty()) {
+			_defaultName = name;
+		}
+	} // load
+
+/*! Looks up the dictionaries of a request.
+
+  Throws std::runtime_error if a name is unknown.
+  \param names A dictionary name, several names joined by '+', or the
+  empty string for the default dictionary.
+  \return The selected dictionaries, in the order given.
+*/
+	selection_type select(const std::string& names) const {
+		selection_type selection;
+		if(names.empty()) {
+			selection.push_back(&get(_defaultName));
+			return selection;
+		}
+		for(std::size_t start(0); start <= names.size();) {
+			std::size_t end(names.find('+', start));
+			if(end == std::string::npos) end = names.size();
+			selection.push_back(&get(names.substr(start, end - start)));
+			start = end + 1;
+		}
+		return selection;
+	} // select
+
+/*! Gives a dictionary by its name; throws std::runtime_error if there
+ *  is none. */
+	const suggest_type& get(const std::string& name) const {
+		auto i(_byName.find(name));
+		if(i == _byName.end()) {
+			throw std::runtime_error("Unknown dictionary '" + name + "'.");
+		}
+		return *(i->second);
+	} // get
+
+/*! Finds all correction suggestions in the selected dictionaries.
+  \param selection Dictionaries to search, as returned by select.
+  \param w A word, possibly misspelled.
+  \param budget Limits of the searches, shared by all dictionaries,
+  or null.
+  \param wanted The number of best suggestions needed, or 0 for all;
+  the best wanted of every dictionary are enough to merge them.
+  \return The search results of all dictionaries, best ones first;
+  at least the wanted best ones, maybe more.
+  \sa Suggest::ranked Suggest::top
+*/
+	std::vector<result_type> ranked(const selection_type& selection, const std::string& w, SearchBudget* budget = nullptr, const unsigned int wanted = 0) const {
+		if(selection.size() == 1) {
+			return selection.front()->top(w, wanted, budget);
+		}
+		std::vector<std::vector<result_type>> inputs;
+		inputs.reserve(selection.size());
+		for(auto d(selection.cbegin()); d != selection.cend(); ++d) {
+			inputs.push_back((*d)->top(w, wanted, budget));
+		}
+		return merge(inputs);
+	} // ranked
+
+/*! Completes a prefix in the selected dictionaries.
+  \param selection Dictionaries to search, as returned by select.
+  \param prefix The beginning of a word, possibly misspelled.
+  \param k The number of completions.
+  \param maxEdits The number of edit operations for the prefix.
+  \return The best k completions of all dictionaries, best ones first.
+  \sa Suggest::complete
+*/
+	std::vector<result_type> complete(const selection_type& selection, const std::string& prefix, const unsigned int k, const unsigned int maxEdits) const {
+		if(selection.size() == 1) {
+			return selection.front()->complete(prefix, k, maxEdits);
+		}
+		std::vector<std::vector<result_type>> inputs;
+		inputs.reserve(selection.size());
+		for(auto d(selection.cbegin()); d != selection.cend(); ++d) {
+			inputs.push_back((*d)->complete(prefix, k, maxEdits));
+		}
+		auto merged(merge(inputs));
+		if(merged.size() > k) {
+			merged.erase(merged.begin() + k, merged.end());
+		}
+		return merged;
+	} // complete
+
+/*! Merges ranked result vectors into one ranked vector.
+
+  The inputs must each be sorted best first, like the output of
+  Suggest::ranked . A heap holds the best unmerged result of every
+  input, so merging n results from k inputs takes O(n log(k))
+  comparisons. Of results for the same word, only the first (best)
+  one is kept.
+  \param inputs Ranked result vectors; their results are moved from.
+  \return One ranked vector of results.
+*/
+	static std::vector<result_type> merge(std::vector<std::vector<result_type>>& inputs) {
+		auto worse = [&inputs](const _head& a, const _head& b) {
+			return suggest_type::isBetter(inputs[b.input][b.position], inputs[a.input][a.position]);
+		};
+		std::priority_queue<_head, std::vector<_head>, decltype(worse)> heap(worse);
+		std::size_t total(0);
+		for(std::size_t i(0); i < inputs.size(); ++i) {
+			total += inputs[i].size();
+			if(!inputs[i].empty()) heap.push(_head{i, 0});
+		}
+		std::vector<result_type> merged;
+		merged.reserve(total);
+		std::unordered_set<std::string> seen;
+		while(!heap.empty()) {
+			_head top(heap.top());
+			heap.pop();
+			result_type& r(inputs[top.input][top.position]);
+			if(seen.insert(r.first).second) {
+				merged.push_back(std::move(r));
+			}
+			if(++top.position < inputs[top.input].size()) {
+				heap.push(top);
+			}
+		} // while
+		return merged;
+	} // merge
+
+/*! Calls a function with every name and its dictionary, in the
+ *  order of the names. */
+	template <typename function_T>
+	void forEach(function_T f) const {
+		for(auto i(_byName.cbegin()); i != _byName.cend(); ++i) {
+			f(i->first, *(i->second));
+		}
+	} // forEach
+
+//! The number of distinct names.
+	std::size_t size() const {
+		return _byName.size();
+	}
+}; // class Dictionaries
+
+#endif
@@ -1,13 +1,16 @@
 
-#include "Suggest.hpp"
+#include "Dictionaries.hpp"
 #include "IO.hpp"
+#include "Utf8.hpp"
+#include <cstdio>
+#include <iomanip>
 
 
 using namespace IO;
 
 std::ostream& IO::operator<<(std::ostream& st, const Usage& that) {
 	st << that._name << ": " << that._msg << std::endl <<
-		"Usage: " << that._name << " [-abps] CORPUSFILE" << std::endl <<
+		"Usage: " << that._name << " [-abpstj] [-eN] [--OPTION=VALUE ...] CORPUSFILE" << std::endl <<
 		"Reads words from standard input and prints suggestions to standard output." << std::endl <<
 		"Examples\n  Print all found suggestions, using probability based corpus and maximum edit distance 2:\n" <<
 		that._name << " -apd2 corpus.txt" << std::endl <<
@@ -16,7 +19,47 @@ std::ostream& IO::operator<<(std::ostream& st, const Usage& that) {
 		" -b, best - Return only the single best solution.\n" <<
 		" -p, probability - Use tab seperated word corpus with floating point numbers to indicate word probability (default).\n" <<
 		" -s, simple - Use a simple, non-probability corpus.\n" <<
-		" -eN edit distance 0 <= N <= 9, Find suggestions with a maximum of N unit edit operations (default 1)." << std::endl;
+		" -t, tsv - Print one tab separated line per suggestion: query, word, edit distance, log-probability.\n" <<
+		" -j, json - Print one JSON object per line per suggestion, with the same fields as -t.\n" <<
+		" -eN edit distance 0 <= N <= 9, Find suggestions with a maximum of N unit edit operations (default 1).\n" <<
+		" --engine=trie|split|radix, Search algorithm: depth-first search through the tri (default),\n" <<
+		"   search from both ends of the word, which is faster for long words at higher edit distances,\n" <<
+		"   or search a path-compressed copy of the tri, which is faster at edit distance 2 and more.\n" <<
+		" --dict=NAME=FILE, Load an additional dictionary; may be given several times. CORPUSFILE is\n" <<
+		"   the default dictionary, named 'default'. Input lines of the form NAME<TAB>WORD search\n" <<
+		"   dictionary NAME, NAME1+NAME2<TAB>WORD searches both and merges their suggestions.\n" <<
+		" --threads=N, Split expensive searches (edit distance 2 and more) of the trie engine over\n" <<
+		"   N worker threads (default 0, single-threaded).\n" <<
+		" --costs=FILE, Weigh edit operations with the costs in FILE (see data/qwerty.costs) and\n" <<
+		"   rank suggestions by summed cost; -t and -j print the cost as an additional field.\n" <<
+		" --max-cost=X, Highest summed edit cost of a suggestion with --costs (default N of -eN).\n" <<
+		" --case=keep|fold, Keep upper and lower case apart (default), or fold dictionaries and\n" <<
+		"   input words to lower case; suggestions are then printed in lower case.\n" <<
+		" --values=exact|quantized, Store word probabilities as doubles (default), or as 16 bit\n" <<
+		"   codes, which is exact for corpora with up to 65536 distinct probabilities.\n" <<
+		" --bigrams=FILE, Read sentences instead of words and rank the suggestions for every word\n" <<
+		"   by its probability after the word before, from a model built by bin/buildbigrams.\n" <<
+		" --edit-weight=X, Log-probability that one edit operation costs with --bigrams (default 5).\n" <<
+		" --text=annotate|correct, Read running text until EOF and write it back, with every word\n" <<
+		"   that is not in the default dictionary followed by its suggestions in brackets (-b: only\n" <<
+		"   the best one), or replaced by its best suggestion. Cannot be combined with -t, -j or\n" <<
+		"   --bigrams; --threads=N searches the misspelled words of a batch in parallel.\n" <<
+		" --miss-cache=N, Remember the last N words that had no suggestions and answer them\n" <<
+		"   again without searching (default 0, off).\n" <<
+		" --qgram-filter=Q, Skip the search for words that share too few substrings of length Q\n" <<
+		"   with the dictionary to have any suggestion (default 0, off; 3 is a good choice).\n" <<
+		" --max-items=N, --deadline=MICROSECONDS, Stop the search for a word after N search items\n" <<
+		"   or that much time, and print the suggestions found so far; those with fewer edits are\n" <<
+		"   found first. -t and -j print whether the suggestions are complete (1 or 0) as an\n" <<
+		"   additional field. Searches with a budget always use the trie engine.\n" <<
+		" --complete=K, Read prefixes instead of words and print the K most probable words that\n" <<
+		"   begin with them, or with a string within N unit edit operations of them (-eN).\n" <<
+		" --metrics=PATH, Serve query counts, latency and result histograms, cache hit counts and\n" <<
+		"   dictionary sizes on the Unix socket PATH, as text in the Prometheus format, e.g. with\n" <<
+		"   curl --unix-socket PATH http://localhost/metrics .\n" <<
+		" --trace=FILE, Write the queries, with their latencies, to the binary trace FILE, to\n" <<
+		"   replay them later with bin/replaytrace.\n" <<
+		" --trace-sample=N, With --trace, write only every N-th query (default 1, all of them)." << std::endl;
 	return st;
 }
 /*! Constructs an object representing command line option input. This
@@ -26,7 +69,7 @@ std::ostream& IO::operator<<(std::ostream& st, const Usage& that) {
 \param n Maximum edit distance 
 */
 IO::param_t::param_t(flag_t f,const unsigned int n)
-	: maxEditDistance(n), corpusFilename("") {
+	: maxEditDistance(n), corpusFilename(""), engine(Engine::trie), dictionaries(), threads(0), costsFilename(""), maxCost(-1.0), foldCase(false), quantize(false), bigramsFilename(""), editWeight(defaultEditWeight), textMode(TextMode::annotate), missCache(0), qgrams(0), maxItems(0), deadline(0), completions(0), metricsSocket(""), traceFilename(""), traceEvery(1) {
 	f |= all;
 	f |= probability;
 
@@ -36,6 +79,9 @@ IO::param_t::param_t(flag_t f,const unsigned int n)
 // same for probability and simple
 	if(f & simple)
 		f &= ~probability;
+// and for the two machine readable formats
+	if(f & json)
+		f &= ~tsv;
 	flags = f;
 }
 /*! Validates a command line parameter string of flags (i.e. "-ape3")
@@ -68,7 +114,7 @@ param_t IO::parseCmdLineArgs(const std::string& flagstring) {
 			state = parameters;
 			break;
 		case parameters:
-			if(paramCount > 4) {
+			if(paramCount > 6) {
 // user specified some option twice; be strict and terminate
 				throw std::runtime_error("Too many flags.");
 			};
@@ -85,6 +131,12 @@ param_t IO::parseCmdLineArgs(const std::string& flagstring) {
 			case 'p':
 				flags |= probability;
 				break;
+			case 't':
+				flags |= tsv;
+				break;
+			case 'j':
+				flags |= json;
+				break;
 			case 'e':
 				++i;  // e must be followed by a
 				      // number; advance input string
@@ -104,3 +156,226 @@ param_t IO::parseCmdLineArgs(const std::string& flagstring) {
 	} // for
 	return param_t(flags, maxEditDistance);
 }
+
+/*! Long options have the form --name=value and are given in addition
+ *  to the short flags. This function will throw on unknown options or
+ *  invalid values.
+\param params The parameters to update.
+\param option A command line argument starting with two hyphens.
+*/
+void IO::parseLongOption(param_t& params, const std::string& option) {
+	const std::size_t eq(option.find('='));
+	if(option.compare(0, 2, "--") != 0 || eq == std::string::npos) {
+		throw std::runtime_error("Malformed option '" + option + "'.");
+	}
+	const std::string name(option.substr(2, eq - 2));
+	const std::string value(option.substr(eq + 1));
+	if(name == "engine") {
+		if(value == "trie") {
+			params.engine = Engine::trie;
+		} else if(value == "split") {
+			params.engine = Engine::split;
+		} else if(value == "radix") {
+			params.engine = Engine::radix;
+		} else {
+			throw std::runtime_error("Unknown engine '" + value + "'.");
+		}
+	} else if(name == "threads") {
+		if(value.empty() || value.size() > 4 || value.find_first_not_of("0123456789") != std::string::npos) {
+			throw std::runtime_error("Expected --threads=N.");
+		}
+		params.threads = std::stoi(value);
+	} else if(name == "dict") {
+		const std::size_t sep(value.find('='));
+		if(sep == std::string::npos || sep == 0 || sep + 1 == value.size()) {
+			throw std::runtime_error("Expected --dict=NAME=FILE.");
+		}
+		params.dictionaries.push_back(std::make_pair(value.substr(0, sep), value.substr(sep + 1)));
+	} else if(name == "costs") {
+		if(value.empty()) {
+			throw std::runtime_error("Expected --costs=FILE.");
+		}
+		params.costsFilename = value;
+		params.flags |= weighted;
+	} else if(name == "case") {
+		if(value == "fold") {
+			params.foldCase = true;
+		} else if(value == "keep") {
+			params.foldCase = false;
+		} else {
+			throw std::runtime_error("Expected --case=fold|keep.");
+		}
+	} else if(name == "values") {
+		if(value == "quantized") {
+			params.quantize = true;
+		} else if(value == "exact") {
+			params.quantize = false;
+		} else {
+			throw std::runtime_error("Expected --values=exact|quantized.");
+		}
+	} else if(name == "bigrams") {
+		if(value.empty()) {
+			throw std::runtime_error("Expected --bigrams=FILE.");
+		}
+		params.bigramsFilename = value;
+		params.flags |= sentences;
+	} else if(name == "edit-weight") {
+		std::size_t end(0);
+		try {
+			params.editWeight = std::stod(value, &end);
+		} catch(std::exception&) {
+			end = 0;
+		}
+		if(end == 0 || end != value.size() || params.editWeight < 0) {
+			throw std::runtime_error("Expected --edit-weight=X with X >= 0.");
+		}
+	} else if(name == "text") {
+		if(value == "annotate") {
+			params.textMode = TextMode::annotate;
+		} else if(value == "correct") {
+			params.textMode = TextMode::correct;
+		} else {
+			throw std::runtime_error("Expected --text=annotate|correct.");
+		}
+		params.flags |= text;
+	} else if(name == "miss-cache") {
+		if(value.empty() || value.size() > 9 || value.find_first_not_of("0123456789") != std::string::npos) {
+			throw std::runtime_error("Expected --miss-cache=N.");
+		}
+		params.missCache = std::stoul(value);
+	} else if(name == "qgram-filter") {
+		if(value.size() != 1 || value[0] < '0' || value[0] > '7') {
+			throw std::runtime_error("Expected --qgram-filter=Q with 0 <= Q <= 7.");
+		}
+		params.qgrams = value[0] - '0';
+	} else if(name == "complete") {
+		if(value.empty() || value.size() > 4 || value.find_first_not_of("0123456789") != std::string::npos || std::stoi(value) == 0) {
+			throw std::runtime_error("Expected --complete=K with K > 0.");
+		}
+		params.completions = std::stoi(value);
+		params.flags |= completion;
+	} else if(name == "metrics") {
+		if(value.empty()) {
+			throw std::runtime_error("Expected --metrics=PATH.");
+		}
+		params.metricsSocket = value;
+	} else if(name == "trace") {
+		if(value.empty()) {
+			throw std::runtime_error("Expected --trace=FILE.");
+		}
+		params.traceFilename = value;
+	} else if(name == "trace-sample") {
+		if(value.empty() || value.size() > 9 || value.find_first_not_of("0123456789") != std::string::npos || std::stoul(value) == 0) {
+			throw std::runtime_error("Expected --trace-sample=N with N > 0.");
+		}
+		params.traceEvery = std::stoul(value);
+	} else if(name == "max-items" || name == "deadline") {
+		if(value.empty() || value.size() > 9 || value.find_first_not_of("0123456789") != std::string::npos) {
+			throw std::runtime_error("Expected --" + name + "=N.");
+		}
+		(name == "deadline" ? params.deadline : params.maxItems) = std::stoul(value);
+		if(params.deadline || params.maxItems) {
+			params.flags |= budgeted;
+		} else {
+			params.flags &= ~budgeted;
+		}
+	} else if(name == "max-cost") {
+		std::size_t end(0);
+		try {
+			params.maxCost = std::stod(value, &end);
+		} catch(std::exception&) {
+			end = 0;
+		}
+		if(end == 0 || end != value.size() || params.maxCost < 0) {
+			throw std::runtime_error("Expected --max-cost=X with X >= 0.");
+		}
+	} else {
+		throw std::runtime_error("Unrecognized option '" + option + "'.");
+	}
+} // parseLongOption
+
+/*! Dictionary names never contain tabs and words never do either, so
+ *  the first tab of a line separates the two.
+\param line A line of input.
+\param names Set to the part before the first tab, or the empty string.
+\param word Set to the part after the first tab, or the whole line.
+*/
+void IO::splitRequest(const std::string& line, std::string& names, std::string& word) {
+	const std::size_t tab(line.find('\t'));
+	if(tab == std::string::npos) {
+		names.clear();
+		word = line;
+	} else {
+		names.assign(line, 0, tab);
+		word.assign(line, tab + 1, std::string::npos);
+	}
+} // splitRequest
+
+void IO::splitWords(const std::string& sentence, std::vector<std::string>& words) {
+	std::vector<std::pair<std::size_t, std::size_t>> spans;
+	Utf8::findWords(sentence, spans);
+	words.clear();
+	for(auto s(spans.cbegin()); s != spans.cend(); ++s) {
+		words.push_back(sentence.substr(s->first, s->second));
+	}
+} // splitWords
+
+/*! Escapes a string to be used as a JSON string literal, without the
+ *  surrounding quotes. Bytes that are not ASCII control characters
+ *  are passed through unchanged.
+ \param s The string to escape.
+ \return The escaped string.
+*/
+static std::string jsonEscape(const std::string& s) {
+	std::string escaped;
+	escaped.reserve(s.size());
+	for(auto i(s.cbegin()); i != s.cend(); ++i) {
+		switch(*i) {
+		case '"':
+			escaped += "\\\"";
+			break;
+		case '\\':
+			escaped += "\\\\";
+			break;
+		default:
+			if((unsigned char)*i < 0x20) {
+				char buf[8];
+				snprintf(buf, sizeof(buf), "\\u%04x", (unsigned char)*i);
+				escaped += buf;
+			} else {
+				escaped.push_back(*i);
+			}
+		} // switch
+	} // for
+	return escaped;
+} // jsonEscape
+
+void IO::printResult(std::ostream& st, const std::string& query, const Tri<double>::TolerantResult& r, const flag_t flags, const bool complete) {
+// probabilities in the corpora have more digits than the default
+// stream precision of 6; costs are sums of floats and have fewer
+	const std::streamsize oldPrecision(st.precision(12));
+	if(flags & json) {
+		st << "{\"query\":\"" << jsonEscape(query)
+		   << "\",\"word\":\"" << jsonEscape(r.first)
+		   << "\",\"distance\":" << r.editDistance
+		   << ",\"logprob\":" << r.second;
+		if(flags & weighted) {
+			st << ",\"cost\":" << std::setprecision(6) << r.cost;
+		}
+		if(flags & budgeted) {
+			st << ",\"complete\":" << (complete ? "true" : "false");
+		}
+		st << "}\n";
+	} else {
+		st << query << '\t' << r.first << '\t'
+		   << r.editDistance << '\t' << r.second;
+		if(flags & weighted) {
+			st << '\t' << std::setprecision(6) << r.cost;
+		}
+		if(flags & budgeted) {
+			st << '\t' << (complete ? 1 : 0);
+		}
+		st << '\n';
+	}
+	st.precision(oldPrecision);
+} // printResult
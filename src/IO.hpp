@@ -2,6 +2,10 @@
 #ifndef __IO_HPP__
 #define __IO_HPP__
 
+#include "TextPipeline.hpp"
+#include "Metrics.hpp"
+#include "QueryTracer.hpp"
+
 // this is merely to combat gratuitous auto-indentation
 namespace IO {
 	#include "IO_.hpp"
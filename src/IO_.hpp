@@ -31,7 +31,27 @@ enum Flag {
 	best = 2, /*!< Give only the single best result. */
 	probability = 4, /*!< Parse the corpus expecting probability
 			   annotations. */
-	simple = 8 /*!< Parse corpus without annotations. */
+	simple = 8, /*!< Parse corpus without annotations. */
+	tsv = 16, /*!< Print one tab separated line per suggestion,
+		    with edit distance and probability. */
+	json = 32, /*!< Print one JSON object per line per suggestion,
+		    with edit distance and probability. */
+	weighted = 64, /*!< Search with the edit costs of a cost file,
+			set with --costs; machine readable output
+			gets the summed cost as an additional field. */
+	sentences = 128, /*!< Read sentences instead of words and rank
+			  suggestions with a bigram model, set with
+			  --bigrams. */
+	text = 256, /*!< Read running text and write it back annotated
+		     or corrected, set with --text. */
+	budgeted = 512, /*!< Limit every search to a number of items or
+			 a time, set with --max-items and --deadline;
+			 machine readable output gets whether the
+			 suggestions are complete as an additional
+			 field. */
+	completion = 1024 /*!< Read prefixes instead of words and give
+			    their most probable completions, set with
+			    --complete. */
 };
 
 //! Holds command line argument data.
@@ -41,6 +61,50 @@ struct param_t {
 					beam search will use. */
 	std::string corpusFilename; /*!< Filename of the corpus or
 				      wordlist. */
+	Engine engine; /*!< Search algorithm, set with --engine. */
+	std::vector<std::pair<std::string, std::string>> dictionaries; /*!<
+					Names and corpus filenames of
+					additional dictionaries, set
+					with --dict. */
+	unsigned int threads; /*!< Worker threads for parallel
+				searches, set with --threads; 0 or 1
+				means single-threaded. */
+	std::string costsFilename; /*!< Cost file for weighted
+				     searches, set with --costs; empty
+				     for unit costs. */
+	double maxCost; /*!< Highest summed edit cost of weighted
+			  searches, set with --max-cost; negative
+			  means the maximum edit distance. */
+	bool foldCase; /*!< Whether dictionaries and queries are
+			 folded to lower case, set with --case. */
+	bool quantize; /*!< Whether probabilities are stored in 16
+			 bits, set with --values. */
+	std::string bigramsFilename; /*!< Bigram model for sentences,
+				       set with --bigrams; empty for
+				       none. */
+	double editWeight; /*!< Log-probability of an edit operation
+			     in sentences, set with --edit-weight. */
+	TextMode textMode; /*!< What to write for misspelled words of
+			     running text, set with --text. */
+	std::size_t missCache; /*!< Queries without suggestions to
+				 remember, set with --miss-cache; 0
+				 for none. */
+	unsigned int qgrams; /*!< The q of the q-gram filter, set with
+			       --qgram-filter; 0 for none. */
+	unsigned long maxItems; /*!< Search items per query, set with
+				  --max-items; 0 for no limit. */
+	unsigned long deadline; /*!< Microseconds per query, set with
+				  --deadline; 0 for no limit. */
+	unsigned int completions; /*!< Completions per prefix, set with
+				    --complete; 0 for none. */
+	std::string metricsSocket; /*!< Unix socket to serve metrics on,
+				     set with --metrics; empty for
+				     none. */
+	std::string traceFilename; /*!< File to write sampled queries
+				     to, set with --trace; empty for
+				     none. */
+	unsigned long traceEvery; /*!< Every how many queries one is
+				    traced, set with --trace-sample. */
 	param_t() = delete;
 //! Takes command line flags and maximum edit distance to build
 //! program parameters.
@@ -49,6 +113,9 @@ struct param_t {
 //! Tries to build parameter data from command line argument string
 //! (only the hyphen portion); throws on malformed input.
 param_t parseCmdLineArgs(const std::string& flagstring);
+//! Applies a long command line option of the form --name=value to
+//! program parameters; throws on unknown options or bad values.
+void parseLongOption(param_t& params, const std::string& option);
 
 //! Directly prints contents of any container to std::cout
 template <template <typename, typename...> class container_T, class value_T, typename... args>
@@ -58,32 +125,268 @@ void printContainer(const container_T<value_T, args...>& v) {
 		std::cout << *i << std::endl;
 	} // for
 } // printContainer
+//! Prints a single search result in a machine readable format.
+/*! Depending on the flags, either a tab separated line of query,
+ * word, edit distance and probability or a JSON object with the same
+ * fields is printed, followed by a newline. With the weighted flag,
+ * the summed edit cost follows as a field, and with the budgeted flag
+ * whether the search finished within its budget.
+ \param st The stream to print to.
+ \param query The word the suggestion was searched for.
+ \param r A ranked search result, as returned by Suggest::ranked .
+ \param flags Command line flags; either tsv or json must be set.
+ \param complete Whether the search found all suggestions.
+*/
+void printResult(std::ostream& st, const std::string& query, const Tri<double>::TolerantResult& r, const flag_t flags, const bool complete = true);
+
+//! Loads all dictionaries named in the program parameters.
+/*! \param dictionaries The dictionaries to load into.
+ \param params Program parameters.
+ \param pool Threads for parallel searches, or null.
+ \param costs Edit costs for weighted searches, or null.
+ \param bigrams Bigram model for sentences, or null.
+*/
+template <typename parser_T>
+void loadDictionaries(Dictionaries<parser_T>& dictionaries, const param_t& params, ThreadPool* pool, const CostMatrix* costs, const BigramModel* bigrams) {
+	SuggestOptions options(params.maxEditDistance, params.engine);
+	options.pool = pool;
+	options.costs = costs;
+	options.foldCase = params.foldCase;
+	options.quantize = params.quantize;
+	options.bigrams = bigrams;
+	options.editWeight = params.editWeight;
+	options.missCache = params.missCache;
+	options.qgrams = params.qgrams;
+	if(params.maxCost >= 0) {
+		options.maxCost = params.maxCost;
+	}
+	for(auto d(params.dictionaries.cbegin()); d != params.dictionaries.cend(); ++d) {
+		dictionaries.load(d->first, d->second, options);
+	}
+} // loadDictionaries
+
+/*! Adds the sizes of the dictionaries and the counters of their miss
+ *  caches, q-gram filters and shared searches to Metrics, labelled
+ *  with the dictionary names.
+ \param metrics The metrics to add to.
+ \param dictionaries The loaded dictionaries; must outlive the
+ metrics.
+*/
+template <typename parser_T>
+void watchDictionaries(Metrics& metrics, const Dictionaries<parser_T>& dictionaries) {
+	typedef Suggest<parser_T> suggest_T;
+	typedef std::function<double(const suggest_T&)> read_T;
+	struct Watched {
+		const char* name; /*!< The metric name. */
+		const char* help; /*!< What it means. */
+		bool counter; /*!< Whether it only grows. */
+		bool (*present)(const suggest_T&); /*!< Whether a
+						     dictionary has it. */
+		read_T read; /*!< Reads it from a dictionary. */
+	};
+	const Watched watched[] = {
+		{"dym_dictionary_states", "States of the trie of a dictionary.", false,
+		 [](const suggest_T&) { return true; }, [](const suggest_T& s) { return double(s.getStates()); }},
+		{"dym_dictionary_words", "Words of a dictionary.", false,
+		 [](const suggest_T&) { return true; }, [](const suggest_T& s) { return double(s.getKeys()); }},
+		{"dym_miss_cache_lookups_total", "Queries looked up in the miss cache (--miss-cache).", true,
+		 [](const suggest_T& s) { return s.getMissCache() != nullptr; },
+		 [](const suggest_T& s) { return double(s.getMissCache()->getLookups()); }},
+		{"dym_miss_cache_hits_total", "Queries answered by the miss cache without a search.", true,
+		 [](const suggest_T& s) { return s.getMissCache() != nullptr; },
+		 [](const suggest_T& s) { return double(s.getMissCache()->getHits()); }},
+		{"dym_qgram_checks_total", "Queries checked by the q-gram filter (--qgram-filter).", true,
+		 [](const suggest_T& s) { return s.getQGramFilter() != nullptr; },
+		 [](const suggest_T& s) { return double(s.getQGramFilter()->getChecks()); }},
+		{"dym_qgram_rejections_total", "Queries the q-gram filter answered without a search.", true,
+		 [](const suggest_T& s) { return s.getQGramFilter() != nullptr; },
+		 [](const suggest_T& s) { return double(s.getQGramFilter()->getRejections()); }}
+	};
+// gauges of one name go one after the other, one per dictionary
+	for(auto w(std::begin(watched)); w != std::end(watched); ++w) {
+		dictionaries.forEach([&metrics, w](const std::string& name, const suggest_T& s) {
+				if(!w->present(s)) return;
+				const read_T read(w->read);
+				metrics.addGauge(w->name, "dictionary=\"" + name + "\"", w->help, w->counter, [read, &s]() { return read(s); });
+			});
+	}
+} // watchDictionaries
+
+/*! Splits an input line into the dictionary selection and the word.
+ *  Lines of the form NAMES'TAB'WORD select dictionaries, where NAMES
+ *  is one dictionary name or several joined by '+'; other lines are
+ *  words for the default dictionary.
+ \param line A line of input.
+ \param names Set to the dictionary selection; empty for the default.
+ \param word Set to the word to search for.
+*/
+void splitRequest(const std::string& line, std::string& names, std::string& word);
+
+/*! Splits a sentence into its words: the longest runs of letters and
+ *  combining marks in UTF-8. Everything else, including bytes that
+ *  are not valid UTF-8, separates words.
+ \param sentence A line of text.
+ \param words Set to the words of the sentence, in order.
+*/
+void splitWords(const std::string& sentence, std::vector<std::string>& words);
+
+/*! Reads sentences and prints suggestions for their words, ranked in
+ *  context.
+ \param dictionaries The dictionaries used to find corrections.
+ \param params Command line arguments that were specified.
+ Every input line is a sentence, with an optional dictionary name and
+ a tab in front, like the words of loopSuggest ; only one dictionary
+ can be selected. Every word of the sentence is searched, and its
+ suggestions are ranked with Suggest::rankedInContext after the best
+ suggestion for the word before, and printed as if the word had been
+ an input line of loopSuggest . The loop ends on EOF or an empty line.
+*/
+template <typename parser_T>
+void loopSentences(const Dictionaries<parser_T>& dictionaries, const param_t& params) {
+	std::string names, sentence;
+	std::vector<std::string> words;
+	for(std::string line; std::getline(std::cin, line);) {
+		if(line.empty())
+			break;
+		splitRequest(line, names, sentence);
+		try {
+			const auto selection(dictionaries.select(names));
+			if(selection.size() != 1) {
+				throw std::runtime_error("Sentences can only be searched in one dictionary.");
+			}
+			splitWords(sentence, words);
+			unsigned int context(BigramModel::unknownWord);
+			for(auto w(words.cbegin()); w != words.cend(); ++w) {
+				const auto v(selection.front()->rankedInContext(*w, context));
+				for(auto i(v.cbegin()); i != v.cend(); ++i) {
+					if(params.flags & (tsv | json)) {
+						printResult(std::cout, *w, *i, params.flags);
+					} else {
+						std::cout << i->first << '\n';
+					}
+					if(params.flags & best)
+						break;
+				} // for suggestions
+				if(v.empty() && (params.flags & best) && !(params.flags & (tsv | json))) {
+					std::cout << '\n';
+				}
+				if(!(params.flags & (tsv | json))) {
+					std::cout << std::endl;
+				}
+			} // for words
+		} catch(std::runtime_error& e) {
+			std::cerr << e.what() << std::endl;
+		}
+	} // for
+	std::cout.flush();
+} // loopSentences
+
+/*! Reads running text and writes it back with its misspelled words
+ *  annotated or corrected, see TextPipeline .
+ \param dictionaries The dictionaries; the text is checked against
+ the default one.
+ \param params Command line arguments that were specified; with the
+ best flag, annotations carry only the best suggestion.
+ \param pool Threads to search the misspelled words on, or null.
+ Unlike loopSuggest , empty lines do not end the input; the loop ends
+ on EOF.
+*/
+template <typename parser_T>
+void loopText(const Dictionaries<parser_T>& dictionaries, const param_t& params, ThreadPool* pool) {
+	TextPipeline<Suggest<parser_T>> pipeline(*dictionaries.select("").front(), pool, params.textMode, (params.flags & best) ? 1 : 0);
+	pipeline.run(std::cin, std::cout);
+} // loopText
+
 //! Main loop of the program. Takes input and prints suggestions for correction.
-/*! \param suggest An instance of Suggest, used to find corrections
- *  for the input.
+/*! \param dictionaries The dictionaries used to find corrections for
+ *  the input.
  \param params Command line arguments that were specified.
+ \param pool Threads for the text mode, see loopText ; may be null.
+ \param metrics Counts the queries of words and prefixes, or null.
+ \param tracer Writes a sample of the queries of words and prefixes
+ to a trace, or null.
  This function continuously reads from std::cin and feeds the input to
- a Suggest instance. The output is printed immediatly to std::cout. If
- a single newline is input, only a newline is printed to std::cout and
- no action is performed. The loop ends on EOF or two newlines etc.
+ the selected dictionaries. The output is printed immediatly to
+ std::cout. If a single newline is input, only a newline is printed
+ to std::cout and no action is performed. The loop ends on EOF or two
+ newlines etc.
+ With the tsv or json flags, every suggestion is printed on its own
+ line together with the query, its edit distance and its probability.
+ Input lines can select dictionaries, see splitRequest; requests for
+ unknown dictionaries print an error message to std::cerr and give
+ no suggestions.
 
  The Suggest type is parametrized in its corpus parser type. For this
  reason, this function is templated and can work with any Suggest type.
 */ 
 template <typename parser_T>
-void loopSuggest(const Suggest<parser_T>& suggest, const param_t& params) {
+void loopSuggest(const Dictionaries<parser_T>& dictionaries, const param_t& params, ThreadPool* pool, Metrics* metrics = nullptr, QueryTracer* tracer = nullptr) {
+	if(params.flags & text) {
+		loopText(dictionaries, params, pool);
+		return;
+	}
+	if(params.flags & sentences) {
+		loopSentences(dictionaries, params);
+		return;
+	}
+	std::string names, word;
+	const QueryMode mode((params.flags & completion) ? QueryMode::complete : (params.flags & best) ? QueryMode::best : QueryMode::all);
 	for(std::string line; std::getline(std::cin, line);) {
 		if(line.empty())
 			break;
-		if(params.flags & all) {
-			printContainer(suggest.all(line));
-		} else if(params.flags & best) {
-			std::cout << suggest.best(line) << std::endl;
-		} // else if best
+		Metrics::Timer timer(metrics, mode, params.maxEditDistance, tracer, &line, params.completions);
+		splitRequest(line, names, word);
+// the time of a budget starts now, when the query has been read
+		SearchBudget budget(params.maxItems, std::chrono::microseconds(params.deadline));
+		SearchBudget* const limits((params.flags & budgeted) ? &budget : nullptr);
+		const unsigned int wanted((params.flags & best) ? 1 : 0);
+		try {
+			const auto selection(dictionaries.select(names));
+			auto search = [&]() {
+				return (params.flags & completion) ? dictionaries.complete(selection, word, params.completions, params.maxEditDistance)
+					: dictionaries.ranked(selection, word, limits, wanted);
+			};
+			if(params.flags & (tsv | json)) {
+// machine readable formats carry the query on every line, so there
+// is no empty line between the results of two queries
+				const auto v(search());
+				timer.results((params.flags & best) ? std::min<std::size_t>(v.size(), 1) : v.size());
+				for(auto i(v.cbegin()); i != v.cend(); ++i) {
+					printResult(std::cout, word, *i, params.flags, !budget.exhausted);
+					if(params.flags & best)
+						break;
+				} // for
+				continue;
+			} else if(selection.size() == 1 && !limits && !(params.flags & completion)) {
+				if(params.flags & all) {
+					const auto v(selection.front()->all(word));
+					timer.results(v.size());
+					printContainer(v);
+				} else if(params.flags & best) {
+					const std::string b(selection.front()->best(word));
+					timer.results(b.empty() ? 0 : 1);
+					std::cout << b << std::endl;
+				} // else if best
+			} else {
+// merged lookup over several dictionaries, searches in a budget, or
+// completions
+				const auto v(search());
+				timer.results((params.flags & best) ? std::min<std::size_t>(v.size(), 1) : v.size());
+				for(auto i(v.cbegin()); i != v.cend(); ++i) {
+					std::cout << i->first << std::endl;
+					if(params.flags & best)
+						break;
+				} // for
+				if(v.empty() && (params.flags & best)) {
+					std::cout << std::endl;
+				}
+			} // else merged
+		} catch(std::runtime_error& e) {
+			timer.fail();
+			std::cerr << e.what() << std::endl;
+			if(params.flags & (tsv | json))
+				continue;
+		}
 		std::cout << std::endl;
 	} // for
 } // loopSuggest
-
-
-
-
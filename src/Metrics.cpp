@@ -0,0 +1,274 @@
+#include "Metrics.hpp"
+#include "QueryTracer.hpp"
+#include <sstream>
+#include <algorithm>
+#include <stdexcept>
+#include <cerrno>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <unistd.h>
+
+//! Numbers the threads that record, in the order they first do.
+static std::atomic<unsigned int> nextThread(0);
+//! The number of the calling thread, see nextThread .
+static thread_local const unsigned int threadNumber(nextThread++);
+
+//! The names of the QueryModes, as labels.
+static const char* const modeNames[queryModes] = {"all", "best", "complete"};
+
+Metrics::Metrics()
+	: _shards(new Shard[metricsShards]()), _gauges(), _started(std::chrono::steady_clock::now()) {}
+
+Metrics::Shard& Metrics::_shard() {
+	return _shards[threadNumber % metricsShards];
+} // _shard
+
+void Metrics::record(const QueryMode mode, const unsigned int distance, const std::chrono::nanoseconds latency, const std::size_t results) {
+	Shard& s(_shard());
+	const unsigned int m(static_cast<unsigned int>(mode));
+	const unsigned int d(std::min(distance, metricsMaxDistance));
+	const unsigned long ns(latency.count() > 0 ? latency.count() : 0);
+	unsigned int l(0);
+	while(l + 1 < latencyBuckets && ns > latencyBounds[l]) {
+		++l;
+	}
+	unsigned int r(0);
+	while(r + 1 < resultBuckets && results > resultBounds[r]) {
+		++r;
+	}
+	s.latency[m][d][l].fetch_add(1, std::memory_order_relaxed);
+	s.nanoseconds[m][d].fetch_add(ns, std::memory_order_relaxed);
+	s.results[m][r].fetch_add(1, std::memory_order_relaxed);
+	s.resultSum[m].fetch_add(results, std::memory_order_relaxed);
+} // record
+
+void Metrics::recordError() {
+	_shard().errors.fetch_add(1, std::memory_order_relaxed);
+} // recordError
+
+void Metrics::addGauge(const std::string& name, const std::string& labels, const std::string& help, const bool counter,
+		       std::function<double()> read) {
+	_gauges.push_back(Gauge{name, labels, help, counter, std::move(read)});
+} // addGauge
+
+unsigned long Metrics::getQueries() const {
+	unsigned long n(0);
+	for(unsigned int s(0); s < metricsShards; ++s) {
+		const Shard& shard(_shards[s]);
+		for(unsigned int m(0); m < queryModes; ++m) {
+			for(unsigned int r(0); r < resultBuckets; ++r) {
+				n += shard.results[m][r].load(std::memory_order_relaxed);
+			}
+		}
+		n += shard.errors.load(std::memory_order_relaxed);
+	}
+	return n;
+} // getQueries
+
+/*! Writes the HELP and TYPE lines of a metric.
+ \param st The stream to write to.
+ \param name The metric name.
+ \param type Its Prometheus type.
+ \param help What it means.
+*/
+static void header(std::ostream& st, const std::string& name, const char* type, const std::string& help) {
+	st << "# HELP " << name << ' ' << help << "\n# TYPE " << name << ' ' << type << '\n';
+} // header
+
+void Metrics::write(std::ostream& st) const {
+// the shards are summed up first; counters that are still being added
+// to may be a query ahead of each other, which scrapers tolerate
+	unsigned long latency[queryModes][metricsMaxDistance + 1][latencyBuckets] = {};
+	unsigned long nanoseconds[queryModes][metricsMaxDistance + 1] = {};
+	unsigned long results[queryModes][resultBuckets] = {};
+	unsigned long resultSum[queryModes] = {};
+	unsigned long errors(0);
+	for(unsigned int s(0); s < metricsShards; ++s) {
+		const Shard& shard(_shards[s]);
+		for(unsigned int m(0); m < queryModes; ++m) {
+			for(unsigned int d(0); d <= metricsMaxDistance; ++d) {
+				for(unsigned int l(0); l < latencyBuckets; ++l) {
+					latency[m][d][l] += shard.latency[m][d][l].load(std::memory_order_relaxed);
+				}
+				nanoseconds[m][d] += shard.nanoseconds[m][d].load(std::memory_order_relaxed);
+			}
+			for(unsigned int r(0); r < resultBuckets; ++r) {
+				results[m][r] += shard.results[m][r].load(std::memory_order_relaxed);
+			}
+			resultSum[m] += shard.resultSum[m].load(std::memory_order_relaxed);
+		}
+		errors += shard.errors.load(std::memory_order_relaxed);
+	} // for s
+
+	const std::streamsize oldPrecision(st.precision(9));
+	header(st, "dym_queries_total", "counter", "Queries answered, by mode and maximum edit distance.");
+	for(unsigned int m(0); m < queryModes; ++m) {
+		for(unsigned int d(0); d <= metricsMaxDistance; ++d) {
+			unsigned long n(0);
+			for(unsigned int l(0); l < latencyBuckets; ++l) {
+				n += latency[m][d][l];
+			}
+			if(n) {
+				st << "dym_queries_total{mode=\"" << modeNames[m] << "\",distance=\"" << d << "\"} " << n << '\n';
+			}
+		}
+	}
+	header(st, "dym_query_errors_total", "counter", "Queries that failed, like those for unknown dictionaries.");
+	st << "dym_query_errors_total " << errors << '\n';
+// only the modes and distances that had queries get a histogram
+	header(st, "dym_query_latency_seconds", "histogram", "Time from reading a query to writing its suggestions.");
+	for(unsigned int m(0); m < queryModes; ++m) {
+		for(unsigned int d(0); d <= metricsMaxDistance; ++d) {
+			std::ostringstream labels;
+			labels << "mode=\"" << modeNames[m] << "\",distance=\"" << d << '"';
+			unsigned long n(0);
+			for(unsigned int l(0); l < latencyBuckets; ++l) {
+				n += latency[m][d][l];
+			}
+			if(!n) continue;
+			unsigned long below(0);
+			for(unsigned int l(0); l < latencyBuckets; ++l) {
+				below += latency[m][d][l];
+				st << "dym_query_latency_seconds_bucket{" << labels.str() << ",le=\"";
+				if(l + 1 < latencyBuckets) {
+					st << latencyBounds[l] * 1e-9;
+				} else {
+					st << "+Inf";
+				}
+				st << "\"} " << below << '\n';
+			}
+			st << "dym_query_latency_seconds_sum{" << labels.str() << "} " << nanoseconds[m][d] * 1e-9 << '\n';
+			st << "dym_query_latency_seconds_count{" << labels.str() << "} " << n << '\n';
+		}
+	}
+	header(st, "dym_query_results", "histogram", "Suggestions per query, by mode.");
+	for(unsigned int m(0); m < queryModes; ++m) {
+		unsigned long below(0);
+		for(unsigned int r(0); r < resultBuckets; ++r) {
+			below += results[m][r];
+		}
+		if(!below) continue;
+		below = 0;
+		for(unsigned int r(0); r < resultBuckets; ++r) {
+			below += results[m][r];
+			st << "dym_query_results_bucket{mode=\"" << modeNames[m] << "\",le=\"";
+			if(r + 1 < resultBuckets) {
+				st << resultBounds[r];
+			} else {
+				st << "+Inf";
+			}
+			st << "\"} " << below << '\n';
+		}
+		st << "dym_query_results_sum{mode=\"" << modeNames[m] << "\"} " << resultSum[m] << '\n';
+		st << "dym_query_results_count{mode=\"" << modeNames[m] << "\"} " << below << '\n';
+	}
+	header(st, "dym_uptime_seconds", "gauge", "Time since the metrics were created.");
+	const std::chrono::duration<double> uptime(std::chrono::steady_clock::now() - _started);
+	st << "dym_uptime_seconds " << uptime.count() << '\n';
+	for(auto g(_gauges.cbegin()); g != _gauges.cend(); ++g) {
+		if(g == _gauges.cbegin() || (g - 1)->name != g->name) {
+			header(st, g->name, g->counter ? "counter" : "gauge", g->help);
+		}
+		st << g->name;
+		if(!g->labels.empty()) {
+			st << '{' << g->labels << '}';
+		}
+		st << ' ' << g->read() << '\n';
+	}
+	st.precision(oldPrecision);
+} // write
+
+QueryTracer* Metrics::Timer::_sampled(QueryTracer* tracer) {
+	return tracer && tracer->sample() ? tracer : nullptr;
+} // _sampled
+
+Metrics::Timer::Timer(Metrics* metrics, const QueryMode mode, const unsigned int distance, QueryTracer* tracer,
+		      const std::string* line, const unsigned int count)
+	: _metrics(metrics), _tracer(_sampled(tracer)), _line(line), _mode(mode), _distance(distance), _count(count),
+	  _at(_tracer ? _tracer->now() : std::chrono::microseconds(0)),
+	  _start(_metrics || _tracer ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point()),
+	  _results(0), _failed(false) {}
+
+Metrics::Timer::~Timer() {
+	if(!_metrics && !_tracer) {
+		return;
+	}
+	const std::chrono::nanoseconds latency(std::chrono::steady_clock::now() - _start);
+	if(_metrics) {
+		if(_failed) {
+			_metrics->recordError();
+		} else {
+			_metrics->record(_mode, _distance, latency, _results);
+		}
+	}
+// failed queries are traced as well; a replay fails them again
+	if(_tracer) {
+		_tracer->write(TraceRecord{_at, latency, _mode, _distance, _count, _results, _line ? *_line : std::string()});
+	}
+}
+
+MetricsServer::MetricsServer(const Metrics& metrics, const std::string& path)
+	: _metrics(metrics), _path(path), _socket(-1), _stopping(false), _thread() {
+	sockaddr_un address;
+	std::memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	if(path.empty() || path.size() >= sizeof(address.sun_path)) {
+		throw std::runtime_error("Invalid metrics socket '" + path + "'.");
+	}
+	std::memcpy(address.sun_path, path.c_str(), path.size());
+	_socket = socket(AF_UNIX, SOCK_STREAM, 0);
+	if(_socket < 0) {
+		throw std::runtime_error("Could not create the metrics socket: " + std::string(std::strerror(errno)));
+	}
+// a socket file left by an earlier run would make bind fail
+	unlink(path.c_str());
+	if(bind(_socket, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 || listen(_socket, 8) != 0) {
+		const std::string reason(std::strerror(errno));
+		close(_socket);
+		throw std::runtime_error("Could not listen on '" + path + "': " + reason);
+	}
+	_thread = std::thread(&MetricsServer::_serve, this);
+}
+
+MetricsServer::~MetricsServer() {
+	_stopping = true;
+	_thread.join();
+	close(_socket);
+	unlink(_path.c_str());
+}
+
+void MetricsServer::_serve() {
+	pollfd listening{_socket, POLLIN, 0};
+	while(!_stopping) {
+// wake up now and then to see whether the server stops
+		if(poll(&listening, 1, 100) <= 0) {
+			continue;
+		}
+		const int connection(accept(_socket, nullptr, nullptr));
+		if(connection < 0) {
+			continue;
+		}
+// the request is not looked at; every request gets the metrics.
+// Reading what the client sent before closing keeps it from seeing
+// a reset connection
+		pollfd request{connection, POLLIN, 0};
+		char buffer[1024];
+		if(poll(&request, 1, 100) > 0) {
+			recv(connection, buffer, sizeof(buffer), 0);
+		}
+		std::ostringstream body;
+		_metrics.write(body);
+		std::ostringstream response;
+		response << "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: " << body.str().size()
+			 << "\r\n\r\n" << body.str();
+		const std::string r(response.str());
+		for(std::size_t sent(0); sent < r.size();) {
+			const ssize_t n(send(connection, r.data() + sent, r.size() - sent, MSG_NOSIGNAL));
+			if(n <= 0) break;
+			sent += n;
+		}
+		close(connection);
+	} // while
+} // _serve
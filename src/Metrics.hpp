@@ -0,0 +1,205 @@
+/* Metrics.hpp
+   Live statistics of the queries of a long-running process, and a
+   Unix socket that serves them as text.
+*/
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef __METRICS_HPP__
+#define __METRICS_HPP__
+
+class QueryTracer;
+
+//! The kinds of requests that Metrics tells apart.
+enum class QueryMode {
+	all, /*!< All suggestions of a word. */
+	best, /*!< The best suggestion of a word. */
+	complete /*!< Completions of a prefix. */
+};
+//! The number of QueryModes.
+const unsigned int queryModes = 3;
+/*! Metrics keep latencies by the maximum edit distance of a query up
+ *  to this one; higher ones are counted with it. */
+const unsigned int metricsMaxDistance = 9;
+/*! Counters are spread over this many shards; threads beyond it share
+ *  them. */
+const unsigned int metricsShards = 16;
+/*! The upper bounds of the latency histogram, in nanoseconds; the
+ *  last bucket has none. */
+const unsigned long latencyBounds[] = {5000, 10000, 20000, 50000, 100000, 200000, 500000, 1000000, 2000000,
+				       5000000, 10000000, 50000000, 100000000, 1000000000};
+//! The number of buckets of the latency histogram.
+const unsigned int latencyBuckets = sizeof(latencyBounds) / sizeof(latencyBounds[0]) + 1;
+/*! The upper bounds of the histogram of the number of results of a
+ *  query; the last bucket has none. */
+const unsigned long resultBounds[] = {0, 1, 2, 5, 10, 20, 50, 100, 200, 500, 1000};
+//! The number of buckets of the result histogram.
+const unsigned int resultBuckets = sizeof(resultBounds) / sizeof(resultBounds[0]) + 1;
+
+/*! Counts queries, their latencies and their numbers of results.
+
+  Recording is meant for the hot path: every thread adds to counters
+  of its own shard with relaxed atomic operations, so threads do not
+  wait for each other, and the shards are only summed up when the
+  counters are written out. Besides the counters, gauges (values that
+  are read when the metrics are written, like the size of a
+  dictionary) can be added before the metrics are served.
+  The output is the text format of Prometheus.
+*/
+class Metrics {
+private:
+//! The counters of one shard.
+	struct Shard {
+		std::atomic<unsigned long> latency[queryModes][metricsMaxDistance + 1][latencyBuckets]; /*!<
+						Queries by latency bucket. */
+		std::atomic<unsigned long> nanoseconds[queryModes][metricsMaxDistance + 1]; /*!< Summed
+						latencies. */
+		std::atomic<unsigned long> results[queryModes][resultBuckets]; /*!< Queries by
+						result bucket. */
+		std::atomic<unsigned long> resultSum[queryModes]; /*!< Summed results. */
+		std::atomic<unsigned long> errors; /*!< Queries that failed. */
+		char padding[64]; /*!< Keeps the counters of neighbouring
+				    shards off each other's cache lines. */
+	};
+//! A value that is read when the metrics are written.
+	struct Gauge {
+		std::string name; /*!< The metric name. */
+		std::string labels; /*!< Its labels, like
+				      dictionary="default", or empty. */
+		std::string help; /*!< What it means. */
+		bool counter; /*!< Whether the value only grows. */
+		std::function<double()> read; /*!< Gives the value. */
+	};
+
+	std::unique_ptr<Shard[]> _shards; /*!< All counters. */
+	std::vector<Gauge> _gauges; /*!< In the order they were added. */
+	const std::chrono::steady_clock::time_point _started; /*!< For
+								the uptime. */
+//! The shard of the calling thread.
+	Shard& _shard();
+
+public:
+	Metrics(const Metrics&) = delete;
+//! Creates Metrics with all counters at 0.
+	Metrics();
+
+/*! Counts a query; can be called from several threads at once.
+ \param mode The kind of request.
+ \param distance Its maximum edit distance.
+ \param latency The time it took.
+ \param results The number of suggestions it gave.
+*/
+	void record(const QueryMode mode, const unsigned int distance, const std::chrono::nanoseconds latency, const std::size_t results);
+//! Counts a query that failed, like one for an unknown dictionary.
+	void recordError();
+/*! Adds a value to be written with the counters. Gauges must all be
+ *  added before the metrics are written for the first time.
+ \param name The metric name; gauges of the same name must be added
+ one after the other, with different labels.
+ \param labels Labels like dictionary="default", or empty.
+ \param help What the value means.
+ \param counter Whether the value only grows, like a number of
+ lookups.
+ \param read Gives the value; called from the thread that writes the
+ metrics.
+*/
+	void addGauge(const std::string& name, const std::string& labels, const std::string& help, const bool counter,
+		      std::function<double()> read);
+/*! Writes all metrics in the text format of Prometheus; the
+ *  counters of all shards summed up.
+ \param st The stream to write to.
+*/
+	void write(std::ostream& st) const;
+/*! The number of queries counted so far, including failed ones. */
+	unsigned long getQueries() const;
+
+/*! Counts one query when it goes out of scope, from its construction
+ *  on, and writes it to a QueryTracer if that samples it. A Timer
+ *  without Metrics and QueryTracer does nothing. */
+	class Timer {
+	private:
+		Metrics* const _metrics; /*!< Where to count; may be null. */
+		QueryTracer* const _tracer; /*!< Where to write the query
+					      if it is sampled; null if it
+					      is not. */
+		const std::string* const _line; /*!< The input line, for
+						  the tracer. */
+		const QueryMode _mode; /*!< The kind of request. */
+		const unsigned int _distance; /*!< Its maximum edit
+						distance. */
+		const unsigned int _count; /*!< Completions asked for. */
+		const std::chrono::microseconds _at; /*!< When the query came in,
+						 in the time of the
+						 tracer. */
+		const std::chrono::steady_clock::time_point _start; /*!< When
+								      the query
+								      came in. */
+		std::size_t _results; /*!< The number of suggestions. */
+		bool _failed; /*!< Whether the query failed. */
+//! Samples the query and gives the tracer if it is sampled.
+		static QueryTracer* _sampled(QueryTracer* tracer);
+	public:
+		Timer(const Timer&) = delete;
+/*! Starts the clock of a query.
+ \param metrics Where to count the query, or null.
+ \param mode The kind of request.
+ \param distance Its maximum edit distance.
+ \param tracer Where to write the query if it is sampled, or null.
+ \param line The input line of the query, for the tracer; must
+ outlive the Timer.
+ \param count The number of completions asked for; 0 for other
+ modes.
+*/
+		Timer(Metrics* metrics, const QueryMode mode, const unsigned int distance, QueryTracer* tracer = nullptr,
+		      const std::string* line = nullptr, const unsigned int count = 0);
+		~Timer();
+//! Sets the number of suggestions of the query.
+		void results(const std::size_t n) {
+			_results = n;
+		}
+//! Counts the query as failed.
+		void fail() {
+			_failed = true;
+		}
+	}; // Timer
+}; // Metrics
+
+/*! Serves Metrics on a Unix socket.
+
+  A thread accepts connections on the socket and answers each with the
+  metrics as an HTTP response, so that they can be read with
+  \cword curl --unix-socket PATH http://localhost/metrics , or with
+  anything that reads a socket to its end. The socket file is replaced
+  if it exists and removed again when the server stops.
+*/
+class MetricsServer {
+private:
+	const Metrics& _metrics; /*!< What to serve. */
+	const std::string _path; /*!< The socket file. */
+	int _socket; /*!< The listening socket. */
+	std::atomic<bool> _stopping; /*!< Tells the thread to stop. */
+	std::thread _thread; /*!< Accepts connections. */
+//! Accepts and answers connections until the server stops.
+	void _serve();
+
+public:
+	MetricsServer() = delete;
+	MetricsServer(const MetricsServer&) = delete;
+/*! Starts serving; throws std::runtime_error if the socket cannot be
+ *  created.
+ \param metrics The metrics to serve; must outlive the server.
+ \param path The file name of the socket.
+*/
+	MetricsServer(const Metrics& metrics, const std::string& path);
+//! Stops the thread and removes the socket file.
+	~MetricsServer();
+}; // MetricsServer
+
+#endif
@@ -0,0 +1,38 @@
+#include "MissCache.hpp"
+#include <algorithm>
+
+MissCache::MissCache(const std::size_t capacity)
+	: _capacity(capacity), _entries(), _index(), _m(), _lookups(0), _hits(0) {
+	_index.reserve(capacity);
+}
+
+bool MissCache::contains(const std::string& key, const double budget) {
+	++_lookups;
+	std::lock_guard<std::mutex> lock(_m);
+	auto found(_index.find(key));
+	if(found == _index.end() || found->second->second < budget) {
+		return false;
+	}
+	_entries.splice(_entries.begin(), _entries, found->second);
+	++_hits;
+	return true;
+} // contains
+
+void MissCache::insert(const std::string& key, const double budget) {
+	if(_capacity == 0) {
+		return;
+	}
+	std::lock_guard<std::mutex> lock(_m);
+	auto found(_index.find(key));
+	if(found != _index.end()) {
+		found->second->second = std::max(found->second->second, budget);
+		_entries.splice(_entries.begin(), _entries, found->second);
+		return;
+	}
+	if(_entries.size() == _capacity) {
+		_index.erase(_entries.back().first);
+		_entries.pop_back();
+	}
+	_entries.push_front(std::make_pair(key, budget));
+	_index[key] = _entries.begin();
+} // insert
@@ -0,0 +1,75 @@
+/* MissCache.hpp
+   Remembers recent queries that had no suggestions.
+*/
+
+#include <string>
+#include <list>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+
+#ifndef __MISSCACHE_HPP__
+#define __MISSCACHE_HPP__
+
+/*! A bounded cache of queries whose search found nothing.
+
+  Queries without suggestions (ids, garbage, words of another
+  language) are the slowest ones: the search explores everything
+  within the budget before it gives up. Text repeats them, so a Suggest
+  remembers the most recent ones and answers them again without a
+  search. Entries are keys (strings of symbols of an Alphabet) with
+  the highest budget (edit distance or summed cost) that found
+  nothing; a search with a lower budget finds nothing either, so it
+  is a hit as well. When the cache is full, the least recently used
+  entry is dropped.
+  All members can be called from several threads at once.
+*/
+class MissCache {
+private:
+//! An entry: a key and its budget.
+	typedef std::pair<std::string, double> entry_T;
+
+	const std::size_t _capacity; /*!< The most entries. */
+	std::list<entry_T> _entries; /*!< Entries, most recently used
+				       first. */
+	std::unordered_map<std::string, std::list<entry_T>::iterator> _index; /*!<
+						The entry of every key. */
+	mutable std::mutex _m; /*!< Guards _entries and _index. */
+	std::atomic<unsigned long> _lookups; /*!< Calls of contains. */
+	std::atomic<unsigned long> _hits; /*!< Calls of contains that
+					    returned true. */
+
+public:
+	MissCache() = delete;
+	MissCache(const MissCache&) = delete;
+//! Creates an empty cache for at most capacity keys.
+	explicit MissCache(const std::size_t capacity);
+
+/*! Tells whether a search is known to find nothing.
+ \param key The query, as symbols.
+ \param budget The edit distance or cost of the search.
+ \return True if a search for key with at least budget found nothing.
+*/
+	bool contains(const std::string& key, const double budget);
+/*! Remembers a search that found nothing.
+ \param key The query, as symbols.
+ \param budget The edit distance or cost of the search.
+*/
+	void insert(const std::string& key, const double budget);
+
+//! The number of calls of contains.
+	unsigned long getLookups() const {
+		return _lookups;
+	}
+//! The number of calls of contains that were answered from the cache.
+	unsigned long getHits() const {
+		return _hits;
+	}
+//! The number of keys in the cache.
+	std::size_t size() const {
+		std::lock_guard<std::mutex> lock(_m);
+		return _entries.size();
+	}
+}; // MissCache
+
+#endif
@@ -4,6 +4,7 @@
 */
 
 #include "CorpusParser.hpp"
+#include "Utf8.hpp"
 
 #ifndef __PROBABILITYCORPUSPARSER_HPP__
 #define __PROBABILITYCORPUSPARSER_HPP__
@@ -42,7 +43,7 @@ public:
   tracks internally how many lines of input were consumed, to
   produce informative error messages.
   Lines are of the form .+'TAB'('-' | [0-9]+)'.'[0-9]+ where . is any
-  alphanumeric character.  
+  letter or combining mark (see Utf8::isLetter), encoded in UTF-8.
   This function will happily throw when an invalid string is passed to
   it. The type of exception is \cword ParseError .
   The return type is a pair, intended to be used in Tri<double>::insert
@@ -50,8 +51,6 @@ public:
   \param line One line of input from a corpus file.
   \return A pair consisting of the word and its probability annotation
   value.
-
-  \todo This cannot deal with unicode :(
 */
 	const std::pair<const std::string, const double> parseLine(const std::string& line) {
 		++_data.linesConsumed;
@@ -84,16 +83,20 @@ public:
 		for(; i != line.cend(); ++i) {
 			switch(state) {
 			case wordParse:
-				if(isalpha(*i)) {
-					break; /// \todo this case can
-					       /// be subsumed
-				} else if(*i == (char)9) {
+				if(*i == (char)9) {
 // we encountered a tab character
 					wordEnd = i;
 					doubleStart = i + 1;
 					state = doubleParse;
 				} else {
-					_data.parseError("Encountered unexpected '" + std::string(i, i) + "' while trying to parse a word.");
+// words are letters and combining marks in UTF-8; skip the rest of a
+// multi-byte code point
+					std::string::const_iterator next(i);
+					char32_t c;
+					if(!Utf8::next(next, line.cend(), c) || !(Utf8::isLetter(c) || Utf8::isMark(c))) {
+						_data.parseError("Encountered unexpected '" + std::string(i, next) + "' while trying to parse a word.");
+					}
+					i = next - 1;
 				} // else
 				break; // wordParse
 			case doubleParse:
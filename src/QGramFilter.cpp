@@ -0,0 +1,101 @@
+#include "QGramFilter.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+//! Mixes the bits of a q-gram (the finalizer of splitmix64).
+std::uint64_t mix(std::uint64_t x) {
+	x ^= x >> 30;
+	x *= 0xbf58476d1ce4e5b9ull;
+	x ^= x >> 27;
+	x *= 0x94d049bb133111ebull;
+	x ^= x >> 31;
+	return x;
+}
+} // namespace
+
+QGramFilter::QGramFilter(const unsigned int q)
+	: _q(q), _grams(), _bits(), _mask(0), _checks(0), _rejections(0) {
+	if(q < 1 || q > 7) {
+		throw std::runtime_error("error in QGramFilter: q must be between 1 and 7.");
+	}
+}
+
+/*! Every symbol takes 9 bits of the number: the symbol plus one, or 0
+ *  for the padding at the boundaries, which is no symbol.
+ \param key A string of symbols.
+ \param f Called with every packed q-gram, from left to right.
+*/
+template <typename f_T>
+void QGramFilter::_forEachGram(const std::string& key, f_T f) const {
+	const std::uint64_t keep((std::uint64_t(1) << (9 * _q)) - 1);
+	std::uint64_t gram(0);
+	for(std::size_t i(0); i < key.size() + _q - 1; ++i) {
+		const std::uint64_t symbol(i < key.size() ? (unsigned char)key[i] + 1 : 0);
+		gram = ((gram << 9) | symbol) & keep;
+// the first q - 1 grams start with padding, which is already 0
+		f(gram);
+	}
+} // _forEachGram
+
+void QGramFilter::add(const std::string& key) {
+	_forEachGram(key, [this](const std::uint64_t gram) { _grams.push_back(gram); });
+// duplicates are removed now and then, so that the buffer stays
+// about as large as the set of distinct q-grams
+	if(_grams.size() >= 1u << 20 && _grams.size() == _grams.capacity()) {
+		std::sort(_grams.begin(), _grams.end());
+		_grams.erase(std::unique(_grams.begin(), _grams.end()), _grams.end());
+	}
+} // add
+
+void QGramFilter::seal() {
+	std::sort(_grams.begin(), _grams.end());
+	_grams.erase(std::unique(_grams.begin(), _grams.end()), _grams.end());
+	std::uint64_t bits(64);
+	while(bits < _grams.size() * qgramBitsPerGram) {
+		bits *= 2;
+	}
+	_bits.assign(bits / 64, 0);
+	_mask = bits - 1;
+	for(auto g(_grams.cbegin()); g != _grams.cend(); ++g) {
+		const std::uint64_t h(mix(*g));
+// double hashing: the i-th hash is h1 + i * h2
+		const std::uint64_t h1(h), h2((h >> 32) | 1);
+		for(unsigned int i(0); i < qgramHashes; ++i) {
+			const std::uint64_t bit((h1 + i * h2) & _mask);
+			_bits[bit / 64] |= std::uint64_t(1) << (bit % 64);
+		}
+	}
+	std::vector<std::uint64_t>().swap(_grams);
+} // seal
+
+bool QGramFilter::mayMatch(const std::string& key, const unsigned int editDistance) const {
+	++_checks;
+	const long grams(key.size() + _q - 1);
+	const long needed(grams - long(editDistance) * (_q + 1));
+	if(needed <= 0 || _bits.empty()) {
+		return true;
+	}
+	long found(0), left(grams);
+	bool enough(false);
+	_forEachGram(key, [&](const std::uint64_t gram) {
+			if(enough || found + left < needed) {
+				--left;
+				return;
+			}
+			--left;
+			const std::uint64_t h(mix(gram));
+			const std::uint64_t h1(h), h2((h >> 32) | 1);
+			for(unsigned int i(0); i < qgramHashes; ++i) {
+				const std::uint64_t bit((h1 + i * h2) & _mask);
+				if(!(_bits[bit / 64] & (std::uint64_t(1) << (bit % 64)))) {
+					return;
+				}
+			}
+			enough = ++found >= needed;
+		});
+	if(!enough) {
+		++_rejections;
+	}
+	return enough;
+} // mayMatch
@@ -0,0 +1,99 @@
+/* QGramFilter.hpp
+   A Bloom filter over the q-grams of a dictionary, to reject queries
+   that no key is close to before searching.
+*/
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <cstdint>
+
+#ifndef __QGRAMFILTER_HPP__
+#define __QGRAMFILTER_HPP__
+
+/*! Bits of the filter per distinct q-gram of the dictionary; with
+ *  qgramHashes hash functions, about 0.2% of the absent q-grams are
+ *  reported as present. */
+const unsigned int qgramBitsPerGram = 16;
+//! Hash functions of the filter.
+const unsigned int qgramHashes = 4;
+//! The default q.
+const unsigned int defaultQ = 3;
+
+/*! Tells that no key of a dictionary can be within an edit distance of
+ *  a query, without searching the dictionary.
+
+  The q-grams of a word are its substrings of length q, after padding
+  it with q - 1 boundary symbols on both sides, so a word of length n
+  has n + q - 1 of them. One substitution, insertion or deletion
+  changes at most q of the q-grams of a word, one transposition of
+  adjacent characters at most q + 1. So if a key is within k edits of
+  a query, at least n + q - 1 - k * (q + 1) q-grams of the query are
+  q-grams of that key (the q-gram lemma), and in particular q-grams of
+  some key of the dictionary.
+
+  The filter is a Bloom filter of all q-grams of all keys. A query
+  whose q-grams are found in it less often than that bound has no key
+  within k edits, and its search would find nothing; since a Bloom
+  filter has no false negatives, it never rejects a query that has
+  results. The test costs n + q - 1 hash lookups, while a search for
+  a query without results has to explore everything within the
+  budget. Short queries and high edit distances make the bound zero
+  or negative and are never rejected.
+
+  Keys and queries are strings of symbols of an Alphabet ; q is at
+  most 7.
+*/
+class QGramFilter {
+private:
+	const unsigned int _q; /*!< Length of the q-grams. */
+	std::vector<std::uint64_t> _grams; /*!< The q-grams added so far;
+					     emptied by seal. */
+	std::vector<std::uint64_t> _bits; /*!< The Bloom filter. */
+	std::uint64_t _mask; /*!< The number of bits of the filter minus
+			       one; the number is a power of two. */
+	mutable std::atomic<unsigned long> _checks; /*!< Calls of
+						      mayMatch . */
+	mutable std::atomic<unsigned long> _rejections; /*!< Calls of
+							  mayMatch that
+							  returned
+							  false. */
+
+//! Calls f with every q-gram of a key, packed into a number.
+	template <typename f_T>
+	void _forEachGram(const std::string& key, f_T f) const;
+
+public:
+	QGramFilter() = delete;
+	QGramFilter(const QGramFilter&) = delete;
+//! Creates an empty filter for q-grams of length q.
+	explicit QGramFilter(const unsigned int q = defaultQ);
+
+//! Adds the q-grams of a key; only allowed before seal.
+	void add(const std::string& key);
+//! Builds the Bloom filter from the added q-grams.
+	void seal();
+
+/*! Tells whether any key can be within an edit distance of a query.
+ \param key The query, as symbols.
+ \param editDistance The maximum number of edit operations.
+ \return False if no key added to the filter is within editDistance
+ of key.
+*/
+	bool mayMatch(const std::string& key, const unsigned int editDistance) const;
+
+//! The number of calls of mayMatch.
+	unsigned long getChecks() const {
+		return _checks;
+	}
+//! The number of queries mayMatch rejected.
+	unsigned long getRejections() const {
+		return _rejections;
+	}
+//! The memory of the Bloom filter in bytes.
+	std::size_t getBytes() const {
+		return _bits.size() * sizeof(std::uint64_t);
+	}
+}; // QGramFilter
+
+#endif
@@ -0,0 +1,96 @@
+#include "QueryTracer.hpp"
+#include <stdexcept>
+#include <algorithm>
+
+//! The first bytes of a trace file.
+static const char traceMagic[8] = {'d', 'y', 'm', 't', 'r', 'a', 'c', '1'};
+
+/*! Appends an unsigned LEB128 number to a buffer.
+ \param buffer The buffer.
+ \param n The number.
+*/
+static void appendNumber(std::string& buffer, unsigned long n) {
+	for(; n >= 0x80; n >>= 7) {
+		buffer.push_back(char(0x80 | (n & 0x7f)));
+	}
+	buffer.push_back(char(n));
+} // appendNumber
+
+QueryTracer::QueryTracer(const std::string& filename, const unsigned long every)
+	: _out(filename, std::ios::binary | std::ios::trunc), _every(every ? every : 1), _seen(0), _written(0),
+	  _started(std::chrono::steady_clock::now()), _last(0), _m() {
+	if(!_out.is_open()) {
+		throw std::runtime_error("Could not write the trace '" + filename + "'.");
+	}
+	_out.write(traceMagic, sizeof(traceMagic));
+}
+
+void QueryTracer::write(const TraceRecord& record) {
+	std::string buffer;
+	buffer.reserve(24 + record.line.size());
+	std::lock_guard<std::mutex> lock(_m);
+// threads that took their time before writing may be a little late;
+// their records get the time of the one before
+	const std::chrono::microseconds at(std::max(record.at, _last));
+	appendNumber(buffer, (at - _last).count());
+	appendNumber(buffer, record.latency.count() > 0 ? record.latency.count() : 0);
+	appendNumber(buffer, static_cast<unsigned long>(record.mode));
+	appendNumber(buffer, record.distance);
+	appendNumber(buffer, record.count);
+	appendNumber(buffer, record.results);
+	appendNumber(buffer, record.line.size());
+	buffer += record.line;
+	_out.write(buffer.data(), buffer.size());
+	_last = at;
+	++_written;
+} // write
+
+TraceReader::TraceReader(const std::string& filename)
+	: _in(filename, std::ios::binary), _last(0) {
+	if(!_in.is_open()) {
+		throw std::runtime_error("Could not open the trace '" + filename + "'.");
+	}
+	char magic[sizeof(traceMagic)];
+	if(!_in.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), traceMagic)) {
+		throw std::runtime_error("'" + filename + "' is not a trace.");
+	}
+}
+
+unsigned long TraceReader::_number() {
+	unsigned long n(0);
+	for(unsigned int shift(0);; shift += 7) {
+		const int c(_in.get());
+		if(c == std::char_traits<char>::eof()) {
+			throw std::runtime_error("The trace ends in a record.");
+		}
+		if(shift > 63) {
+			throw std::runtime_error("The trace holds a number that is too large.");
+		}
+		n |= (unsigned long)(c & 0x7f) << shift;
+		if(!(c & 0x80)) {
+			return n;
+		}
+	}
+} // _number
+
+bool TraceReader::next(TraceRecord& record) {
+	if(_in.peek() == std::char_traits<char>::eof()) {
+		return false;
+	}
+	_last += std::chrono::microseconds(_number());
+	record.at = _last;
+	record.latency = std::chrono::nanoseconds(_number());
+	const unsigned long mode(_number());
+	if(mode >= queryModes) {
+		throw std::runtime_error("The trace holds an unknown mode.");
+	}
+	record.mode = static_cast<QueryMode>(mode);
+	record.distance = _number();
+	record.count = _number();
+	record.results = _number();
+	record.line.resize(_number());
+	if(!_in.read(&record.line[0], record.line.size())) {
+		throw std::runtime_error("The trace ends in a record.");
+	}
+	return true;
+} // next
@@ -0,0 +1,113 @@
+/* QueryTracer.hpp
+   A compact binary log of sampled queries, to replay a real workload
+   later.
+*/
+
+#include "Metrics.hpp"
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <string>
+
+#ifndef __QUERYTRACER_HPP__
+#define __QUERYTRACER_HPP__
+
+//! One query of a trace.
+struct TraceRecord {
+	std::chrono::microseconds at; /*!< When the query came in, from
+					the start of the trace. */
+	std::chrono::nanoseconds latency; /*!< The time it took. */
+	QueryMode mode; /*!< The kind of request. */
+	unsigned int distance; /*!< Its maximum edit distance. */
+	unsigned int count; /*!< The number of completions asked for;
+			      0 for other modes. */
+	unsigned long results; /*!< The number of suggestions given. */
+	std::string line; /*!< The input line, with its dictionary
+			    selection. */
+};
+
+/*! Writes a sample of the queries of a process to a trace file.
+
+  Every n-th query is sampled, counting from the first one. A trace
+  file starts with the 8 bytes "dymtrac1"; every record after them
+  is: the microseconds since the record before (or since the start of
+  the trace), the latency in nanoseconds, the mode, the edit distance,
+  the number of completions, the number of results and the length of
+  the line, as unsigned LEB128 numbers (7 bits per byte, the lowest
+  first, the high bit set on all bytes but the last), followed by the
+  bytes of the line. A typical record takes 10 to 20 bytes.
+  The file is written through a buffer; records that are still in it
+  when the process is killed are lost.
+  All members can be called from several threads at once.
+*/
+class QueryTracer {
+private:
+	std::ofstream _out; /*!< The trace file. */
+	const unsigned long _every; /*!< Sample every this-many
+				      queries. */
+	std::atomic<unsigned long> _seen; /*!< Queries that came in. */
+	std::atomic<unsigned long> _written; /*!< Records written. */
+	const std::chrono::steady_clock::time_point _started; /*!< The
+								start of
+								the trace. */
+	std::chrono::microseconds _last; /*!< The time of the record
+					   written last. */
+	std::mutex _m; /*!< Guards _out and _last. */
+
+public:
+	QueryTracer() = delete;
+	QueryTracer(const QueryTracer&) = delete;
+/*! Creates a trace file, replacing one that exists; throws
+ *  std::runtime_error if it cannot be written.
+ \param filename The trace file.
+ \param every Sample every this-many queries; 1 for all of them.
+*/
+	QueryTracer(const std::string& filename, const unsigned long every);
+/*! Tells whether the next query is sampled; called once per query.
+ *  Cheap enough to be called for queries that are not. */
+	bool sample() {
+		return _seen.fetch_add(1, std::memory_order_relaxed) % _every == 0;
+	}
+//! The time since the start of the trace.
+	std::chrono::microseconds now() const {
+		return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - _started);
+	}
+/*! Writes a sampled query.
+ \param record The query; records must be written in the order of
+ their times.
+*/
+	void write(const TraceRecord& record);
+//! The number of queries written.
+	unsigned long getWritten() const {
+		return _written;
+	}
+}; // QueryTracer
+
+/*! Reads the records of a trace file, see QueryTracer , in order. */
+class TraceReader {
+private:
+	std::ifstream _in; /*!< The trace file. */
+	std::chrono::microseconds _last; /*!< The time of the record read
+					   last. */
+/*! Reads an unsigned LEB128 number; throws std::runtime_error if the
+ *  file ends in it or it does not fit. */
+	unsigned long _number();
+
+public:
+	TraceReader() = delete;
+	TraceReader(const TraceReader&) = delete;
+/*! Opens a trace file; throws std::runtime_error if it cannot be read
+ *  or is not a trace.
+ \param filename The trace file.
+*/
+	explicit TraceReader(const std::string& filename);
+/*! Reads the next record; throws std::runtime_error if the file ends
+ *  in it.
+ \param record Set to the record.
+ \return False at the end of the file.
+*/
+	bool next(TraceRecord& record);
+}; // TraceReader
+
+#endif
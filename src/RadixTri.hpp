@@ -0,0 +1,119 @@
+/* RadixTri.hpp
+   Path-compressed, read-only variant of the Tri.
+*/
+
+#include "Tri.hpp"
+#include <string>
+#include <vector>
+
+#ifndef __RADIXTRI_HPP__
+#define __RADIXTRI_HPP__
+
+/*! A Tri in which chains of States with a single child are merged into
+ *  one edge.
+
+  Most States deep in a Tri have exactly one transition: once a prefix
+  is long enough, only one word continues it. A CorrectionSearcher
+  still creates, pushes and pops search items for every character of
+  such a chain. A RadixTri stores every chain as one edge, labelled
+  with the characters of the chain; all labels are kept in one shared
+  string, the label pool, and an edge only knows the offset and length
+  of its label. Nodes are the States of the Tri that branch or end a
+  key, so there are far fewer of them, and the edges of a node are
+  stored next to each other, in depth-first order of the nodes.
+
+  A RadixTri is built from a finished Tri and cannot be changed.
+  tolerantFind finds the same keys with the same edit distances as
+  Tri::tolerantFind , but does not work with search items per
+  character. It keeps one row of the edit distance matrix between the
+  query and the current prefix for every character of that prefix,
+  and computes the rows of a whole edge label in a tight loop; it
+  only pushes items for the edges of nodes. Rows are computed only in
+  the band of columns that can stay within the edit budget. An edge is
+  not pushed if, from every column of the current row, the length or
+  the letter set of the keys below it is too far from the rest of the
+  query, and a branch is abandoned as soon as every entry of its
+  latest row exceeds the edit budget.
+  \sa Tri
+*/
+template <class value_T>
+class RadixTri {
+private:
+	typedef unsigned int node_T; /*!< The type of node names. */
+
+//! An edge from a node to a child node.
+	struct Edge {
+		unsigned int labelOffset; /*!< Start of the label in the
+					    label pool. */
+		unsigned int labelLength; /*!< Number of characters of the
+					    label; at least 1. */
+		node_T target; /*!< The node the edge leads to. */
+		letterMask_T letters; /*!< Characters of the label and of
+					every key suffix below the
+					target. */
+	};
+//! A node: a State of the Tri that branches, ends a key or is the root.
+	struct Node {
+		bool endState; /*!< Whether a key ends here. */
+		unsigned int value; /*!< Index of the value of that key in
+				      the value array; the same as its
+				      index in the Tri. */
+		unsigned int firstEdge; /*!< Index of the first edge of
+					  this node in the edge
+					  vector. */
+		unsigned int edgeCount; /*!< Number of edges of this node. */
+		unsigned int minDepth; /*!< Length of the shortest key
+					 suffix below this node. */
+		unsigned int maxDepth; /*!< Length of the longest key
+					 suffix below this node. */
+	};
+
+	std::vector<Node> _nodes; /*!< The nodes; the root is 0. */
+	std::vector<Edge> _edges; /*!< The edges, grouped by node and
+				    sorted by their first character. */
+	std::string _labels; /*!< The label pool. */
+	std::vector<value_T> _values; /*!< Values of the keys ending in a
+					node, in the order of their index in
+					the Tri. */
+
+public:
+//! The search results, the same as for a Tri.
+	typedef typename Tri<value_T>::TolerantResult TolerantResult;
+
+	RadixTri() = delete;
+	RadixTri(const RadixTri&) = delete;
+/*! Builds a RadixTri with the keys and values of a Tri.
+  \param tri The Tri to compress; it is not changed.
+*/
+	explicit RadixTri(const Tri<value_T>& tri);
+
+/*! Error-tolerant retrieval of key/value data.
+  \param key A possibly misspelled string for which corrections will be
+  searched.
+  \param editDistance The maximum amount of edit-operations to perform
+  during the search.
+  \param stats If not null, the counts of the search are added to it:
+  itemsExpanded and itemsPushed count edges, prunedLength the
+  branches that were abandoned.
+  \return A vector of TolerantResults, as returned by
+  Tri::tolerantFind ; not sorted.
+*/
+	std::vector<TolerantResult> tolerantFind(const std::string& key, const unsigned int editDistance, SearchStats* stats = nullptr) const;
+
+//! The number of nodes.
+	unsigned int getNodes() const {
+		return _nodes.size();
+	}
+//! The number of edges.
+	unsigned int getEdges() const {
+		return _edges.size();
+	}
+//! The number of characters in the label pool.
+	unsigned int getLabelLength() const {
+		return _labels.size();
+	}
+}; // RadixTri
+
+#include "RadixTri.tpp.hpp"
+
+#endif
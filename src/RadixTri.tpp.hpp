@@ -0,0 +1,186 @@
+
+template <class value_T>
+RadixTri<value_T>::RadixTri(const Tri<value_T>& tri)
+	: _nodes(), _edges(), _labels(), _values(tri.getKeys()) {
+	typedef typename Tri<value_T>::State state_T;
+// pairs of a Tri state that becomes a node and the edge leading to
+// it; nodes are named in depth-first order, so that a subtree is a
+// contiguous range of nodes
+	std::vector<std::pair<unsigned int, unsigned int>> stack;
+	stack.push_back(std::make_pair(0u, ~0u));
+	while(!stack.empty()) {
+		const unsigned int state(stack.back().first), edge(stack.back().second);
+		stack.pop_back();
+		const state_T& s(tri._v[state]);
+		const node_T name(_nodes.size());
+		if(edge != ~0u) {
+			_edges[edge].target = name;
+		}
+		const Node node = {s.endState, s.value, (unsigned int)_edges.size(),
+				   (unsigned int)s.transitions.size(), s.minDepth, s.maxDepth};
+		_nodes.push_back(node);
+		if(s.endState) {
+			_values[s.value] = tri._value(state);
+		}
+// the edges of a node are created together; each follows its chain of
+// single-child, non-final states
+		for(auto t(s.transitions.cbegin()); t != s.transitions.cend(); ++t) {
+			Edge e = {(unsigned int)_labels.size(), 1, 0, letterBit(t->first)};
+			_labels.push_back(t->first);
+			unsigned int next(t->second);
+			while(!tri._v[next].endState && tri._v[next].transitions.size() == 1) {
+				_labels.push_back(tri._v[next].transitions.cbegin()->first);
+				e.letters |= letterBit(_labels.back());
+				next = tri._v[next].transitions.cbegin()->second;
+				++e.labelLength;
+			}
+			e.letters |= tri._v[next].letters;
+			_edges.push_back(e);
+		} // for
+// push in reverse, so that children are named in the order of their
+// characters
+		unsigned int e(_edges.size());
+		for(auto t(s.transitions.crbegin()); t != s.transitions.crend(); ++t) {
+			--e;
+			unsigned int next(t->second);
+			while(!tri._v[next].endState && tri._v[next].transitions.size() == 1) {
+				next = tri._v[next].transitions.cbegin()->second;
+			}
+			stack.push_back(std::make_pair(next, e));
+		}
+	} // while
+} // RadixTri ctor
+
+/*! The search is a depth-first walk over the edges. Row i of the
+ *  matrix holds the edit distances between the first i characters of
+ *  the current candidate and every prefix of the key; rows are kept
+ *  for the whole candidate, so a popped edge only needs to truncate
+ *  the candidate to the depth of its node and continue from the row
+ *  there. Edit distance is the optimal string alignment distance, as
+ *  in CorrectionSearcher: substitutions, insertions, deletions and
+ *  transpositions of adjacent characters, each character edited at
+ *  most once.
+ *  Entries of row i outside the columns i - editDistance to
+ *  i + editDistance are always above the budget; they are not computed,
+ *  and the columns just outside the band hold editDistance + 1.
+*/
+template <class value_T>
+std::vector<typename RadixTri<value_T>::TolerantResult> RadixTri<value_T>::tolerantFind(const std::string& key, const unsigned int editDistance, SearchStats* stats) const {
+	std::vector<TolerantResult> results;
+	SearchStats counts;
+	const unsigned int n(key.size());
+	const unsigned int width(n + 2);
+	const unsigned int k(editDistance);
+	const unsigned int over(k + 1);
+// one row per character of the longest key, plus the empty prefix
+	std::vector<unsigned int> rows((_nodes[0].maxDepth + 1) * width, over);
+	for(unsigned int j(0); j <= std::min(n, k); ++j) {
+		rows[j] = j;
+	}
+	std::string candidate;
+	candidate.reserve(_nodes[0].maxDepth);
+	std::vector<unsigned int> missing(n + 1);
+
+// tells whether any key below an edge can be within the budget: from
+// some column j of the row at depth, the rest of the key must become
+// a suffix with a length between minimum and maximum, and every
+// character of the rest that does not occur below the edge needs an
+// edit of its own; the first character of the rest may instead be
+// transposed with the last character of the candidate
+	auto viable = [&](const Edge& edge, const unsigned int depth) -> bool {
+		const Node& target(_nodes[edge.target]);
+		const unsigned int minimum(target.minDepth + edge.labelLength), maximum(target.maxDepth + edge.labelLength);
+		const unsigned int* row(&rows[depth * width]);
+		const unsigned int lo(depth > k ? depth - k : 0), hi(std::min(n, depth + k));
+		bool counted(false);
+		for(unsigned int j(lo); j <= hi; ++j) {
+			const unsigned int rest(n - j);
+			const unsigned int gap(rest < minimum ? minimum - rest : rest > maximum ? rest - maximum : 0);
+			if(row[j] + gap > k) {
+				continue;
+			}
+// the letters are only counted once the cheaper length test passes
+			if(!counted) {
+				missing[n] = 0;
+				for(unsigned int m(n); m > lo; --m) {
+					missing[m - 1] = missing[m] + ((edge.letters & letterBit(key[m - 1])) ? 0 : 1);
+				}
+				counted = true;
+			}
+			unsigned int absent(missing[j]);
+			if(j < n && depth > 0 && !(edge.letters & letterBit(key[j])) && key[j] == candidate[depth - 1]) {
+				--absent;
+			}
+			if(row[j] + std::max(gap, absent) <= k) {
+				return true;
+			}
+		}
+		return false;
+	};
+	auto visit = [&](const node_T name) {
+		const unsigned int depth(candidate.size());
+		if(_nodes[name].endState && n <= depth + k && rows[depth * width + n] <= k) {
+			results.push_back(TolerantResult(candidate, _values[_nodes[name].value], rows[depth * width + n]));
+			results.back().index = _nodes[name].value;
+		}
+	};
+
+// items are edges and the depth of the node they start from
+	std::vector<std::pair<unsigned int, unsigned int>> stack;
+	auto pushEdges = [&](const node_T name) {
+		const Node& node(_nodes[name]);
+		const unsigned int depth(candidate.size());
+		for(unsigned int e(node.firstEdge + node.edgeCount); e > node.firstEdge; --e) {
+			if(viable(_edges[e - 1], depth)) {
+				stack.push_back(std::make_pair(e - 1, depth));
+				++counts.itemsPushed;
+			} else {
+				++counts.prunedLength;
+			}
+		}
+	};
+	visit(0);
+	pushEdges(0);
+	while(!stack.empty()) {
+		const Edge& edge(_edges[stack.back().first]);
+		candidate.resize(stack.back().second);
+		stack.pop_back();
+		++counts.itemsExpanded;
+		bool alive(true);
+		for(unsigned int l(0); l < edge.labelLength && alive; ++l) {
+			const char c(_labels[edge.labelOffset + l]);
+			candidate.push_back(c);
+			const unsigned int i(candidate.size());
+			const unsigned int lo(i > k ? i - k : 1), hi(std::min(n, i + k));
+			const unsigned int* above(&rows[(i - 1) * width]);
+			const unsigned int* aboveAbove(i > 1 ? &rows[(i - 2) * width] : nullptr);
+			unsigned int* row(&rows[i * width]);
+			row[0] = std::min(i, over);
+			row[lo - 1] = lo > 1 ? over : row[0];
+			row[hi + 1] = over;
+			unsigned int best(row[0]);
+			for(unsigned int j(lo); j <= hi; ++j) {
+				unsigned int d(std::min(above[j], row[j - 1]) + 1);
+				d = std::min(d, above[j - 1] + (key[j - 1] == c ? 0 : 1));
+				if(aboveAbove && j > 1 && key[j - 1] == candidate[i - 2] && key[j - 2] == c) {
+					d = std::min(d, aboveAbove[j - 2] + 1);
+				}
+				row[j] = std::min(d, over);
+				best = std::min(best, row[j]);
+			}
+// no later row can get below the minimum of this one, not even by a
+// transposition from the row before
+			alive = best <= k;
+		} // for label
+		if(!alive) {
+			++counts.prunedLength;
+			continue;
+		}
+		visit(edge.target);
+		pushEdges(edge.target);
+	} // while
+	if(stats) {
+		*stats += counts;
+	}
+	return results;
+} // tolerantFind
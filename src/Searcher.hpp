@@ -6,11 +6,179 @@
 #include <vector>
 #include <stack>
 #include <memory>
+#include <chrono>
 
 
 #ifndef __SEARCHER_HPP__
 #define __SEARCHER_HPP__
 
+/*! A compact set of characters. Every character is mapped to one of
+ *  64 bits, so letters (both cases) get a bit of their own and other
+ *  characters may share one. This is fine for pruning, since a set
+ *  built like this can only be too large, never too small.
+ */
+typedef unsigned long long letterMask_T;
+
+//! Gives the bit of a character in a letterMask_T.
+inline letterMask_T letterBit(const unsigned char c) {
+	return letterMask_T(1) << (c & 63);
+}
+
+//! Data of one search-result, see Searcher::result_type .
+struct SearchHit {
+	unsigned int state; /*!< The number of the state the key was
+			      found in. */
+	unsigned int editDistance; /*!< The amount of edit operations
+				     needed to find the key. */
+	double cost; /*!< The summed cost of those edit operations;
+		       equal to editDistance for searchers with unit
+		       costs. */
+};
+
+/*! The results of a search: one SearchHit per end state.
+
+  Hits are kept in the order they were found, and an open addressing
+  table of their positions finds the hit of a state. clear keeps the
+  memory of both, so a searcher that is reused for many searches stops
+  allocating once its results have grown to the size of a search.
+*/
+class SearchResults {
+private:
+	std::vector<SearchHit> _hits; /*!< The hits, in the order they
+					were found. */
+	std::vector<unsigned int> _slots; /*!< Positions in _hits plus
+					    one, by hashed state; 0 is
+					    free. Its size is a power of
+					    two and at least twice that of
+					    _hits. */
+/*! Finds the slot of a state: the one holding its hit, or the free
+ *  one where it would go. */
+	std::size_t _slot(const unsigned int state) const {
+		const std::size_t mask(_slots.size() - 1);
+		for(std::size_t i((state * 2654435761u) & mask);; i = (i + 1) & mask) {
+			if(_slots[i] == 0 || _hits[_slots[i] - 1].state == state) {
+				return i;
+			}
+		}
+	}
+public:
+	typedef std::vector<SearchHit>::const_iterator const_iterator;
+	SearchResults() : _hits(), _slots(16, 0) {}
+/*! Finds the hit of a state.
+  \param state An end state.
+  \return The hit, or null if the state was not found yet.
+*/
+	SearchHit* find(const unsigned int state) {
+		const unsigned int position(_slots[_slot(state)]);
+		return position ? &_hits[position - 1] : nullptr;
+	}
+/*! Adds the hit of a state that was not found yet.
+  \param hit The hit.
+*/
+	void insert(const SearchHit& hit) {
+		if(2 * (_hits.size() + 1) > _slots.size()) {
+			std::vector<unsigned int>(2 * _slots.size(), 0).swap(_slots);
+			for(std::size_t h(0); h < _hits.size(); ++h) {
+				_slots[_slot(_hits[h].state)] = h + 1;
+			}
+		}
+		_hits.push_back(hit);
+		_slots[_slot(hit.state)] = _hits.size();
+	}
+/*! Forgets all hits, keeping the memory. Taking the hits out in the
+ *  reverse order of their insertion leaves every probe sequence as
+ *  it was before, so only their own slots have to be cleared. */
+	void clear() {
+		for(auto h(_hits.crbegin()); h != _hits.crend(); ++h) {
+			_slots[_slot(h->state)] = 0;
+		}
+		_hits.clear();
+	}
+	std::size_t size() const {
+		return _hits.size();
+	}
+	bool empty() const {
+		return _hits.empty();
+	}
+	const_iterator cbegin() const {
+		return _hits.cbegin();
+	}
+	const_iterator cend() const {
+		return _hits.cend();
+	}
+}; // SearchResults
+
+/*! Counters that searchers keep during a search.
+
+  These are meant for instrumentation and benchmarking; they tell how
+  much of the Tri a search had to look at and how much of it could be
+  skipped.
+*/
+struct SearchStats {
+	unsigned long itemsExpanded; /*!< Items that were taken off the
+				      stack and examined. */
+	unsigned long itemsPushed; /*!< Items that were put on the
+				    stack. */
+	unsigned long prunedLength; /*!< Items that were never put on
+				     the stack, because no key below
+				     their state has a length within the
+				     remaining edit budget. */
+	unsigned long prunedLetters; /*!< Items that were never put on
+				      the stack, because too many of the
+				      remaining input characters do not
+				      occur below their state. */
+	unsigned long prunedPrefix; /*!< Items that were never put on
+				     the stack, because they used more
+				     edits on a restricted prefix of the
+				     input than allowed. */
+	SearchStats() : itemsExpanded(0), itemsPushed(0), prunedLength(0), prunedLetters(0), prunedPrefix(0) {}
+//! Adds the counts of another search.
+	SearchStats& operator+=(const SearchStats& other) {
+		itemsExpanded += other.itemsExpanded;
+		itemsPushed += other.itemsPushed;
+		prunedLength += other.prunedLength;
+		prunedLetters += other.prunedLetters;
+		prunedPrefix += other.prunedPrefix;
+		return *this;
+	}
+};
+
+//! Search items expanded between two reads of the clock.
+const unsigned int budgetClockInterval = 16;
+
+/*! Limits of a single search, see Tri::tolerantFindWithin .
+
+  A budget caps the number of search items expanded, the time spent,
+  or both; the clock is only read every budgetClockInterval items.
+  When a search runs out of budget, it stops and sets exhausted; its
+  results are then incomplete, but every key with fewer than
+  completeBelow edit operations was found. A budget can be handed to
+  several searches for the same query (e.g. in several dictionaries);
+  the time limit is shared, the item limit applies to each search.
+*/
+struct SearchBudget {
+	unsigned long maxItems; /*!< The most items a search may expand;
+				  0 for no limit. */
+	std::chrono::steady_clock::time_point deadline; /*!< When
+							  searches have to
+							  stop. */
+	bool exhausted; /*!< Set when a search stopped because the
+			  budget ran out; never cleared by searches. */
+	unsigned int completeBelow; /*!< Lowest edit distance below which
+				      the results of an exhausted search
+				      may be missing keys; set with
+				      exhausted. */
+/*! Creates a budget for a query.
+  \param items The most items to expand per search, or 0.
+  \param timeout The time from now on that the searches may take,
+  or 0 for no limit.
+*/
+	explicit SearchBudget(const unsigned long items = 0, const std::chrono::microseconds timeout = std::chrono::microseconds(0))
+		: maxItems(items),
+		  deadline(timeout.count() > 0 ? std::chrono::steady_clock::now() + timeout : std::chrono::steady_clock::time_point::max()),
+		  exhausted(false), completeBelow(~0u) {}
+};
+
 /*! Interface for modular beam-search in Tris
  *
  * This class provides an abstract interface to different kinds of
@@ -42,13 +210,22 @@ public:
 	struct item {
 		typedef typename derived_T::template item<state_T> type;
 	};
+//! Wrapper for the type of the search stack of the child class.
+/*! Items are kept on the stack by value, in a vector, so a stack
+  that is reused for many searches stops allocating once it has grown
+  to the depth of a search. */
+	template <typename state_T>
+	struct stack {
+		typedef std::stack<typename item<state_T>::type, std::vector<typename item<state_T>::type>> type;
+	};
+//! Data of one search-result; the same for all searchers.
+	typedef SearchHit hit_type;
 //! Type of search-results.
-	/*! Results found during searching are stored in a
-	  hashmap. Its keys are the found strings, the value is a pair
-	  with the number of the state the key was found in and, as the
-	  second member of the pair, the amount of edit operations
-	  needed to find the string. */
-	typedef std::unordered_map<std::string, std::pair<unsigned int, unsigned int>> result_type;
+	/*! Results found during searching are kept by the end states of
+	  the found keys, with their hit_type data; searchers never
+	  build strings, the Tri spells the keys it returns from the
+	  states. */
+	typedef SearchResults result_type;
 
 
 protected:
@@ -60,11 +237,10 @@ public:
 /*! \param startState The initial state to begin searching in.
   \param v A vector with indices being states and values state
   information.
-  \return A pointer to an item representing the start of the
-  beam-search.
+  \return An item representing the start of the beam-search.
 */
 	template <typename state_T>
-	std::unique_ptr<typename item<state_T>::type> initialItem(const unsigned int startState, const std::vector<std::unique_ptr<state_T>>& v) const {
+	typename item<state_T>::type initialItem(const unsigned int startState, const std::vector<state_T>& v) const {
 		return static_cast<const derived_T*>(this)->initialItem(startState, v);
 	}
 
@@ -74,21 +250,27 @@ public:
   being state information.
   \param s The search stack to be manipulated; will only be pushed onto.
   \param i The item for which to push new items onto the stack. Usually
-  the former top item.
+  a copy of the former top item; pushing may move the items of the
+  stack, so it must not refer to one of them.
 */
 	template <typename state_T>
-	void feedStack(std::stack<std::unique_ptr<typename item<state_T>::type> >& s, const std::vector<std::unique_ptr<state_T> >& v, const typename item<state_T>::type& i) {
+	void feedStack(typename stack<state_T>::type& s, const std::vector<state_T>& v, const typename item<state_T>::type& i) {
 		(static_cast<derived_T*>(this))->feedStack(s, v, i);
 	}
 
 //! Extract the results of a search.
 /*! Searcher accumulates results during a call to feedStack. This
   method allows extraction of results.
-  \return The unordered_map of results.
+  \return The results, by end state.
 */
 	const result_type& getResults() const {
 		return (static_cast<const derived_T*>(this))->getResults();
 	}
+
+//! Counters of the work done by the search so far.
+	const SearchStats& getStats() const {
+		return (static_cast<const derived_T*>(this))->getStats();
+	}
 };
 	
 #endif
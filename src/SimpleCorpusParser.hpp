@@ -4,6 +4,7 @@
 */
 
 #include "CorpusParser.hpp"
+#include "Utf8.hpp"
 
 #ifndef __SIMPLECORPUSPARSER_HPP__
 #define SIMPLECORPUSPARSER_HPP__
@@ -31,7 +32,7 @@ public:
 
   Functions similarly to ProbabilityCorpusParser::parseLine but expects
   a different format; lines should be of the form .+ , where
-  . is any alphanumeric character.
+  . is any letter or combining mark, encoded in UTF-8.
   This function throws \cword ParseError if a malformed line is passed
   to parseLine.
   The return value is meant for use in Tri<double>::insert
@@ -49,11 +50,13 @@ public:
 	const 	std::pair<const std::string, const double> parseLine(const std::string& line) {
 		++_data.linesConsumed;
 
-		for(std::string::const_iterator i(line.cbegin()); i != line.cend(); ++i) {
-			if(!isalpha(*i)) {
-				_data.parseError("Encountered unexpected '" + std::string(i,i) + "' while trying to parse a word.");
+		for(std::string::const_iterator i(line.cbegin()); i != line.cend();) {
+			std::string::const_iterator next(i);
+			char32_t c;
+			if(!Utf8::next(next, line.cend(), c) || !(Utf8::isLetter(c) || Utf8::isMark(c))) {
+				_data.parseError("Encountered unexpected '" + std::string(i, next) + "' while trying to parse a word.");
 			} // if
-
+			i = next;
 		} // for
 
 		return std::make_pair(std::string(line.cbegin(), line.cend()),
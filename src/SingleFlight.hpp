@@ -0,0 +1,92 @@
+/* SingleFlight.hpp
+   Lets concurrent identical requests share one computation.
+*/
+
+#include <string>
+#include <memory>
+#include <future>
+#include <mutex>
+#include <atomic>
+#include <exception>
+#include <unordered_map>
+
+#ifndef __SINGLEFLIGHT_HPP__
+#define __SINGLEFLIGHT_HPP__
+
+/*! Coalesces concurrent requests for the same key.
+
+  The first thread that asks for a key computes the result; threads
+  that ask for the same key while that computation is in flight wait
+  for it and get the same result, without computing or copying it.
+  Once the result is there, the key is forgotten: this is not a cache,
+  and a later request computes again. If the computation throws, all
+  waiting threads get the exception.
+  All members can be called from several threads at once.
+*/
+template <class value_T>
+class SingleFlight {
+public:
+//! The type of shared results.
+	typedef std::shared_ptr<const value_T> result_type;
+
+private:
+	std::mutex _m; /*!< Guards _flights. */
+	std::unordered_map<std::string, std::shared_future<result_type>> _flights; /*!<
+					The results of the computations
+					in flight, by key. */
+	std::atomic<unsigned long> _calls; /*!< Calls of run. */
+	std::atomic<unsigned long> _shared; /*!< Calls of run that
+					      waited for another one. */
+
+public:
+	SingleFlight(const SingleFlight&) = delete;
+	SingleFlight() : _m(), _flights(), _calls(0), _shared(0) {}
+
+/*! Gets the result for a key, computing it unless another thread
+ *  already does.
+ \param key Identifies the request; requests with equal keys must
+ have equal results.
+ \param compute Returns the result, as a value_T.
+ \return The result of this or of a concurrent computation.
+*/
+	template <typename compute_T>
+	result_type run(const std::string& key, compute_T compute) {
+		++_calls;
+		std::promise<result_type> promise;
+		{
+			std::unique_lock<std::mutex> lock(_m);
+			auto found(_flights.find(key));
+			if(found != _flights.end()) {
+				std::shared_future<result_type> flight(found->second);
+				lock.unlock();
+				++_shared;
+				return flight.get();
+			}
+			_flights.emplace(key, promise.get_future().share());
+		}
+		result_type result;
+		try {
+			result = std::make_shared<const value_T>(compute());
+			promise.set_value(result);
+		} catch(...) {
+			promise.set_exception(std::current_exception());
+			std::lock_guard<std::mutex> lock(_m);
+			_flights.erase(key);
+			throw;
+		}
+		std::lock_guard<std::mutex> lock(_m);
+		_flights.erase(key);
+		return result;
+	} // run
+
+//! The number of calls of run.
+	unsigned long getCalls() const {
+		return _calls;
+	}
+//! The number of calls of run that shared the result of another one.
+	unsigned long getShared() const {
+		return _shared;
+	}
+}; // SingleFlight
+
+#endif
@@ -0,0 +1,88 @@
+/* SplitSearch.hpp
+   Error-tolerant search from both ends of a key.
+*/
+
+#include "Tri.hpp"
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+
+#ifndef __SPLITSEARCH_HPP__
+#define __SPLITSEARCH_HPP__
+
+/*! Keys shorter than this are searched with a plain tolerantFind,
+ *  since splitting them prunes too little to pay for the second
+ *  search. */
+const unsigned int minSplitLength = 6;
+
+/*! Error-tolerant retrieval that splits the key in two halves.
+
+  A plain tolerantFind has to branch on every possible edit from the
+  very first character of the key on, which is expensive for long keys
+  at higher edit distances: the top of the Tri is wide. This function
+  uses the pigeonhole principle instead. If a key k = k1 k2 is within
+  n edits of a stored key, either k1 needs at most n/2 of them, or k2
+  needs at most n - n/2 - 1 of them. The first case is found by a
+  forward search that allows only n/2 edits until k1 is consumed; the
+  second case by the same search through a Tri of reversed keys, with
+  reversed k2 as the restricted prefix. Both searches use the full
+  edit distance for the rest of the key, so every result carries its
+  true edit distance in at least one of them. The two result sets are
+  merged, keeping the lower edit distance for keys found twice.
+  For n = 1 this means searching one half exactly and the other half
+  with one edit; the search stays narrow at the top of both Tris no
+  matter where the error is.
+
+  \param forward The Tri to search.
+  \param reversed A Tri with the reversed keys of forward and the same
+  values.
+  \param key A possibly misspelled string for which corrections will be
+  searched.
+  \param editDistance The maximum amount of edit-operations to perform
+  during the search.
+  \return A vector of TolerantResults, as returned by Tri::tolerantFind ;
+  not sorted.
+  \sa CorrectionSearcher::restrictPrefix
+*/
+template <typename value_T>
+std::vector<typename Tri<value_T>::TolerantResult> splitTolerantFind(const Tri<value_T>& forward, const Tri<value_T>& reversed, const std::string& key, const unsigned int editDistance) {
+	if(editDistance == 0 || key.size() < minSplitLength) {
+		return forward.tolerantFind(key, editDistance);
+	}
+	const unsigned int split(key.size() / 2);
+	const unsigned int frontBudget(editDistance / 2);
+	const unsigned int backBudget(editDistance - frontBudget - 1);
+
+	CorrectionSearcher front(key, editDistance);
+	front.restrictPrefix(split, frontBudget);
+	auto results(forward.tolerantFindWith(front));
+
+	const std::string reversedKey(key.crbegin(), key.crend());
+	CorrectionSearcher back(reversedKey, editDistance);
+	back.restrictPrefix(key.size() - split, backBudget);
+	auto reversedResults(reversed.tolerantFindWith(back));
+
+// merge: remember where every key of the forward search is, by its
+// index, then either lower its edit distance or append the reversed
+// result; forward may not spell its results, reversed must
+	std::unordered_map<unsigned int, std::size_t> found;
+	for(std::size_t i(0); i < results.size(); ++i) {
+		found.insert(std::make_pair(results[i].index, i));
+	}
+	for(auto r(reversedResults.begin()); r != reversedResults.end(); ++r) {
+		std::reverse(r->first.begin(), r->first.end());
+// the index the reversed Tri gave the key is not its index in forward
+		r->index = forward.indexOf(r->first);
+		auto f(found.find(r->index));
+		if(f == found.end()) {
+			results.push_back(std::move(*r));
+		} else if(results[f->second].editDistance > r->editDistance) {
+			results[f->second].editDistance = r->editDistance;
+			results[f->second].cost = r->cost;
+		}
+	}
+	return results;
+} // splitTolerantFind
+
+#endif
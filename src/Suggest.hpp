@@ -10,11 +10,71 @@
 #include <exception>
 #include "ProbabilityCorpusParser.hpp"
 #include "SimpleCorpusParser.hpp"
+#include "SplitSearch.hpp"
+#include "RadixTri.hpp"
+#include "WeightedCorrectionSearcher.hpp"
+#include "Alphabet.hpp"
+#include "BigramModel.hpp"
+#include "MissCache.hpp"
+#include "QGramFilter.hpp"
+#include "SingleFlight.hpp"
+#include <memory>
+#include <cmath>
 #include <algorithm>
 
 #ifndef __SUGGEST_HPP__
 #define __SUGGEST_HPP__
 
+//! The search algorithms a Suggest instance can use to find corrections.
+enum class Engine {
+	trie, /*!< Depth-first search through the Tri (default). */
+	split, /*!< Splits the word in two halves and searches from both
+		ends, with a second Tri of reversed words; see
+		splitTolerantFind. */
+	radix /*!< Searches a path-compressed copy of the Tri, see
+		RadixTri . */
+};
+
+//! Settings of a Suggest instance, besides its corpus.
+struct SuggestOptions {
+	unsigned int maxEditDistance; /*!< The maximum edit operations
+					that will be performed to find a
+					correction suggestion. */
+	Engine engine; /*!< The search algorithm. */
+	ThreadPool* pool; /*!< Threads to split single searches of
+			    Engine::trie over, see
+			    Tri::tolerantFindParallel ; not owned, and
+			    searches stay on the calling thread if
+			    null. */
+	const CostMatrix* costs; /*!< Weighted edit costs; not owned. If
+				   set, searches use a
+				   WeightedCorrectionSearcher bounded by
+				   maxCost instead of the engine and
+				   maxEditDistance. */
+	double maxCost; /*!< The highest summed edit cost of a
+			  suggestion; only used with costs. */
+	bool foldCase; /*!< Whether words and queries are folded to
+			 lower case, see Alphabet . */
+	bool quantize; /*!< Whether the Tris store their values in 16
+			 bits, see Tri::quantize . */
+	const BigramModel* bigrams; /*!< Probabilities of words after
+				      other words, for rankedInContext
+				      ; not owned, may be null. */
+	double editWeight; /*!< The log-probability that one edit
+			     operation (or one unit of edit cost) costs
+			     in rankedInContext . */
+	std::size_t missCache; /*!< The most queries without
+				 suggestions to remember, see
+				 MissCache ; 0 for none. */
+	unsigned int qgrams; /*!< The q of a QGramFilter that rejects
+			       queries without suggestions before
+			       searching; 0 for none. Not used with
+			       costs. */
+//! Options for a search algorithm and maximum edit distance.
+	SuggestOptions(const unsigned int n, const Engine e = Engine::trie)
+		: maxEditDistance(n), engine(e), pool(nullptr), costs(nullptr), maxCost(n), foldCase(false), quantize(false), bigrams(nullptr), editWeight(defaultEditWeight), missCache(0), qgrams(0) {}
+};
+
 /*! Corpus based correction suggestions for misspelled strings.
  *
  * This class provides functionality to read in a wordlist corpus and
@@ -51,9 +111,42 @@ private:
 			     * correct spelling; it is searched to
 			     * find suggestions. Parametrized with
 			     * double to store possible word probabilities.*/
-	unsigned int _maxEditDistance; /*!< The maximum edit
-					* operations that will be performed to find
-					* a correction suggestion. */
+	const SuggestOptions _options; /*!< Maximum edit distance,
+					 search algorithm and threads. */
+	Tri<double> _reversedWords; /*!< The words of _words spelled
+				      backwards; only filled for
+				      Engine::split . */
+	std::unique_ptr<const RadixTri<double>> _radixWords; /*!< The
+							       words of
+							       _words,
+							       path-compressed;
+							       only built
+							       for
+							       Engine::radix . */
+	Alphabet _alphabet; /*!< Maps the code points of the corpus
+			      to the symbols that the Tris store. */
+	std::unique_ptr<const CostMatrix> _costs; /*!< The edit costs of
+						    the options, indexed by
+						    the symbols of
+						    _alphabet. */
+	std::vector<unsigned int> _bigramIds; /*!< The ids of the words
+						in the bigram model of the
+						options, by their index in
+						_words. */
+	std::vector<std::string> _spellings; /*!< The words of _words in
+					       UTF-8, by their index;
+					       search results are spelled
+					       from these. */
+	std::unique_ptr<MissCache> _missCache; /*!< Recent queries
+						 without suggestions;
+						 null unless the options
+						 ask for it. */
+	std::unique_ptr<QGramFilter> _qgrams; /*!< The q-grams of
+						_words; null unless the
+						options ask for it. */
+	mutable SingleFlight<std::vector<Tri<double>::TolerantResult>> _inFlight; /*!<
+						Searches of rankedShared
+						that are running. */
 
 private:
 
@@ -61,26 +154,77 @@ private:
 		typedef Tri<double>::TolerantResult T;
 
 //! A Function object to create a total ordering of search results.
-/*! This is used in 'all' to sort the search results and in 'best' to
-	find the best result. To create a total order, edit distance
-	and probability is compared. Edit distanced is weighed more
-	than Probability.
+/*! This is used in 'ranked' to sort the search results and in 'best' to
+	find the best result. To create a total order, edit cost
+	and probability is compared. Edit cost is weighed more
+	than Probability. A result is 'less' than another if it is the
+	worse suggestion, i.e. if it has a higher edit cost or, at
+	equal edit cost, a lower probability; of equally good results,
+	the one that sorts after the other by its bytes is the worse
+	one. Without a CostMatrix the edit cost is the edit
+	distance. Costs are compared in steps of
+	one millionth, so that sums of float costs that differ only by
+	rounding count as equal and the order stays transitive.
 */
 	struct _cmpTolerantResult {
-		bool operator()(const T& p1, const T& p2) {
-			if(p1.editDistance == p2.editDistance) {
-				return p1.second < p2.second;
-			} else {
-				return p1.editDistance < p2.editDistance;
-			}
+		bool operator()(const T& p1, const T& p2) const {
+			const int c(_compareScores(p1, p2));
+// equally good words are ranked by their spelling, so that the order
+// does not depend on how they were found
+			return c ? c < 0 : p1.first > p2.first;
 		} // operator()
 	}; // _cmp_tolerantResult
+//! Reverses _cmpTolerantResult, so that sorting puts the best results first.
+	struct _cmpBetterFirst {
+		bool operator()(const T& p1, const T& p2) const {
+			return _cmpTolerantResult()(p2, p1);
+		} // operator()
+	}; // _cmpBetterFirst
+/*! Orders search results like _cmpBetterFirst before they are
+ *  spelled, looking the words of equally good ones up by index. */
+	struct _cmpBetterFirstUnspelled {
+		const std::vector<std::string>& spellings; /*!< The words
+							     by index. */
+		bool operator()(const T& p1, const T& p2) const {
+			const int c(_compareScores(p1, p2));
+			return c ? c > 0 : spellings[p1.index] < spellings[p2.index];
+		} // operator()
+	}; // _cmpBetterFirstUnspelled
+/*! Compares the edit costs and probabilities of two search results,
+ *  see _cmpTolerantResult .
+ \return Less than 0 if p1 is the worse suggestion, greater than 0 if
+ it is the better one, 0 if they are equally good.
+*/
+	static int _compareScores(const T& p1, const T& p2) {
+		const long long c1(std::llround(p1.cost * 1e6)), c2(std::llround(p2.cost * 1e6));
+		if(c1 != c2) {
+			return c1 > c2 ? -1 : 1;
+		}
+		if(p1.second != p2.second) {
+			return p1.second < p2.second ? -1 : 1;
+		}
+		return 0;
+	} // _compareScores
+/*! Sorts unspelled search results, best first. */
+	void _rank(std::vector<T>& v) const {
+		sort(v.begin(), v.end(), _cmpBetterFirstUnspelled{_spellings});
+	}
+/*! Gives search results their words; searches of _words leave them
+ *  empty, so that only the results that are returned get a string. */
+	void _spell(std::vector<T>& v) const {
+		for(auto r(v.begin()); r != v.end(); ++r) {
+			r->first = _spellings[r->index];
+		}
+	}
 /*! Uses a \cword CorpusParser to verify and read-in a corpus.
 
 This function takes an input filestream and processes the entire file,
 	filling in the \cword _cword member Tri with appropriate
 	values (in this case key strings for words and \cword double
-	for values).
+	for values). Words are stored as symbols of \cword _alphabet ,
+	which learns the code points of the corpus on the way. The
+	Tris are compacted, and quantized if the options say so, once
+	the whole corpus is in them.
 Throws on invalid corpus file format, which is verified by the 
 \cword CorpusParser instance.
 \param corpus An input file stream of the corpus to be processed.
@@ -88,16 +232,211 @@ Throws on invalid corpus file format, which is verified by the
 	void _readCorpus(std::ifstream& corpus) {
 		corpusParser_T corpusParser(_corpusFilename);
 		std::string line;
+		if(_options.qgrams && !_options.costs) {
+			_qgrams.reset(new QGramFilter(_options.qgrams));
+		}
 		while(corpus.good()) {
 			std::getline(corpus, line);
 // empty lines are ignored
 			if(!line.empty()) {
-				_words.insert(corpusParser.parseLine(line));
+				const auto p(corpusParser.parseLine(line));
+				const std::string key(_alphabet.learn(p.first));
+// with case folding, several spellings can become the same key; the
+// most probable one gives the value
+				const double* known(_alphabet.foldsCase() ? _words.unsafeGet(key) : nullptr);
+				if(known && *known >= p.second) {
+					continue;
+				}
+				_words.insert(key, p.second);
+				if(_qgrams) {
+					_qgrams->add(key);
+				}
+				if(_options.engine == Engine::split && !_options.costs) {
+					_reversedWords.insert(std::string(key.crbegin(), key.crend()), p.second);
+				}
 			}
 		} // while
+		_words.compact();
+		_reversedWords.compact();
+		if(_qgrams) {
+			_qgrams->seal();
+		}
+		if(_options.quantize) {
+			_words.quantize();
+			_reversedWords.quantize();
+		}
+		_words.indexCompletions();
+// searches find key indices; the words are decoded once, here
+		_words.spellResults(false);
+		_spellings = _words.keys();
+		for(auto k(_spellings.begin()); k != _spellings.end(); ++k) {
+			*k = _alphabet.decode(*k);
+		}
+		if(_options.engine == Engine::radix && !_options.costs) {
+			_radixWords.reset(new RadixTri<double>(_words));
+		}
+// key indices are final after compacting; every key gets the id of
+// its spelling in the bigram model once, so ranking needs no lookups
+		if(_options.bigrams) {
+			_bigramIds.reserve(_spellings.size());
+			for(auto k(_spellings.cbegin()); k != _spellings.cend(); ++k) {
+				_bigramIds.push_back(_options.bigrams->id(*k));
+			}
+		}
+		if(_options.costs) {
+			_costs.reset(new CostMatrix(_options.costs->forAlphabet(_alphabet)));
+		}
 	} // _readCorpus
+
+/*! Searches the internal wordlist with the configured engine.
+ * The word is mapped to the symbols of the Tri first, and the keys of
+ * the results back to UTF-8. Queries in the miss cache, and queries
+ * the q-gram filter rejects, are not searched; queries without
+ * results go into the miss cache. Searches within a SearchBudget
+ * walk the Tri with Tri::tolerantFindWithin , whatever the engine;
+ * their results only go into the miss cache if they are complete.
+ * The results are not spelled, see _spell .
+ * Searches for a number of wanted suggestions deepen the edit
+ * distance one at a time with Tri::tolerantFindNearest , unless
+ * there are edit costs: a key with more edits can then cost less.
+\param w A word, possibly misspelled.
+\param budget Limits of the search, or null.
+\param wanted The number of best suggestions needed, or 0 for all.
+\return Unsorted search results with empty words.
+*/
+	std::vector<T> _find(const std::string& w, SearchBudget* budget = nullptr, const unsigned int wanted = 0) const {
+		std::vector<T> results;
+		_findKey(_alphabet.encode(w), results, budget, wanted, nullptr);
+		return results;
+	} // _find
+/*! Searches like _find , for a word that is already mapped to symbols,
+ *  into a vector of the caller.
+\param key The symbols of a word, possibly misspelled.
+\param results Set to the unsorted search results, with empty words.
+\param budget Limits of the search, or null.
+\param wanted The number of best suggestions needed, or 0 for all.
+\param scratch Memory of earlier searches, or null; only the default
+engine uses it, see Tri::tolerantFind .
+*/
+	void _findKey(const std::string& key, std::vector<T>& results, SearchBudget* budget, const unsigned int wanted, Tri<double>::Scratch* scratch) const {
+		results.clear();
+		const double limit(_costs ? _options.maxCost : _options.maxEditDistance);
+		if(_missCache && _missCache->contains(key, limit)) {
+			return;
+		}
+		if(_qgrams && !_qgrams->mayMatch(key, _options.maxEditDistance)) {
+			return;
+		}
+// the budget may have run out in an earlier search for the same query
+		const bool exhausted(budget && budget->exhausted);
+		if(budget) {
+			budget->exhausted = false;
+		}
+		if(budget && _costs) {
+			WeightedCorrectionSearcher searcher(key, *_costs, _options.maxCost);
+			results = _words.tolerantFindWithin(searcher, *budget);
+		} else if(budget || (wanted && !_costs)) {
+			CorrectionSearcher searcher(key, _options.maxEditDistance);
+			results = _words.tolerantFindNearest(searcher, wanted, budget);
+		} else if(_costs) {
+			WeightedCorrectionSearcher searcher(key, *_costs, _options.maxCost);
+			results = _words.tolerantFindWith(searcher);
+		} else if(_options.engine == Engine::split) {
+			results = splitTolerantFind(_words, _reversedWords, key, _options.maxEditDistance);
+		} else if(_radixWords) {
+			results = _radixWords->tolerantFind(key, _options.maxEditDistance);
+		} else if(_options.pool) {
+			results = _words.tolerantFindParallel(key, _options.maxEditDistance, *_options.pool);
+		} else if(scratch) {
+			_words.tolerantFind(key, _options.maxEditDistance, *scratch, results);
+		} else {
+			results = _words.tolerantFind(key, _options.maxEditDistance);
+		}
+		const bool complete(!budget || !budget->exhausted);
+		if(budget) {
+			budget->exhausted = budget->exhausted || exhausted;
+		}
+		if(results.empty() && _missCache && complete) {
+			_missCache->insert(key, limit);
+		}
+	} // _findKey
 		
 public:
+/*! The type of the ranked search results returned by \cword ranked ;
+ *  carries the suggested word, its probability and the edit distance
+ *  needed to find it. */
+	typedef Tri<double>::TolerantResult result_type;
+
+/*! Memory that \cword all can rank suggestions into, again and again.
+
+  A Buffer keeps the memory of the searches and of the results that
+  were put into it. Once it has grown to the size of the searches of
+  a thread, \cword all does not allocate with the default engine;
+  the other engines still allocate their results. A Buffer must only
+  be used by one search at a time, and only with the Suggest it was
+  last filled by while that Suggest lives.
+*/
+	class Buffer {
+		friend class Suggest;
+	private:
+		Tri<double>::Scratch _scratch; /*!< The memory of the
+						 search. */
+		std::vector<T> _found; /*!< The unsorted search results. */
+		std::u32string _codePoints; /*!< The normalized query. */
+		std::string _key; /*!< The query as symbols of the
+				    alphabet. */
+	public:
+//! A suggestion; its word belongs to the Suggest it came from.
+		struct Suggestion {
+			const std::string* word; /*!< The suggested word. */
+			double probability; /*!< Its probability in the
+					      corpus. */
+			unsigned int editDistance; /*!< The edit operations
+						     that lead to it. */
+			double cost; /*!< The cost of these operations; the
+				       edit distance without a
+				       CostMatrix. */
+		};
+		std::vector<Suggestion> results; /*!< The suggestions of the
+						   last search, best first. */
+
+		Buffer() = default;
+		Buffer(const Buffer&) = delete;
+		Buffer(Buffer&&) = default;
+		Buffer& operator=(Buffer&&) = default;
+	}; // Buffer
+
+/*! Tells whether one search result is a better suggestion than
+ *  another; this is the order of the results of \cword ranked .
+ \param a A search result.
+ \param b Another search result.
+ \return True if a has a lower edit cost than b, or the same
+ edit cost and a higher probability. */
+	static bool isBetter(const result_type& a, const result_type& b) {
+		return _cmpBetterFirst()(a, b);
+	}
+
+//! The miss cache with its hit counters, or null.
+	const MissCache* getMissCache() const {
+		return _missCache.get();
+	}
+//! The q-gram filter with its rejection counters, or null.
+	const QGramFilter* getQGramFilter() const {
+		return _qgrams.get();
+	}
+//! The number of States of the Tri of the words, see Tri::getStates .
+	unsigned int getStates() const {
+		return _words.getStates();
+	}
+//! The number of words.
+	unsigned int getKeys() const {
+		return _words.getKeys();
+	}
+//! The requests of rankedShared , with the number that were shared.
+	const SingleFlight<std::vector<result_type>>& getSingleFlight() const {
+		return _inFlight;
+	}
+
 	Suggest() = delete;
 	Suggest(const Suggest&) = delete;
 /*! Creates a new Suggest instance from a Corpus and a maximum edit
@@ -109,9 +448,20 @@ public:
 	into the internal list of correct words.
 \param maxEditDistance Maximum amount of edit operations for which
 	suggestions will be made.
+\param engine The search algorithm to use.
+*/
+	Suggest(const std::string& corpusFilename, const unsigned int maxEditDistance, const Engine engine = Engine::trie)
+		: Suggest(corpusFilename, SuggestOptions(maxEditDistance, engine)) {}
+/*! Creates a new Suggest instance from a Corpus and search options.
+
+ * This function may throw on file reading errors or an invalid
+ * formatting of the provided corpus.
+\param corpusFileName Filename of the text corpus that will be read
+	into the internal list of correct words.
+\param options Maximum edit distance, search algorithm and threads.
 */
-	Suggest(const std::string& corpusFilename, const unsigned int maxEditDistance)
-		: _corpusFilename(corpusFilename), _words(Tri<double>()), _maxEditDistance(maxEditDistance) {
+	Suggest(const std::string& corpusFilename, const SuggestOptions& options)
+		: _corpusFilename(corpusFilename), _words(Tri<double>()), _options(options), _reversedWords(), _radixWords(), _alphabet(options.foldCase), _costs(), _bigramIds(), _spellings(), _missCache(options.missCache ? new MissCache(options.missCache) : nullptr), _qgrams(), _inFlight() {
 		std::ifstream corpusFile(corpusFilename);
 
 		if(!corpusFile.is_open()) {
@@ -124,8 +474,11 @@ public:
 		corpusFile.close();
 	} // Suggest ctor
 //! Overloaded constructor to read directly from a stream.
-	Suggest(std::ifstream& corpus, const std::string& name, const unsigned int n)
-		: _corpusFilename(name), _words(Tri<double>()), _maxEditDistance(n) {
+	Suggest(std::ifstream& corpus, const std::string& name, const unsigned int n, const Engine engine = Engine::trie)
+		: Suggest(corpus, name, SuggestOptions(n, engine)) {}
+//! Overloaded constructor to read directly from a stream, with search options.
+	Suggest(std::ifstream& corpus, const std::string& name, const SuggestOptions& options)
+		: _corpusFilename(name), _words(Tri<double>()), _options(options), _reversedWords(), _radixWords(), _alphabet(options.foldCase), _costs(), _bigramIds(), _spellings(), _missCache(options.missCache ? new MissCache(options.missCache) : nullptr), _qgrams(), _inFlight() {
 		_readCorpus(corpus);
 	} // Suggest ctor
 /*! Finds the best correction suggestion for a given word.
@@ -137,23 +490,200 @@ public:
 	probability in the corpus. If the internal search yields no
 	result, the empty string is returned.
 
+	Without edit costs, the search stops at the lowest edit distance
+	with a result, see Tri::tolerantFindNearest .
+
 \param w A word, possibly misspelled, for which suggestions should be
 found.
 \return The best correction suggestion that could be found or the
 empty string.
 */
 	std::string best(const std::string& w) const {
-		const _cmpTolerantResult f; // comparison object to
-					    // find the maximum
-		auto v(_words.tolerantFind(w, _maxEditDistance));
-		std::vector<T>::const_iterator winner(max_element(v.cbegin(), v.cend(), f));
+		const _cmpBetterFirstUnspelled f{_spellings}; // comparison object to
+							      // find the best
+		auto v(_find(w, nullptr, 1));
+		std::vector<T>::const_iterator winner(min_element(v.cbegin(), v.cend(), f));
 		if(winner == v.cend())
 // return empty string on no results
 			return std::string("");
-// otherwise return maximum element according to comparison function
-		return std::move(winner->first);
+// otherwise spell the best element according to comparison function
+		return _spellings[winner->index];
 	} // best
 				
+/*! Finds all possible correction suggestions, with their edit
+ *  distances and probabilities.
+ *
+ * This function searches the internal wordlist to find all possible
+ * corrections for the input word and provided edit distance. The
+ * results are returned as they come out of the Tri, sorted from best
+ * to worst; lower indices are better candidates. The ordering is the
+ * same as for \cword all , but callers keep the edit distance and
+ * probability of every candidate without computing them again.
+ * If no results are found in the internal search, an empty vector is
+ * returned.
+ * \param w A word, possibly misspelled, for which correction suggestions
+ * are to be found.
+ * \return A vector of search results, best ones first.
+ * \sa all
+ */
+	std::vector<result_type> ranked(const std::string& w) const {
+		auto v(_find(w));
+		_rank(v);
+		_spell(v);
+		return v;
+	} // ranked
+
+/*! Finds correction suggestions like \cword ranked , within a budget
+ *  of search items or time.
+ *
+ * If the budget runs out, the suggestions found so far are returned
+ * and budget.exhausted is set; since the search expands items with
+ * fewer edits first, the suggestions are then complete below
+ * budget.completeBelow edits. Budgeted searches always walk the Tri,
+ * see Tri::tolerantFindWithin .
+ * \param w A word, possibly misspelled.
+ * \param budget Limits of the search; updated when they run out.
+ * \return A vector of search results, best ones first.
+ * \sa ranked
+ */
+	std::vector<result_type> ranked(const std::string& w, SearchBudget& budget) const {
+		auto v(_find(w, &budget));
+		_rank(v);
+		_spell(v);
+		return v;
+	} // ranked
+
+/*! Finds the best few correction suggestions, ranked like the first
+ *  ones of \cword ranked .
+ *
+ * Without edit costs, the search deepens one edit distance at a time
+ * and stops at the first distance by which it has found k
+ * suggestions, see Tri::tolerantFindNearest ; for words that are
+ * spelled correctly or nearly so, this is much cheaper than finding
+ * all suggestions up to the maximum edit distance.
+ * \param w A word, possibly misspelled.
+ * \param k The number of suggestions; 0 for all, like \cword ranked .
+ * \param budget Limits of the search, or null; see \cword ranked .
+ * \return At most k search results, best ones first.
+ * \sa ranked
+ */
+	std::vector<result_type> top(const std::string& w, const unsigned int k, SearchBudget* budget = nullptr) const {
+		auto v(_find(w, budget, k));
+		_rank(v);
+		if(k && v.size() > k) {
+			v.erase(v.begin() + k, v.end());
+		}
+		_spell(v);
+		return v;
+	} // top
+
+/*! Finds all possible correction suggestions like \cword ranked ,
+ *  sharing the search with concurrent calls for the same word.
+ *
+ * Under load, many threads ask about the same misspelling at the same
+ * moment. The first call searches; calls for the same word (after
+ * case folding) that come while that search runs wait for it, and
+ * all of them get the same vector, which is never copied. Requests
+ * are keyed by the word, the budget of the search and the kind of
+ * request, see SingleFlight .
+ * \param w A word, possibly misspelled.
+ * \return The ranked search results, best ones first, shared with
+ * concurrent callers.
+ * \sa ranked
+ */
+	std::shared_ptr<const std::vector<result_type>> rankedShared(const std::string& w) const {
+		std::string key(_alphabet.encode(w));
+		key += '\0';
+		key += std::to_string(_costs ? _options.maxCost : _options.maxEditDistance);
+		key += "\0ranked";
+		return _inFlight.run(key, [this, &w]() { return ranked(w); });
+	} // rankedShared
+
+/*! Tells whether a word is spelled correctly, with an exact lookup
+ *  instead of a search.
+ \param w A word.
+ \return True if w, case folded if the options say so, is in the
+ internal wordlist.
+*/
+	bool known(const std::string& w) const {
+		return _words.indexOf(_alphabet.encode(w)) != noKey;
+	} // known
+
+/*! Completes a word as it is typed: finds the most probable words
+ *  that begin with a prefix, or with a string close to it.
+ *
+ * Unit edit operations are counted, with or without a cost matrix in
+ * the options; see Tri::complete .
+ * \param prefix The beginning of a word, possibly misspelled.
+ * \param k The number of completions.
+ * \param maxEdits The number of edit operations between the prefix
+ * and the beginning of a completion.
+ * \return At most k search results, ranked like those of \cword ranked
+ * by the edit operations for the prefix and their probability; the
+ * editDistance of a result is the number of edit operations for the
+ * prefix.
+ */
+	std::vector<result_type> complete(const std::string& prefix, const unsigned int k, const unsigned int maxEdits) const {
+		auto v(_words.complete(_alphabet.encode(prefix), k, maxEdits));
+// the Tri ranks equally good keys by their states, not by their bytes
+		_rank(v);
+		_spell(v);
+		return v;
+	} // complete
+
+/*! Finds all possible correction suggestions and ranks them by how
+ *  likely they are after the word before.
+ *
+ * Every suggestion is scored with the log-probability of the
+ * suggestion after the word before, from the bigram model of the
+ * options, or bigramBackoff times its own probability if the model
+ * does not have that pair; SuggestOptions::editWeight is subtracted
+ * per unit of edit cost. So a word that fits the context can win over
+ * a closer one that does not. Suggestions with the same score are
+ * ranked like in \cword ranked . All suggestions are scored with one
+ * call to BigramModel::score . Without a bigram model, this is the
+ * same as \cword ranked .
+ * \param w A word, possibly misspelled.
+ * \param context The bigram model id of the word before w, or
+ * BigramModel::unknownWord at the start of a sentence; set to the id
+ * of the best suggestion, or of w itself if there is none, for the
+ * next word of the sentence.
+ * \return A vector of search results, best ones first.
+ * \sa ranked
+ */
+	std::vector<result_type> rankedInContext(const std::string& w, unsigned int& context) const {
+		const BigramModel* model(_options.bigrams);
+		if(!model) {
+			context = BigramModel::unknownWord;
+			return ranked(w);
+		}
+		auto v(_find(w));
+		std::vector<unsigned int> ids(v.size());
+		for(std::size_t i(0); i < v.size(); ++i) {
+			ids[i] = v[i].index < _bigramIds.size() ? _bigramIds[v[i].index] : BigramModel::unknownWord;
+		}
+		std::vector<float> logProbs(v.size());
+		model->score(context, ids.data(), ids.size(), logProbs.data());
+		const double backoff(std::log(bigramBackoff));
+		std::vector<std::pair<double, std::size_t>> order(v.size());
+		for(std::size_t i(0); i < v.size(); ++i) {
+			const double logProb(logProbs[i] == BigramModel::absent ? backoff + v[i].second : logProbs[i]);
+			order[i] = std::make_pair(logProb - _options.editWeight * v[i].cost, i);
+		}
+		std::sort(order.begin(), order.end(), [this, &v](const std::pair<double, std::size_t>& a, const std::pair<double, std::size_t>& b) {
+				if(a.first != b.first) return a.first > b.first;
+				return _cmpBetterFirstUnspelled{_spellings}(v[a.second], v[b.second]);
+			});
+		std::vector<result_type> sorted;
+		sorted.reserve(v.size());
+		for(auto o(order.cbegin()); o != order.cend(); ++o) {
+			sorted.push_back(std::move(v[o->second]));
+		}
+		context = order.empty() ? model->id(w) : ids[order.front().second];
+		_spell(sorted);
+		return sorted;
+	} // rankedInContext
+
 /*! Finds all possible correction suggestions.
  * 
  * This function searches the internal wordlist to find all possible
@@ -168,21 +698,48 @@ empty string.
  * \param w A word, possibly misspelled, for which correction suggestions
  * are to be found.
  * \return A vector of sorted suggestion strings.
+ * \sa ranked
  */
 	std::vector<std::string> all(const std::string& w) const {
-		const _cmpTolerantResult f;  // comparison object to
-					     // sort the results
-		auto v(_words.tolerantFind(w, _maxEditDistance));
-		sort(v.begin(), v.end(), f);
-// the returned vector has edit distance and probability in it, so we
-// have to unpack it
+		auto v(_find(w));
+		_rank(v);
+// the ranked vector has edit distance and probability in it, so we
+// only take the words, spelling each once
 		std::vector<std::string> v2;
-		// std::sort puts lowest elements first, so we iterate
-		// in reverse, since we want the best ones first
-		for(auto i(v.crbegin()); i != v.crend(); ++i) {
-			v2.push_back(i->first);
+		v2.reserve(v.size());
+		for(auto i(v.cbegin()); i != v.cend(); ++i) {
+			v2.push_back(_spellings[i->index]);
+		}
+		return v2;
+	} // all
+/*! Finds correction suggestions like \cword all , into a Buffer of
+ *  the caller.
+
+ * The suggestions point to the words of the corpus, which the Suggest
+ * keeps anyway, so that nothing is copied. Reusing a Buffer, the
+ * search does not allocate once it has grown, except with edit costs
+ * or an engine other than Engine::trie .
+ * \param w A word, possibly misspelled.
+ * \param out Its results are set to the suggestions, best first.
+ * \param limit Only this many of the best suggestions are kept, or
+ * all if it is 0; the others need not be sorted.
+ * \sa all
+ */
+	void all(const std::string& w, Buffer& out, const std::size_t limit = 0) const {
+		_alphabet.encode(w, out._key, out._codePoints);
+		_findKey(out._key, out._found, nullptr, 0, &out._scratch);
+		std::vector<T>& v(out._found);
+		const _cmpBetterFirstUnspelled better{_spellings};
+		if(limit && limit < v.size()) {
+			std::partial_sort(v.begin(), v.begin() + limit, v.end(), better);
+			v.erase(v.begin() + limit, v.end());
+		} else {
+			std::sort(v.begin(), v.end(), better);
+		}
+		out.results.clear();
+		for(auto i(v.cbegin()); i != v.cend(); ++i) {
+			out.results.push_back(typename Buffer::Suggestion{&_spellings[i->index], i->second, i->editDistance, i->cost});
 		}
-		return std::move(v2);
 	} // all
 }; // class Suggest
 
@@ -0,0 +1,305 @@
+/* TextPipeline.hpp
+   Spell checking of running text, with a reader thread, a search
+   stage on a thread pool and an ordered writer thread.
+*/
+
+#include "ThreadPool.hpp"
+#include "Utf8.hpp"
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <utility>
+#include <istream>
+#include <ostream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+
+#ifndef __TEXTPIPELINE_HPP__
+#define __TEXTPIPELINE_HPP__
+
+//! What TextPipeline writes for the misspelled words of a text.
+enum class TextMode {
+	annotate, /*!< Every misspelled word is followed by its
+		    suggestions in brackets. */
+	correct /*!< Every misspelled word is replaced with its best
+		  suggestion, if it has one. */
+};
+
+//! Lines of text that are read, searched and written together.
+const unsigned int textBatchLines = 256;
+/*! Batches that may wait between two stages; bounds the memory of a
+ *  pipeline whose writer is slower than its reader. */
+const unsigned int textQueueBatches = 4;
+
+/*! A queue of limited length between two threads. Pushing blocks while
+ *  the queue is full, popping blocks while it is empty. Once closed,
+ *  pushes fail and pops return what is left and then fail. */
+template <class item_T>
+class BoundedQueue {
+private:
+	const std::size_t _capacity; /*!< The most items in the queue. */
+	std::deque<item_T> _items; /*!< The queued items. */
+	bool _closed; /*!< Set by close. */
+	std::mutex _m; /*!< Guards _items and _closed. */
+	std::condition_variable _notFull; /*!< Signalled when an item is
+					    popped or the queue closed. */
+	std::condition_variable _notEmpty; /*!< Signalled when an item is
+					     pushed or the queue closed. */
+
+public:
+	BoundedQueue() = delete;
+	BoundedQueue(const BoundedQueue&) = delete;
+//! Creates an empty queue for at most capacity items.
+	explicit BoundedQueue(const std::size_t capacity)
+		: _capacity(capacity), _items(), _closed(false), _m(), _notFull(), _notEmpty() {}
+
+/*! Appends an item, waiting for space.
+ \return False if the queue is closed; the item is dropped. */
+	bool push(item_T&& item) {
+		std::unique_lock<std::mutex> lock(_m);
+		_notFull.wait(lock, [this]() { return _closed || _items.size() < _capacity; });
+		if(_closed) {
+			return false;
+		}
+		_items.push_back(std::move(item));
+		_notEmpty.notify_one();
+		return true;
+	}
+/*! Takes the first item, waiting for one.
+ \return False if the queue is closed and empty. */
+	bool pop(item_T& item) {
+		std::unique_lock<std::mutex> lock(_m);
+		_notEmpty.wait(lock, [this]() { return _closed || !_items.empty(); });
+		if(_items.empty()) {
+			return false;
+		}
+		item = std::move(_items.front());
+		_items.pop_front();
+		_notFull.notify_one();
+		return true;
+	}
+//! Wakes all waiting threads; no more items can be pushed.
+	void close() {
+		std::lock_guard<std::mutex> lock(_m);
+		_closed = true;
+		_notFull.notify_all();
+		_notEmpty.notify_all();
+	}
+}; // BoundedQueue
+
+//! Counts of what a TextPipeline has seen.
+struct TextStats {
+	unsigned long lines; /*!< Lines of text. */
+	unsigned long words; /*!< Words of the text, see
+			       Utf8::findWords . */
+	unsigned long unknown; /*!< Words that are not in the
+				 dictionary. */
+	unsigned long searched; /*!< Tolerant searches, one per distinct
+				  unknown word of a batch. */
+	TextStats() : lines(0), words(0), unknown(0), searched(0) {}
+};
+
+/*! Finds the misspelled words of running text and writes the text
+ *  back, annotated or corrected.
+
+  The text is split into words with Utf8::findWords ; everything
+  between words is written back unchanged. Three stages work on
+  batches of textBatchLines lines at once:
+  - a reader thread reads the lines of a batch;
+  - the calling thread looks every word up with an exact lookup,
+    collects the distinct unknown words of the batch and searches
+    each of them once, as one task per word on the thread pool;
+  - a writer thread writes the batches in the order they were read.
+  Correctly spelled words, which are most of any text, never reach the
+  tolerant search, and a misspelling that occurs many times in a
+  batch is searched once. While one batch is searched, the next one
+  is read and the one before is written; bounded queues between the
+  stages keep at most textQueueBatches batches waiting.
+
+  suggest_T needs the members known and top of Suggest .
+*/
+template <class suggest_T>
+class TextPipeline {
+private:
+//! Byte offset and length of a word in its line.
+	typedef std::pair<std::size_t, std::size_t> span_T;
+//! Suggestions for every distinct unknown word of a batch.
+	typedef std::unordered_map<std::string, std::vector<std::string>> suggestions_T;
+
+//! Lines of text on their way through the pipeline.
+	struct _Batch {
+		std::vector<std::string> lines; /*!< The lines, without
+						  line breaks. */
+		std::vector<std::vector<span_T>> unknown; /*!< The unknown
+							    words of every
+							    line. */
+		suggestions_T suggestions; /*!< Suggestions for the unknown
+					     words, best ones first. */
+	};
+
+	const suggest_T& _dictionary; /*!< The dictionary to check
+					against; not owned. */
+	ThreadPool* _pool; /*!< Threads for the searches; not owned, may
+			     be null. */
+	const TextMode _mode; /*!< What to write for misspelled words. */
+	const unsigned int _suggestions; /*!< The most suggestions to keep
+					   per word; 0 for all. */
+	TextStats _stats; /*!< Counts of the last run. */
+
+/*! Finds the unknown words of a batch and their suggestions.
+ \param batch A batch with its lines read.
+*/
+	void _search(_Batch& batch) {
+		std::vector<suggestions_T::value_type*> distinct;
+		std::vector<span_T> words;
+		batch.unknown.resize(batch.lines.size());
+		for(std::size_t l(0); l < batch.lines.size(); ++l) {
+			const std::string& line(batch.lines[l]);
+			Utf8::findWords(line, words);
+			_stats.words += words.size();
+			for(auto w(words.cbegin()); w != words.cend(); ++w) {
+				std::string word(line, w->first, w->second);
+				if(_dictionary.known(word)) {
+					continue;
+				}
+				batch.unknown[l].push_back(*w);
+				auto inserted(batch.suggestions.emplace(std::move(word), std::vector<std::string>()));
+				if(inserted.second) {
+// elements of an unordered_map stay where they are when it grows
+					distinct.push_back(&*inserted.first);
+				}
+			} // for words
+			_stats.unknown += batch.unknown[l].size();
+		} // for lines
+		_stats.lines += batch.lines.size();
+		_stats.searched += distinct.size();
+		std::vector<ThreadPool::task_T> tasks;
+		tasks.reserve(distinct.size());
+		for(auto d(distinct.cbegin()); d != distinct.cend(); ++d) {
+			suggestions_T::value_type* entry(*d);
+			tasks.push_back([this, entry]() {
+					const auto v(_dictionary.top(entry->first, _suggestions));
+					for(auto r(v.cbegin()); r != v.cend(); ++r) {
+						entry->second.push_back(r->first);
+					}
+				});
+		}
+		if(_pool) {
+			_pool->run(tasks);
+		} else {
+			for(auto t(tasks.begin()); t != tasks.end(); ++t) {
+				(*t)();
+			}
+		}
+	} // _search
+
+/*! Writes the lines of a batch with their misspelled words annotated
+ *  or corrected.
+ \param batch A searched batch.
+ \param out The stream to write to.
+*/
+	void _write(const _Batch& batch, std::ostream& out) const {
+		for(std::size_t l(0); l < batch.lines.size(); ++l) {
+			const std::string& line(batch.lines[l]);
+			std::size_t written(0);
+			for(auto w(batch.unknown[l].cbegin()); w != batch.unknown[l].cend(); ++w) {
+				const std::string word(line, w->first, w->second);
+				const std::vector<std::string>& s(batch.suggestions.at(word));
+				out.write(line.data() + written, w->first - written);
+				written = w->first + w->second;
+				if(_mode == TextMode::correct) {
+					out << (s.empty() ? word : s.front());
+					continue;
+				}
+				out << word << '[';
+				for(auto i(s.cbegin()); i != s.cend(); ++i) {
+					out << (i == s.cbegin() ? "" : "|") << *i;
+				}
+				out << ']';
+			} // for words
+			out.write(line.data() + written, line.size() - written);
+			out << '\n';
+		} // for lines
+		out.flush();
+	} // _write
+
+public:
+	TextPipeline() = delete;
+	TextPipeline(const TextPipeline&) = delete;
+/*! Creates a pipeline that checks text against a dictionary.
+ \param dictionary The dictionary; must outlive the pipeline.
+ \param pool Threads to search the unknown words of a batch on, or
+ null to search them on the calling thread.
+ \param mode What to write for misspelled words.
+ \param suggestions The most suggestions to write per misspelled
+ word with TextMode::annotate ; 0 for all of them.
+*/
+	TextPipeline(const suggest_T& dictionary, ThreadPool* pool, const TextMode mode, const unsigned int suggestions)
+		: _dictionary(dictionary), _pool(pool), _mode(mode), _suggestions(mode == TextMode::correct ? 1 : suggestions), _stats() {}
+
+/*! Reads text until the end of a stream and writes it, annotated or
+ *  corrected, to another. Every line is written with a line break;
+ *  output appears a batch at a time. Exceptions of any stage are
+ *  rethrown once all threads have stopped.
+ \param in The text to check.
+ \param out The stream to write the text to.
+ \return Counts of this run.
+*/
+	TextStats run(std::istream& in, std::ostream& out) {
+		_stats = TextStats();
+		BoundedQueue<_Batch> read(textQueueBatches), searched(textQueueBatches);
+		std::exception_ptr readError, writeError;
+		std::thread reader([&]() {
+				try {
+					std::string line;
+					while(in) {
+						_Batch batch;
+						while(batch.lines.size() < textBatchLines && std::getline(in, line)) {
+							batch.lines.push_back(std::move(line));
+						}
+						if(batch.lines.empty() || !read.push(std::move(batch))) {
+							break;
+						}
+					}
+				} catch(...) {
+					readError = std::current_exception();
+				}
+				read.close();
+			});
+		std::thread writer([&]() {
+				try {
+					for(_Batch batch; searched.pop(batch);) {
+						_write(batch, out);
+					}
+				} catch(...) {
+					writeError = std::current_exception();
+				}
+// a failed writer must not leave the search stage waiting for space
+				searched.close();
+			});
+		std::exception_ptr searchError;
+		try {
+			for(_Batch batch; read.pop(batch);) {
+				_search(batch);
+				if(!searched.push(std::move(batch))) {
+					break;
+				}
+			}
+		} catch(...) {
+			searchError = std::current_exception();
+		}
+		read.close();
+		searched.close();
+		reader.join();
+		writer.join();
+		if(searchError) std::rethrow_exception(searchError);
+		if(readError) std::rethrow_exception(readError);
+		if(writeError) std::rethrow_exception(writeError);
+		return _stats;
+	} // run
+}; // TextPipeline
+
+#endif
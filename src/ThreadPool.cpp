@@ -0,0 +1,133 @@
+
+#include "ThreadPool.hpp"
+
+/*! \param threads The number of workers; a pool with 0 workers runs
+ *  every batch on the thread that submits it.
+ */
+ThreadPool::ThreadPool(const unsigned int threads)
+	: _queues(), _workers(), _queued(0), _next(0), _sleep(), _wake(), _stop(false) {
+	for(unsigned int i(0); i < threads; ++i) {
+		_queues.push_back(std::unique_ptr<_Queue>(new _Queue));
+	}
+	for(unsigned int i(0); i < threads; ++i) {
+		_workers.push_back(std::thread(&ThreadPool::_work, this, i));
+	}
+} // ThreadPool ctor
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> lock(_sleep);
+		_stop = true;
+	}
+	_wake.notify_all();
+	for(auto t(_workers.begin()); t != _workers.end(); ++t) {
+		t->join();
+	}
+} // ThreadPool dtor
+
+/*! Workers use their own index as self and take from the back of
+ *  their queue, so that tasks they queued last (and whose data is
+ *  still in cache) run first. Other threads pass an index past the
+ *  last queue and only steal.
+ \param self Index of the queue of the calling worker.
+ \param task Set to the task taken.
+ \return False if all queues were empty.
+*/
+bool ThreadPool::_take(const std::size_t self, _Task& task) {
+	if(_queued.load() == 0) {
+		return false;
+	}
+	if(self < _queues.size()) {
+		_Queue& own(*_queues[self]);
+		std::lock_guard<std::mutex> lock(own.m);
+		if(!own.tasks.empty()) {
+			task = own.tasks.back();
+			own.tasks.pop_back();
+			--_queued;
+			return true;
+		}
+	}
+// steal, starting with the queue after our own so that thieves
+// spread over the victims
+	for(std::size_t k(1); k <= _queues.size(); ++k) {
+		_Queue& victim(*_queues[(self + k) % _queues.size()]);
+		std::lock_guard<std::mutex> lock(victim.m);
+		if(!victim.tasks.empty()) {
+			task = victim.tasks.front();
+			victim.tasks.pop_front();
+			--_queued;
+			return true;
+		}
+	}
+	return false;
+} // _take
+
+void ThreadPool::_execute(const _Task& task) {
+	try {
+		(*task.f)();
+	} catch(...) {
+		std::lock_guard<std::mutex> lock(task.batch->m);
+		if(!task.batch->error) {
+			task.batch->error = std::current_exception();
+		}
+	}
+// count down under the lock: the waiting thread can neither miss the
+// notification nor destroy the batch while we still use it
+	std::lock_guard<std::mutex> lock(task.batch->m);
+	if(--task.batch->remaining == 0) {
+		task.batch->done.notify_all();
+	}
+} // _execute
+
+void ThreadPool::_work(const std::size_t self) {
+	_Task task;
+	for(;;) {
+		if(_take(self, task)) {
+			_execute(task);
+			continue;
+		}
+		std::unique_lock<std::mutex> lock(_sleep);
+		_wake.wait(lock, [this]() { return _stop || _queued.load() > 0; });
+		if(_stop && _queued.load() == 0) {
+			return;
+		}
+	} // for
+} // _work
+
+/*! The tasks are spread over the worker queues. The calling thread
+ *  then runs tasks itself, stealing from the workers, until none are
+ *  left, and waits for the workers to finish the ones they took.
+ \param tasks The tasks to run; they must stay valid until run
+ returns, which they do since run blocks.
+*/
+void ThreadPool::run(std::vector<task_T>& tasks) {
+	if(tasks.empty()) {
+		return;
+	}
+	_Batch batch(tasks.size());
+	if(_queues.empty()) {
+		for(auto t(tasks.begin()); t != tasks.end(); ++t) {
+			_execute(_Task{&*t, &batch});
+		}
+	} else {
+		for(auto t(tasks.begin()); t != tasks.end(); ++t) {
+			_Queue& q(*_queues[_next++ % _queues.size()]);
+			std::lock_guard<std::mutex> lock(q.m);
+			q.tasks.push_back(_Task{&*t, &batch});
+			++_queued;
+		}
+		{
+			std::lock_guard<std::mutex> lock(_sleep);
+		}
+		_wake.notify_all();
+		_Task task;
+		while(batch.remaining.load() > 0 && _take(_queues.size(), task)) {
+			_execute(task);
+		}
+	}
+	std::unique_lock<std::mutex> lock(batch.m);
+	batch.done.wait(lock, [&batch]() { return batch.remaining.load() == 0; });
+	if(batch.error) {
+		std::rethrow_exception(batch.error);
+	}
+} // run
@@ -0,0 +1,96 @@
+/* ThreadPool.hpp
+   A small work-stealing thread pool.
+*/
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifndef __THREADPOOL_HPP__
+#define __THREADPOOL_HPP__
+
+/*! A fixed number of worker threads that run batches of tasks.
+
+  Every worker has its own task queue. Workers take tasks from the
+  back of their own queue and, once it is empty, steal from the front
+  of the other queues, so a batch of tasks of very different cost
+  still keeps all workers busy until the end. The thread that submits
+  a batch helps running it and returns when every task of the batch
+  is done.
+  Batches may be submitted from several threads at once, and tasks
+  may submit batches themselves.
+  If a task throws, the other tasks of its batch still run and the
+  first exception is rethrown by \cword run .
+*/
+class ThreadPool {
+public:
+//! The type of tasks.
+	typedef std::function<void()> task_T;
+
+private:
+//! Completion state of one call to run.
+	struct _Batch {
+		std::atomic<std::size_t> remaining; /*!< Tasks not yet
+						      finished. */
+		std::mutex m; /*!< Guards error and the wait for
+				completion. */
+		std::condition_variable done; /*!< Signalled when the
+						last task finishes. */
+		std::exception_ptr error; /*!< First exception thrown by
+					    a task, if any. */
+		_Batch(const std::size_t n) : remaining(n), m(), done(), error() {}
+	};
+//! A task with the batch it belongs to.
+	struct _Task {
+		task_T* f; /*!< The task; owned by the caller of run. */
+		_Batch* batch; /*!< The batch of the task. */
+	};
+//! A task queue of one worker.
+	struct _Queue {
+		std::mutex m; /*!< Guards tasks. */
+		std::deque<_Task> tasks; /*!< Queued tasks. */
+	};
+
+	std::vector<std::unique_ptr<_Queue>> _queues; /*!< One queue per
+							worker. */
+	std::vector<std::thread> _workers; /*!< The worker threads. */
+	std::atomic<std::size_t> _queued; /*!< Number of tasks in all
+					    queues. */
+	std::atomic<std::size_t> _next; /*!< Round-robin counter to
+					  spread tasks over the queues. */
+	std::mutex _sleep; /*!< Guards idle workers waiting for tasks. */
+	std::condition_variable _wake; /*!< Signalled when tasks are
+					 queued or the pool stops. */
+	bool _stop; /*!< Set when the pool is destroyed. */
+
+//! Takes a task, first from queue self, then from the others.
+	bool _take(const std::size_t self, _Task& task);
+//! Runs a task and marks it as done in its batch.
+	static void _execute(const _Task& task);
+//! Main loop of worker threads.
+	void _work(const std::size_t self);
+
+public:
+	ThreadPool() = delete;
+	ThreadPool(const ThreadPool&) = delete;
+//! Starts a pool with the given number of worker threads.
+	explicit ThreadPool(const unsigned int threads);
+//! Stops and joins all workers; waits for queued tasks to finish.
+	~ThreadPool();
+
+//! The number of worker threads.
+	unsigned int size() const {
+		return _workers.size();
+	}
+
+//! Runs a batch of tasks on the pool and waits until all are done.
+	void run(std::vector<task_T>& tasks);
+}; // ThreadPool
+
+#endif
@@ -0,0 +1,465 @@
+/* Transitions.hpp
+   The transitions of a State of a Tri, in a node type that fits their
+   number.
+*/
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <utility>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#ifndef __TRANSITIONS_HPP__
+#define __TRANSITIONS_HPP__
+
+//! The node types of Transitions, by the number of transitions.
+enum class NodeType : unsigned char {
+	node4, /*!< Up to 4, inline. */
+	node16, /*!< Up to 16, searched with one SIMD compare. */
+	node48, /*!< Up to 48, through an index by character. */
+	node256 /*!< Any number, by character. */
+};
+//! The number of NodeTypes.
+const unsigned int nodeTypes = 4;
+//! The most transitions of each NodeType.
+const unsigned int nodeCapacity[nodeTypes] = {4, 16, 48, 256};
+
+/*! The transitions of a State: characters, each with the State it
+ *  leads to.
+
+  Like an adaptive radix tree, every State keeps its transitions in
+  the smallest of four node types that can hold them, and moves them
+  to the next one when it is full:
+  - Node4 keeps up to 4 characters and States inline, and is searched
+  linearly. Most States of a dictionary have one or two transitions,
+  so most never allocate.
+  - Node16 keeps up to 16 on the heap; a lookup compares all 16
+  characters at once with SSE2 where it is there.
+  - Node48 and Node256 keep a bitmap of the characters they hold and
+  an index of 256 bytes from character to slot.
+  Lookups cost a few instructions in every node type, where the
+  std::map this replaces compared its way down a tree of separately
+  allocated nodes.
+  In every node type, the transitions are kept in slots, one after
+  the other, and lookups do not depend on their order: they are
+  placed by character, and sort can put them into any other order,
+  like that of the most valuable key below them (see
+  Tri::indexCompletions ). Iterators go through the slots in order
+  and give std::pair s of the character and the State by value, so
+  \cword t->first and \cword t->second work like on a map.
+  Transitions can only be added, not removed.
+*/
+class Transitions {
+public:
+//! The type of the names of States.
+	typedef unsigned state_T;
+//! A transition: its character and the State it leads to.
+	typedef std::pair<unsigned char, state_T> value_type;
+
+private:
+//! Up to 16 transitions.
+	struct Node16 {
+		unsigned char keys[16]; /*!< The characters. */
+		state_T children[16]; /*!< The States, in the same order. */
+	};
+//! Up to 48 transitions, with an index by character.
+	struct Node48 {
+		std::uint64_t present[4]; /*!< The characters, as a bitmap. */
+		unsigned char index[256]; /*!< The slot of every present
+					    character. */
+		unsigned char keys[48]; /*!< The characters. */
+		state_T children[48]; /*!< The States, in the same order. */
+	};
+//! Transitions with every character, with an index by character.
+	struct Node256 {
+		std::uint64_t present[4]; /*!< The characters, as a bitmap. */
+		unsigned char index[256]; /*!< The slot of every present
+					    character. */
+		unsigned char keys[256]; /*!< The characters. */
+		state_T children[256]; /*!< The States, in the same order. */
+	};
+
+	NodeType _type; /*!< How the transitions are kept. */
+	unsigned short _size; /*!< The number of transitions. */
+	unsigned char _keys[4]; /*!< The characters of a Node4; outside
+				  of the union, so that the Transitions
+				  take 24 bytes. */
+	union {
+		state_T _children[4]; /*!< The States of a Node4. */
+		Node16* _node16; /*!< For NodeType::node16 . */
+		Node48* _node48; /*!< For NodeType::node48 . */
+		Node256* _node256; /*!< For NodeType::node256 . */
+	};
+
+//! Whether a bitmap holds a character.
+	static bool _has(const std::uint64_t* present, const unsigned char c) {
+		return present[c >> 6] >> (c & 63) & 1;
+	}
+//! The characters of the slots.
+	unsigned char* _slotKeys() {
+		switch(_type) {
+		case NodeType::node4:
+			return _keys;
+		case NodeType::node16:
+			return _node16->keys;
+		case NodeType::node48:
+			return _node48->keys;
+		default:
+			return _node256->keys;
+		}
+	}
+//! The States of the slots.
+	state_T* _slotChildren() {
+		switch(_type) {
+		case NodeType::node4:
+			return _children;
+		case NodeType::node16:
+			return _node16->children;
+		case NodeType::node48:
+			return _node48->children;
+		default:
+			return _node256->children;
+		}
+	}
+//! The index by character of a Node48 or Node256, or null.
+	unsigned char* _index() {
+		switch(_type) {
+		case NodeType::node48:
+			return _node48->index;
+		case NodeType::node256:
+			return _node256->index;
+		default:
+			return nullptr;
+		}
+	}
+//! The transition in a slot.
+	value_type _at(const unsigned int i) const {
+		switch(_type) {
+		case NodeType::node4:
+			return value_type(_keys[i], _children[i]);
+		case NodeType::node16:
+			return value_type(_node16->keys[i], _node16->children[i]);
+		case NodeType::node48:
+			return value_type(_node48->keys[i], _node48->children[i]);
+		default:
+			return value_type(_node256->keys[i], _node256->children[i]);
+		}
+	}
+/*! The slot of a character, or n.
+ \param keys The characters of the slots.
+ \param n Their number.
+ \param c The character to find.
+*/
+	static unsigned int _search(const unsigned char* keys, const unsigned int n, const unsigned char c) {
+		unsigned int i(0);
+		while(i < n && keys[i] != c) {
+			++i;
+		}
+		return i;
+	}
+/*! Moves the transitions to the next NodeType. The slots keep their
+ *  order. */
+	void _grow() {
+		switch(_type) {
+		case NodeType::node4: {
+			Node16* n(new Node16());
+			std::memcpy(n->keys, _keys, 4);
+			std::memcpy(n->children, _children, 4 * sizeof(state_T));
+			_node16 = n;
+			_type = NodeType::node16;
+			break;
+		}
+		case NodeType::node16: {
+			Node48* n(new Node48());
+			std::memcpy(n->keys, _node16->keys, 16);
+			std::memcpy(n->children, _node16->children, 16 * sizeof(state_T));
+			delete _node16;
+			_node48 = n;
+			_type = NodeType::node48;
+			break;
+		}
+		default: {
+			Node256* n(new Node256());
+			std::memcpy(n->keys, _node48->keys, 48);
+			std::memcpy(n->children, _node48->children, 48 * sizeof(state_T));
+			delete _node48;
+			_node256 = n;
+			_type = NodeType::node256;
+			break;
+		}
+		}
+		_reindex(0);
+	} // _grow
+/*! Sets the bitmap and the index of a Node48 or Node256 for the slots
+ *  from one on; does nothing for the others. */
+	void _reindex(const unsigned int from) {
+		unsigned char* index(_index());
+		if(!index) {
+			return;
+		}
+		std::uint64_t* present(_type == NodeType::node48 ? _node48->present : _node256->present);
+		const unsigned char* keys(_slotKeys());
+		for(unsigned int i(from); i < _size; ++i) {
+			present[keys[i] >> 6] |= 1ull << (keys[i] & 63);
+			index[keys[i]] = i;
+		}
+	}
+//! Frees the node on the heap, if there is one.
+	void _free() {
+		switch(_type) {
+		case NodeType::node16:
+			delete _node16;
+			break;
+		case NodeType::node48:
+			delete _node48;
+			break;
+		case NodeType::node256:
+			delete _node256;
+			break;
+		default:
+			break;
+		}
+	}
+
+public:
+//! Goes through the transitions in the order of their slots.
+	class const_iterator {
+	private:
+		friend class Transitions;
+		const Transitions* _t; /*!< The transitions. */
+		unsigned int _i; /*!< The slot. */
+		const_iterator(const Transitions* t, const unsigned int i) : _t(t), _i(i) {}
+	public:
+		typedef std::bidirectional_iterator_tag iterator_category;
+		typedef Transitions::value_type value_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef value_type reference;
+//! Holds a transition for operator-> .
+		struct pointer {
+			value_type v; /*!< The transition. */
+			const value_type* operator->() const {
+				return &v;
+			}
+		};
+		const_iterator() : _t(nullptr), _i(0) {}
+		value_type operator*() const {
+			return _t->_at(_i);
+		}
+		pointer operator->() const {
+			return pointer{_t->_at(_i)};
+		}
+		const_iterator& operator++() {
+			++_i;
+			return *this;
+		}
+		const_iterator operator++(int) {
+			const const_iterator before(*this);
+			++*this;
+			return before;
+		}
+		const_iterator& operator--() {
+			--_i;
+			return *this;
+		}
+		const_iterator operator--(int) {
+			const const_iterator before(*this);
+			--*this;
+			return before;
+		}
+		bool operator==(const const_iterator& other) const {
+			return _i == other._i;
+		}
+		bool operator!=(const const_iterator& other) const {
+			return _i != other._i;
+		}
+	}; // const_iterator
+//! Transitions cannot be changed through iterators.
+	typedef const_iterator iterator;
+/*! Goes through the transitions backwards; std::reverse_iterator needs
+ *  iterators that give references. */
+	class const_reverse_iterator {
+	private:
+		const_iterator _base; /*!< The position after the transition. */
+	public:
+		explicit const_reverse_iterator(const const_iterator base) : _base(base) {}
+		value_type operator*() const {
+			const_iterator i(_base);
+			return *--i;
+		}
+		const_iterator::pointer operator->() const {
+			return const_iterator::pointer{**this};
+		}
+		const_reverse_iterator& operator++() {
+			--_base;
+			return *this;
+		}
+		bool operator==(const const_reverse_iterator& other) const {
+			return _base == other._base;
+		}
+		bool operator!=(const const_reverse_iterator& other) const {
+			return _base != other._base;
+		}
+	}; // const_reverse_iterator
+
+//! Creates empty Transitions, in a Node4.
+	Transitions() : _type(NodeType::node4), _size(0) {}
+//! Copies the transitions, in the same NodeType.
+	Transitions(const Transitions& other) : _type(other._type), _size(other._size) {
+		switch(_type) {
+		case NodeType::node4:
+			std::memcpy(_keys, other._keys, sizeof(_keys));
+			std::memcpy(_children, other._children, sizeof(_children));
+			break;
+		case NodeType::node16:
+			_node16 = new Node16(*other._node16);
+			break;
+		case NodeType::node48:
+			_node48 = new Node48(*other._node48);
+			break;
+		default:
+			_node256 = new Node256(*other._node256);
+			break;
+		}
+	}
+//! Takes the transitions over; other is left empty.
+	Transitions(Transitions&& other) noexcept : _type(other._type), _size(other._size) {
+		std::memcpy(_keys, other._keys, sizeof(_keys));
+		std::memcpy(_children, other._children, sizeof(_children));
+		other._type = NodeType::node4;
+		other._size = 0;
+	}
+//! Copy and move assignment, through the pass-by-value.
+	Transitions& operator=(Transitions other) noexcept {
+		swap(other);
+		return *this;
+	}
+	~Transitions() {
+		_free();
+	}
+//! Swaps the transitions with other ones.
+	void swap(Transitions& other) noexcept {
+		std::swap(_type, other._type);
+		std::swap(_size, other._size);
+		std::swap(_keys, other._keys);
+		std::swap(_children, other._children);
+	}
+
+/*! Finds the transition with a character.
+ \param c The character.
+ \return The transition, or end() if there is none.
+*/
+	const_iterator find(const unsigned char c) const {
+		switch(_type) {
+		case NodeType::node4: {
+			const unsigned int i(_search(_keys, _size, c));
+			return const_iterator(this, i);
+		}
+		case NodeType::node16: {
+#ifdef __SSE2__
+			const __m128i keys(_mm_loadu_si128(reinterpret_cast<const __m128i*>(_node16->keys)));
+			const unsigned int hits(_mm_movemask_epi8(_mm_cmpeq_epi8(keys, _mm_set1_epi8(char(c))))
+						& ((1u << _size) - 1));
+			return const_iterator(this, hits ? __builtin_ctz(hits) : _size);
+#else
+			return const_iterator(this, _search(_node16->keys, _size, c));
+#endif
+		}
+		case NodeType::node48:
+			return const_iterator(this, _has(_node48->present, c) ? _node48->index[c] : _size);
+		default:
+			return const_iterator(this, _has(_node256->present, c) ? _node256->index[c] : _size);
+		}
+	} // find
+/*! Adds a transition; there must not be one with its character yet.
+ *  It goes behind the slots with smaller characters, so transitions
+ *  that were added in any order are in the order of their
+ *  characters, as long as they were not sorted otherwise.
+ \param c The character.
+ \param s The State it leads to.
+*/
+	void insert(const unsigned char c, const state_T s) {
+		if(_size == nodeCapacity[static_cast<unsigned int>(_type)]) {
+			_grow();
+		}
+		unsigned char* keys(_slotKeys());
+		state_T* children(_slotChildren());
+		unsigned int i(_size);
+		for(; i > 0 && keys[i - 1] > c; --i) {
+			keys[i] = keys[i - 1];
+			children[i] = children[i - 1];
+		}
+		keys[i] = c;
+		children[i] = s;
+		++_size;
+		_reindex(i);
+	} // insert
+
+/*! Puts the transitions into another order; lookups stay the same.
+ \param before Tells whether one value_type goes before another, like
+ the comparison of std::sort .
+*/
+	template <typename before_T>
+	void sort(before_T before) {
+		value_type slots[256];
+		unsigned char* keys(_slotKeys());
+		state_T* children(_slotChildren());
+		for(unsigned int i(0); i < _size; ++i) {
+			slots[i] = value_type(keys[i], children[i]);
+		}
+		std::sort(slots, slots + _size, before);
+		for(unsigned int i(0); i < _size; ++i) {
+			keys[i] = slots[i].first;
+			children[i] = slots[i].second;
+		}
+		_reindex(0);
+	} // sort
+
+	const_iterator cbegin() const {
+		return const_iterator(this, 0);
+	}
+	const_iterator cend() const {
+		return const_iterator(this, _size);
+	}
+	const_iterator begin() const {
+		return cbegin();
+	}
+	const_iterator end() const {
+		return cend();
+	}
+	const_reverse_iterator crbegin() const {
+		return const_reverse_iterator(cend());
+	}
+	const_reverse_iterator crend() const {
+		return const_reverse_iterator(cbegin());
+	}
+//! The number of transitions.
+	std::size_t size() const {
+		return _size;
+	}
+	bool empty() const {
+		return _size == 0;
+	}
+//! How the transitions are kept.
+	NodeType type() const {
+		return _type;
+	}
+//! The bytes allocated on the heap, besides the Transitions themselves.
+	std::size_t getHeapBytes() const {
+		switch(_type) {
+		case NodeType::node16:
+			return sizeof(Node16);
+		case NodeType::node48:
+			return sizeof(Node48);
+		case NodeType::node256:
+			return sizeof(Node256);
+		default:
+			return 0;
+		}
+	}
+}; // Transitions
+
+#endif
@@ -8,12 +8,39 @@
 #include <unordered_map>
 #include <memory>
 #include <stack>
+#include <queue>
+#include <stdexcept>
 #include <iostream>
 #include <string>
+#include <algorithm>
+#include <cstdint>
+#include <cmath>
+#include <type_traits>
 #include "CorrectionSearcher.hpp"
+#include "Transitions.hpp"
+#include "ThreadPool.hpp"
 
 #ifndef __TRI_HPP__
 #define __TRI_HPP__
+
+/*! Searches with fewer edit operations than this are cheap enough to
+ *  always run on one thread; see Tri::tolerantFindParallel . */
+const unsigned int parallelMinDistance = 2;
+/*! Depth in the Tri, in characters of the candidate, at which a
+ *  parallel search hands its items out to tasks. */
+const unsigned int parallelSplitDepth = 2;
+/*! A parallel search with fewer items than this at
+ *  parallelSplitDepth finishes on one thread. */
+const unsigned int parallelMinFrontier = 64;
+/*! Tri::compact lays out the States above this depth level by
+ *  level, and the subtrees below it one after the other. */
+const unsigned int compactBreadthDepth = 3;
+/*! Tri::quantize stores values as codes of 16 bits, so there are at
+ *  most this many different values afterwards. */
+const unsigned int quantizeLevels = 1u << 16;
+/*! The key index of strings that are not keys of a Tri; see
+ *  Tri::indexOf . */
+const unsigned int noKey = ~0u;
 /*! Trigraph Class to associate strings with values.
 
   This class provides functionality to associate string keys with
@@ -35,13 +62,13 @@
   also be possible to have a type parameter not only for value types,
   but also for the type of key, i.e. not just std::string but anything
   that can be concatenated. 
-  \todo unique_ptr is used internally to store States; this is probably
-  a bad idea.
   \sa Suggest
 */
 template <class value_T>
 class Tri {
 private:
+/*! A RadixTri is built from the States of a Tri. */
+	template <class> friend class RadixTri;
 
 /*! The type of indices into the state vector. */
 	typedef unsigned state_T;
@@ -50,22 +77,15 @@ private:
   between states. Keys are characters, values are names of states
   (unsigned int/state_T).
 
-  std::map is implemented as a binary search tree (afaik); meaning we
-  get O(log(n)) insertion and deletion - which is important
-  while building the Tri on a corpus. std::map should also be
-  good for iterating through the whole container, which we need
-  to perform a beam search.
-  This is the most performance critical choice of data structure for the
-  whole program; according to my profiler, around 11% of
-  execution time is spent in the <-comparison operator, used by
-  map to find its elements. This is much more than any other
-  component of the program.
-  Note: I tried using std::unordered_map here since hashtables should
-  have O(1) insertion. Profiling has revealed that std::map is
-  actually faster (around x3). Could this be mitigated by
-  providing my own hash function?
-*/
-	typedef std::map<unsigned char, state_T> transitions_T;
+  This is the most performance critical choice of data structure for
+  the whole program. It used to be a std::map; according to my
+  profiler, around 11% of execution time was spent in the
+  <-comparison operator map uses to find its elements, and every
+  transition was a node of its own on the heap. Transitions keeps
+  them in one of four node types by their number, most of them inline
+  in the State; see there.
+*/
+	typedef Transitions transitions_T;
 	/*! Represents states in the Tri
 
 	  States themselves, although they are refered to using unsigned int
@@ -75,10 +95,22 @@ private:
 	struct State {
 		bool endState; /*!< Encodes wether the state is a
 				 final state in the Tri */
-		transitions_T transitions; /*!< A map of transitions that lead, with some character, from this state to another. */
+		unsigned int value; /*!< Index of the value of the key
+				      ending here in the value array;
+				      only meaningful for end states. */
+		transitions_T transitions; /*!< The transitions that lead, with some character, from this state to another. */
+		unsigned int minDepth; /*!< Length of the shortest
+					 path from this state to an end
+					 state; 0 for end states. */
+		unsigned int maxDepth; /*!< Length of the longest path
+					 from this state to an end state. */
+		letterMask_T letters; /*!< Set of characters on any path
+				       from this state to an end state,
+				       see letterBit. */
 /*! Creates States. By default, a new State is not an end state, and
-  has no transitions. */
-		State() : endState(false), transitions() {};
+  has no transitions. Depth bounds and letter set are empty until a
+  key is inserted through the State. */
+		State() : endState(false), value(0), transitions(), minDepth(~0u), maxDepth(0), letters(0) {};
 /*! Here, like elsewhere, I delete the copy constructor because i want
   the compiler to warn me when I accidentally omit a &
   in a function parameter declaration. See copyFrom for
@@ -91,7 +123,11 @@ private:
   the pass-by-value). */
 		State& operator=(State other) noexcept {
 			std::swap(endState, other.endState);
+			std::swap(value, other.value);
 			std::swap(transitions, other.transitions);
+			std::swap(minDepth, other.minDepth);
+			std::swap(maxDepth, other.maxDepth);
+			std::swap(letters, other.letters);
 			return *this;
 		} // operator=
 		/*! Copying functionality.
@@ -103,35 +139,94 @@ private:
 		*/
 		State& copyFrom(const State& source) {
 			endState = source.endState;
-// this will call copy constructor of transitions
+			value = source.value;
+// this copies the node of the transitions
 			transitions = source.transitions;
+			minDepth = source.minDepth;
+			maxDepth = source.maxDepth;
+			letters = source.letters;
 			return *this;
 		} // copyFrom
 	}; // State
 /*! The States are kept in a vector; indices are the names of the
  *  states.
 
- \todo Why is this using unique_ptr? I think this was a bad choice that
- I made early on because I thought States need to be passed
- around. This turned out to be not the case. Now it is a hassle
- to change because other classes rely on this type signature -
- I should have used more typedefs.
- In any case the indirection through the pointers is unnecessary and
- may produce cache misses.
+ States are stored by value, so that States with nearby names are
+ nearby in memory; compact renumbers them to make use of that.
 */
-	std::vector<std::unique_ptr<State>> _v;
-
-/*! A jashmap of values that are stored in the Tri. Indices are the
-  names of States (that are endSates). */
-	std::unordered_map< state_T, value_T> _values;
+	std::vector<State> _v;
+
+/*! The values that are stored in the Tri, one per key; the value of
+  an end State s is _values[s.value]. compact renumbers them in the
+  order of their States. Empty while the Tri is quantized. */
+	std::vector<value_T> _values;
+/*! The values as indices into _codebook, in place of _values, once
+ *  quantize has been called. */
+	std::vector<std::uint16_t> _codes;
+/*! The distinct values of a quantized Tri, ascending; empty unless
+ *  the Tri is quantized. */
+	std::vector<value_T> _codebook;
+/*! How a State is reached from the start State. */
+	struct Link {
+		state_T up; /*!< The State the transition comes from; 0
+			      for the start State itself. */
+		unsigned char c; /*!< The character of the transition. */
+	};
+/*! The Link of every State, by name; keys are spelled from their end
+  States with these, so searches need not carry strings. */
+	std::vector<Link> _links;
+/*! Whether search results carry their keys, see spellResults . */
+	bool _spellResults;
+/*! For every State, the end State with the greatest value among the
+  keys that pass through it, or noKey; filled by indexCompletions ,
+  emptied by insert and compact. */
+	std::vector<state_T> _bestBelow;
 private:
 /*! Creates a new State and returns its name (uint). Suffixed with f
   to remind myself that this function is destructive/mutating
   state in the Tri: Every call to this function will construct
   and push a new State object onto the internal state vector.
+  \param up The State the new one is reached from.
+  \param c The character of that transition.
   \return The name of the newly created State.
 */
-	state_T _newStatef();
+	state_T _newStatef(const state_T up, const unsigned char c);
+/*! Spells the key that ends in a State, from the Links up to the
+ *  start State. */
+	std::string _spell(const state_T state) const;
+/*! Widens the depth bounds and letter set of a State on the path of
+  a newly inserted key.
+  \param state The State to update.
+  \param remaining The number of characters of the key after this State.
+  \param letters The letter set of those remaining characters.
+*/
+	static void _annotate(State& state, const unsigned int remaining, const letterMask_T letters);
+/*! The value of the key that ends in a State.
+  \param state The name of an end State.
+  \return A reference into the value array or the codebook.
+*/
+	const value_T& _value(const state_T state) const {
+		const unsigned int i(_v[state].value);
+		return _codebook.empty() ? _values[i] : _codebook[_codes[i]];
+	}
+/*! Turns the codes of a quantized Tri back into a value array, so
+  that values can be changed again; does nothing if the Tri is not
+  quantized. */
+	void _dequantize();
+
+/*! Runs a search until its stack is empty.
+  \param searchf The Searcher that expands items.
+  \param s The stack of items to expand; empty afterwards.
+*/
+	template <typename derived_T>
+	void _runSearch(Searcher<derived_T>& searchf, typename Searcher<derived_T>::template stack<State>::type& s) const;
+/*! Lowers the cutoff of a CorrectionSearcher, see
+ *  tolerantFindNearest ; other searchers keep theirs. */
+	static void _lowerCutoff(CorrectionSearcher& searchf, const unsigned int cutoff) {
+		searchf.lowerCutoff(cutoff);
+	}
+	template <typename derived_T>
+	static void _lowerCutoff(derived_T&, const unsigned int) {}
 
 public:
 /*! Creates an empty Tri with only one State */
@@ -142,7 +237,7 @@ public:
 	Tri(const Tri<double>&) = delete;
 /*! Move Constructor */
 	Tri(Tri<value_T>&& other) noexcept
-	: _v(std::move(other._v)), _values(std::move(other._values)) {}
+	: _v(std::move(other._v)), _values(std::move(other._values)), _codes(std::move(other._codes)), _codebook(std::move(other._codebook)), _links(std::move(other._links)), _spellResults(other._spellResults), _bestBelow(std::move(other._bestBelow)) {}
 /*! Copy assignment operator, implemented with move semantics. 
 
   Since this is pass-by-value it will invoke the move ctor of other;
@@ -153,6 +248,11 @@ public:
 	Tri<value_T>& operator=(Tri<value_T> other) noexcept {
 		std::swap(_v, other._v);
 		std::swap(_values, other._values);
+		std::swap(_codes, other._codes);
+		std::swap(_codebook, other._codebook);
+		std::swap(_links, other._links);
+		std::swap(_spellResults, other._spellResults);
+		std::swap(_bestBelow, other._bestBelow);
 	        return *this;
 	}
 
@@ -176,14 +276,22 @@ public:
 				  found key-string .*/
 		unsigned int editDistance; /*!< The amount of edit
 					     operations that were necessary to find the key-string .*/
+		double cost; /*!< The summed cost of those edit
+			       operations; the same as editDistance
+			       unless the search used a CostMatrix. */
+		unsigned int index; /*!< The index of the key in the Tri
+				      that was searched, as returned by
+				      indexOf , or noKey. */
 		TolerantResult() = delete;
 		TolerantResult(const TolerantResult&) = delete;
-		TolerantResult(const TolerantResult&& other) noexcept
-		: first(std::move(other.first)), second(std::move(other.second)), editDistance(std::move(other.editDistance)) {}
+		TolerantResult(TolerantResult&& other) noexcept
+		: first(std::move(other.first)), second(std::move(other.second)), editDistance(std::move(other.editDistance)), cost(other.cost), index(other.index) {}
 		TolerantResult& operator=(TolerantResult other) noexcept {
 			std::swap(this->first, other.first);
 			std::swap(this->second, other.second);
 			std::swap(this->editDistance, other.editDistance);
+			std::swap(this->cost, other.cost);
+			std::swap(this->index, other.index);
 			return *this;
 		}
 /*! TolerantResult constructor 
@@ -193,12 +301,49 @@ public:
   \param n The number of edit operations necessary to find the string.
 */
 		TolerantResult(const std::string& s, const value_T& v, const unsigned int n)
-			: first(s), second(v), editDistance(n) {}
+			: first(s), second(v), editDistance(n), cost(n), index(noKey) {}
+/*! TolerantResult constructor for weighted searches
+  \param s The string that was found in the Tri during a tolerant
+  search.
+  \param v The value associated with the string that was found.
+  \param n The number of edit operations necessary to find the string.
+  \param c The summed cost of those edit operations.
+*/
+		TolerantResult(const std::string& s, const value_T& v, const unsigned int n, const double c)
+			: first(s), second(v), editDistance(n), cost(c), index(noKey) {}
 	}; // TolerantResult
 
+/*! Memory that tolerantFind can reuse from one search to the next.
+
+  A Scratch holds a CorrectionSearcher with its results and the
+  search stack; once they have grown to the size of the searches of
+  a thread, searches with the same Scratch do not allocate. A Scratch
+  must only be used by one search at a time, and only with Tris that
+  outlive its use.
+*/
+	class Scratch {
+		friend class Tri;
+	private:
+		std::unique_ptr<CorrectionSearcher> _searcher; /*!< Aimed at
+								 the word of
+								 every
+								 search. */
+		CorrectionSearcher::itemStack<State> _stack; /*!< Empty
+							       between
+							       searches. */
+	public:
+		Scratch() : _searcher(new CorrectionSearcher(std::string(), 0)), _stack() {}
+		Scratch(const Scratch&) = delete;
+		Scratch(Scratch&&) = default;
+		Scratch& operator=(Scratch&&) = default;
+	}; // Scratch
+
 /*! Insert an object into the Tri and associate it with a given key.
   This function will update the Tri destructively. If a key is already
   present, it will be associated with the new value, the old one will be destroyed.
+  Every State on the path of the key has its depth bounds and letter
+  set widened to include the rest of the key, so searchers can prune
+  on them without a separate pass over the Tri.
   \param key A string that will be associated with the provided object.
   \param value An object of type value_T, to be stored in the Tri.
 */
@@ -237,6 +382,41 @@ public:
 */
 	const value_T* unsafeGet(const std::string& key) const;
 
+/*! Finds the index of a key among the keys of the Tri.
+
+  Every key has an index below getKeys , which the TolerantResults of
+  searches carry as well, so that callers can keep data of their own
+  about keys in an array next to the Tri. Indices change when compact
+  is called, and a new key gets the next free one.
+  \param key A string.
+  \return The index of the key, or noKey if it is not in the Tri.
+*/
+	unsigned int indexOf(const std::string& key) const;
+
+/*! Spells all keys of the Tri from the Links of their States, which
+ *  is cheaper than looking every key up with indexOf .
+  \return The keys, by their index.
+*/
+	std::vector<std::string> keys() const;
+
+/*! Chooses whether search results carry their keys.
+
+  Searches only find the end States of keys; by default, every
+  TolerantResult gets its key spelled from the Links of its State.
+  Callers that keep their own spelling of every key by its index,
+  and only need the keys of some results, can turn this off; the
+  results then have an empty first, and their index tells the key.
+  \param spell Whether to spell the keys of results.
+*/
+	void spellResults(const bool spell) {
+		_spellResults = spell;
+	}
+
+/*! Returns the number of keys in the Tri. */
+	unsigned int getKeys() const {
+		return _values.size() + _codes.size();
+	}
+
 /*! Perform beam search through the Tri using a Searcher object to
  *  find results for bad keys.
 
@@ -256,6 +436,60 @@ public:
 */
 	template <typename derived_T>
 	std::vector<TolerantResult> tolerantFindWith(Searcher<derived_T>& searchf) const;
+/*! Beam search like tolerantFindWith , within a budget of items or
+ *  time, exploring items with fewer edit operations first.
+
+ Items wait in one stack per edit distance, and an item is only taken
+ from the stack of distance d once the stacks below are empty; within
+ a stack the search is depth-first. Edit distances only grow along
+ the path of an item, so all keys that are fewer than d edits away
+ are found before the first item of distance d is expanded. If the
+ budget runs out, the search stops and returns what it has found:
+ budget.exhausted is set, and budget.completeBelow tells up to which
+ edit distance the results are complete. Without running out, it
+ finds the same results as tolerantFindWith , doing the same work.
+ \param searchf An instance of Searcher<derived_T>; its items must
+ have an editDistance.
+ \param budget The limits of the search; updated when they run out.
+ \return A vector of TolerantResults, as returned by
+ tolerantFindWith ; not sorted.
+ \sa SearchBudget
+*/
+	template <typename derived_T>
+	std::vector<TolerantResult> tolerantFindWithin(Searcher<derived_T>& searchf, SearchBudget& budget) const;
+/*! Iterative deepening: finds the keys with the fewest edit
+ *  operations, and stops before searching further.
+
+ Searches like tolerantFindWithin , one edit distance after the
+ other; the items of the next distance are the ones the search
+ already has, so no level is searched twice. Once all items of
+ distance d are expanded, every key within d edits is among the
+ results; if there are at least wanted of them, the search stops.
+ For a query that is a key, or one edit away from one, a search with
+ a cutoff of 2 thus costs about as much as one with a cutoff of 0 or
+ 1. With unit costs, the results then contain the wanted best keys by
+ edit distance, then value, so ranking them gives the same first
+ wanted suggestions as ranking the results of a full search.
+ A search with a CorrectionSearcher is bounded by the wanted keys:
+ as soon as it has found them, it no longer produces items with more
+ edits than the distance it is at. Once indexCompletions has been
+ called, it also drops the items below which no key can rank among
+ the wanted ones: those whose best key is worth less than the
+ wanted-th best key found at their distance, where keys found at
+ lower distances count towards the wanted ones. As the transitions
+ are ordered by their best keys, the items that lead to probable keys
+ tend to come first. Keys that rank below the wanted ones may then be
+ missing from the results.
+ \param searchf An instance of Searcher<derived_T>; its items must
+ have an editDistance.
+ \param wanted The number of keys to find; 0 to search up to the
+ cutoff distance of searchf.
+ \param budget Limits of the search, or null.
+ \return A vector of TolerantResults, as returned by
+ tolerantFindWith ; not sorted.
+*/
+	template <typename derived_T>
+	std::vector<TolerantResult> tolerantFindNearest(Searcher<derived_T>& searchf, const unsigned int wanted, SearchBudget* budget = nullptr) const;
 /*! Error-tolerant retrieval of key/value data.
 
   This function attempts to use a CorrectionSearcher to find keys that
@@ -274,6 +508,42 @@ public:
   \sa CorrectionSearcher
 */
 	std::vector<TolerantResult> tolerantFind(const std::string& key, const unsigned int editDistance) const;
+/*! Error-tolerant retrieval like tolerantFind , with memory that is
+ *  reused from search to search.
+
+  The results are written to a vector of the caller, whose elements
+  are replaced. Once scratch and results have grown to the size of the
+  searches, the search does not allocate, unless results are spelled
+  (see spellResults ).
+  \param key A possibly misspelled string.
+  \param editDistance The maximum amount of edit-operations.
+  \param scratch Memory of an earlier search, or a new Scratch.
+  \param results Set to the TolerantResults, as returned by
+  tolerantFind ; not sorted.
+*/
+	void tolerantFind(const std::string& key, const unsigned int editDistance, Scratch& scratch, std::vector<TolerantResult>& results) const;
+/*! Error-tolerant retrieval of key/value data, using several threads.
+
+  Finds the same results as tolerantFind , but splits the work of a
+  single search over the threads of a pool. The top of the Tri, up
+  to a depth of parallelSplitDepth characters, is searched on the
+  calling thread; the search items that reach that depth are dealt out
+  to tasks with their own CorrectionSearcher and stack. The pool
+  balances the tasks by work-stealing, and their results are merged,
+  keeping the lowest edit distance for keys found by several tasks.
+  Searches below parallelMinDistance edits, and searches whose
+  frontier has fewer than parallelMinFrontier items, are cheap and
+  run on the calling thread only.
+  \param key A possibly misspelled string for which corrections will be
+  searched.
+  \param editDistance The maximum amount of edit-operations to perform
+  during the search.
+  \param pool The threads to search with.
+  \return A vector of TolerantResults, as returned by tolerantFind ;
+  not sorted.
+  \sa ThreadPool
+*/
+	std::vector<TolerantResult> tolerantFindParallel(const std::string& key, const unsigned int editDistance, ThreadPool& pool) const;
 /*! Provides copying functionality.
 
   Since I disabled the implicit copy-ctor, this function can be called
@@ -291,6 +561,114 @@ public:
   \return Number of States currently in the Tri.
 */
 	unsigned int getStates() const;
+
+/*! Renumbers the States so that searches touch memory in order.
+
+  States are named in the order they were created, so the States on
+  the path of a key are spread over the whole state vector, as are the
+  nodes of their transition maps. A search that walks one branch then
+  misses the cache on almost every step. This function lays the States
+  out anew: the top compactBreadthDepth levels, which every search
+  passes through, in breadth-first order at the front, then every
+  subtree below them in depth-first order, so that a subtree is one
+  contiguous range. Transition maps are rebuilt in the same order,
+  and the values are reordered like their end States, so that the
+  value index of an end State is its rank among the end States.
+  Keys and values are not changed; the Tri can still be inserted into
+  afterwards, but new States are appended at the end. Call this once
+  after building the Tri.
+*/
+	void compact();
+
+/*! Stores the values in 16 bits each.
+
+  Probabilities in a corpus take few distinct values (the log of
+  word count over corpus size), so every value is replaced by its
+  index into a sorted codebook of the distinct values. With up to
+  quantizeLevels distinct values this is exact. With more, the
+  codebook holds quantizeLevels evenly spaced values between the
+  smallest and the largest, and every value is rounded to the nearest
+  one: it changes by at most (largest - smallest) / (2 *
+  (quantizeLevels - 1)), and the order of two values can only turn into
+  a tie, never be reversed. Only for arithmetic value types. Inserting
+  into a quantized Tri turns the codes back into values first.
+*/
+	void quantize();
+
+/*! Prepares complete and tolerantFindNearest : finds, for every
+ *  State, the most valuable key that passes through it, and orders
+ *  the transitions of every State by it.
+
+ One pass over the States, from the last name to the first; the
+ names of children are always greater than the name of their parent,
+ after insert as after compact . Needs 4 bytes per State. The
+ transitions of a State are sorted by the value of the best key below
+ them, greatest first (by character where that is equal), so that
+ searches that go through them in order reach the probable keys
+ first; lookups by character stay as fast. Call this once after
+ building the Tri, after compact and quantize ; insert and compact
+ drop the index, and compact puts the transitions back in the order
+ of their characters.
+*/
+	void indexCompletions();
+
+/*! Finds the most valuable keys that start with a prefix, or with a
+ *  string a few edit operations away from it.
+
+ Typeahead with typo tolerance. For 0, 1, ... maxEdits edit
+ operations (insertions, deletions, substitutions and transpositions
+ of neighbouring characters, like CorrectionSearcher) in turn, the
+ States whose path matches the whole prefix with that many are found,
+ walking the Tri with one row of edit distances per level; below a
+ State that matches with d edits, only States that can match with
+ fewer are visited. The keys below those States are taken best first
+ from a priority queue of subtrees, each ranked by the most valuable
+ key in it (see indexCompletions ), so only the branches that lead to
+ one of the k results are opened, not whole subtrees. Once there are
+ k keys, no more edits are tried: for a prefix that is typed
+ correctly and has k completions, maxEdits costs nothing.
+ \param prefix The beginning of a key, as typed so far.
+ \param k The number of keys to return.
+ \param maxEdits The number of edit operations between the prefix
+ and the beginning of a key.
+ \return At most k TolerantResults, ranked by the edit operations
+ needed for the prefix, fewest first, then by value, greatest first;
+ a key is returned once, with its fewest edit operations. Throws
+ std::runtime_error if indexCompletions was not called after the
+ Tri was last changed.
+*/
+	std::vector<TolerantResult> complete(const std::string& prefix, const unsigned int k, const unsigned int maxEdits) const;
+
+/*! Returns the number of bytes allocated for the values: the value
+ *  array, or the codes and the codebook of a quantized Tri. */
+	std::size_t getValueBytes() const {
+		return _values.capacity() * sizeof(value_T) + _codes.capacity() * sizeof(std::uint16_t)
+			+ _codebook.capacity() * sizeof(value_T);
+	}
+/*! The States by the NodeType of their transitions, see Transitions :
+ *  how many of them there are, and the bytes their nodes take on the
+ *  heap. */
+	struct NodeStats {
+		unsigned long states[nodeTypes]; /*!< States by NodeType. */
+		std::size_t heapBytes[nodeTypes]; /*!< Their nodes on the heap. */
+	};
+//! Counts the States by the NodeType of their transitions.
+	NodeStats getNodeStats() const {
+		NodeStats stats = {};
+		for(auto s(_v.cbegin()); s != _v.cend(); ++s) {
+			const unsigned int type(static_cast<unsigned int>(s->transitions.type()));
+			++stats.states[type];
+			stats.heapBytes[type] += s->transitions.getHeapBytes();
+		}
+		return stats;
+	}
+
+private:
+/*! Turns the results of a Searcher into TolerantResults by looking
+ *  up the values of the states they were found in. */
+	std::vector<TolerantResult> _package(const typename CorrectionSearcher::result_type& intermediateResults) const;
+/*! Like _package , replacing the elements of a vector of the caller. */
+	void _package(const typename CorrectionSearcher::result_type& intermediateResults, std::vector<TolerantResult>& finalResults) const;
 }; // class Tri
 
 // Due to the Tri class being a template class, seperation of
@@ -5,47 +5,85 @@
 
 template <class value_T>
 Tri<value_T>::Tri()
-	: _v(), _values() {
+	: _v(), _values(), _codes(), _codebook(), _links(), _spellResults(true), _bestBelow() {
 // create new state and immediately put it in the state vector.
-	_v.push_back(std::unique_ptr<State>(new State));
+	_v.emplace_back();
+	_links.push_back(Link{0, 0});
 }
 
 template <class value_T>
-typename Tri<value_T>::state_T Tri<value_T>::_newStatef() {
+typename Tri<value_T>::state_T Tri<value_T>::_newStatef(const state_T up, const unsigned char c) {
 	unsigned int n(getStates());
 	if(n == (unsigned int)~0) {
 		// sorry we cannot deal with more states... panic
 		throw std::runtime_error("error in Tri::_newStatef: Too many states.");
 	}
 // push new state in state vector
-	_v.push_back(std::unique_ptr<State>(new State));
+	_v.emplace_back();
+	_links.push_back(Link{up, c});
 // the name of the latest state is always the size of the vector minus
 // one - but we got the size before we pushed an element so its + 1 again
 	return n;
 } // Tri ctor
 
+template <class value_T>
+void Tri<value_T>::_annotate(State& state, const unsigned int remaining, const letterMask_T letters) {
+	state.minDepth = std::min(state.minDepth, remaining);
+	state.maxDepth = std::max(state.maxDepth, remaining);
+	state.letters |= letters;
+} // _annotate
+
+template <class value_T>
+std::string Tri<value_T>::_spell(const state_T state) const {
+	std::string key;
+	for(state_T s(state); s != 0; s = _links[s].up) {
+		key.push_back(_links[s].c);
+	}
+	std::reverse(key.begin(), key.end());
+	return key;
+} // _spell
+
 template <class value_T>
 void Tri<value_T>::insert(const std::string key, const value_T& newValue) {
 	state_T currentState(0);
 	transitions_T* currentTransitions;
+	_bestBelow.clear();
+// letter sets of all suffixes of the key, so that every state on the
+// path can be annotated in a single pass
+	std::vector<letterMask_T> suffixLetters(key.size() + 1, 0);
+	for(std::size_t i(key.size()); i > 0; --i) {
+		suffixLetters[i - 1] = suffixLetters[i] | letterBit(key[i - 1]);
+	}
 // iterate over input string characters
 	for(auto c(key.cbegin()); c != key.cend(); ++c) {
-		currentTransitions = &(_v[currentState]->transitions);
+		_annotate(_v[currentState], key.cend() - c, suffixLetters[c - key.cbegin()]);
+		currentTransitions = &(_v[currentState].transitions);
 		auto iter = currentTransitions->find(*c);
 		if(iter != currentTransitions->end()) {
 // there is a transition from the current state with the current
 // character to another state
 			currentState = iter->second;
 		} else {
-// no transition found, create a new state and transition to it
-			(*currentTransitions)[*c] = currentState = _newStatef();
+// no transition found, create a new state and transition to it; the
+// new state may move the others, so look the transitions up again
+			const state_T newState(_newStatef(currentState, *c));
+			_v[currentState].transitions.insert(*c, newState);
+			currentState = newState;
 		}
 	} // for
-// set the state we are left in to be an end state
-	_v[currentState]->endState = true;
-// associate the name(number) of the current state with the value to
-// be inserted
-	_values[currentState] = newValue;
+// set the state we are left in to be an end state and associate it
+// with the value to be inserted: a new key gets the next slot of the
+// value array
+	_dequantize();
+	State& end(_v[currentState]);
+	if(end.endState) {
+		_values[end.value] = newValue;
+	} else {
+		end.endState = true;
+		end.value = _values.size();
+		_values.push_back(newValue);
+	}
+	_annotate(end, 0, 0);
 } // insert
 
 template <typename value_T>
@@ -68,7 +106,7 @@ const value_T* Tri<value_T>::unsafeGet(const std::string& key) const {
 	state_T currentState(0);
 // there is some commonality between get and insert, this could be refactored.
 	for(auto c(key.cbegin()); c != key.cend(); ++c) {
-		currentTransitions = &(_v[currentState]->transitions);
+		currentTransitions = &(_v[currentState].transitions);
 		auto iter = currentTransitions->find(*c);
 		if(iter != currentTransitions->cend()) {
 // there is a transition from the current state with the current
@@ -80,10 +118,10 @@ const value_T* Tri<value_T>::unsafeGet(const std::string& key) const {
 			return NULL;
 		}
 	} // for
-	if(_v[currentState]->endState) {
+	if(_v[currentState].endState) {
 // entire input String consumed - and the resulting state is an end
 // state - return the value!
-		return &(_values.find(currentState)->second);
+		return &_value(currentState);
 	} else {
 		// the input string was consumed, but the state we
 		// ended up in happens not to be an end state. Sorry,
@@ -91,56 +129,524 @@ const value_T* Tri<value_T>::unsafeGet(const std::string& key) const {
 		return NULL;
 	}
 } // unsafe_get
+
+template <class value_T>
+unsigned int Tri<value_T>::indexOf(const std::string& key) const {
+	state_T currentState(0);
+	for(auto c(key.cbegin()); c != key.cend(); ++c) {
+		const transitions_T& t(_v[currentState].transitions);
+		auto iter(t.find(*c));
+		if(iter == t.cend()) {
+			return noKey;
+		}
+		currentState = iter->second;
+	}
+	return _v[currentState].endState ? _v[currentState].value : noKey;
+} // indexOf
+
+template <class value_T>
+std::vector<std::string> Tri<value_T>::keys() const {
+	std::vector<std::string> k(getKeys());
+	for(state_T s(0); s < _v.size(); ++s) {
+		if(_v[s].endState) {
+			k[_v[s].value] = _spell(s);
+		}
+	}
+	return k;
+} // keys
 	
 template <class value_T>
 unsigned int Tri<value_T>::getStates() const {
 	return _v.size();
 } // getStates
 
+template <class value_T>
+void Tri<value_T>::compact() {
+	std::vector<state_T> order;
+	order.reserve(_v.size());
+// breadth-first through the top levels; level holds the states of
+// one depth, in order
+	std::vector<state_T> level(1, 0);
+	for(unsigned int depth(0); depth < compactBreadthDepth && !level.empty(); ++depth) {
+		std::vector<state_T> next;
+		for(auto s(level.cbegin()); s != level.cend(); ++s) {
+			order.push_back(*s);
+			const transitions_T& t(_v[*s].transitions);
+			for(auto i(t.cbegin()); i != t.cend(); ++i) {
+				next.push_back(i->second);
+			}
+		}
+		level.swap(next);
+	} // for depth
+// depth-first below, one subtree after the other; children are pushed
+// in reverse so they come out in the order of their transitions
+	std::vector<state_T> stack;
+	for(auto root(level.cbegin()); root != level.cend(); ++root) {
+		for(stack.push_back(*root); !stack.empty();) {
+			const state_T s(stack.back());
+			stack.pop_back();
+			order.push_back(s);
+			const transitions_T& t(_v[s].transitions);
+			for(auto i(t.crbegin()); i != t.crend(); ++i) {
+				stack.push_back(i->second);
+			}
+		}
+	} // for root
+
+	std::vector<state_T> newName(_v.size());
+	for(state_T n(0); n < order.size(); ++n) {
+		newName[order[n]] = n;
+	}
+// copying the States allocates the nodes of their transitions in the
+// new order as well
+	std::vector<State> v;
+	v.reserve(_v.size());
+	std::vector<Link> links(_v.size(), Link{0, 0});
+// old value indices in the new order of the end states
+	std::vector<unsigned int> valueOrder;
+	valueOrder.reserve(_values.size() + _codes.size());
+	for(auto o(order.cbegin()); o != order.cend(); ++o) {
+		const State& old(_v[*o]);
+		v.emplace_back();
+		State& s(v.back());
+		s.endState = old.endState;
+		if(old.endState) {
+			s.value = valueOrder.size();
+			valueOrder.push_back(old.value);
+		}
+		s.minDepth = old.minDepth;
+		s.maxDepth = old.maxDepth;
+		s.letters = old.letters;
+		const transitions_T& t(old.transitions);
+		for(auto i(t.cbegin()); i != t.cend(); ++i) {
+			s.transitions.insert(i->first, newName[i->second]);
+			links[newName[i->second]] = Link{state_T(v.size() - 1), i->first};
+		}
+	} // for
+	if(_codebook.empty()) {
+		std::vector<value_T> values;
+		values.reserve(valueOrder.size());
+		for(auto i(valueOrder.cbegin()); i != valueOrder.cend(); ++i) {
+			values.push_back(std::move(_values[*i]));
+		}
+		_values.swap(values);
+	} else {
+		std::vector<std::uint16_t> codes;
+		codes.reserve(valueOrder.size());
+		for(auto i(valueOrder.cbegin()); i != valueOrder.cend(); ++i) {
+			codes.push_back(_codes[*i]);
+		}
+		_codes.swap(codes);
+	}
+	_v.swap(v);
+	_links.swap(links);
+	_bestBelow.clear();
+} // compact
+
+template <class value_T>
+void Tri<value_T>::quantize() {
+	static_assert(std::is_arithmetic<value_T>::value, "Tri::quantize needs an arithmetic value type.");
+	if(!_codebook.empty() || _values.empty()) {
+		return;
+	}
+	std::vector<value_T> codebook(_values);
+	std::sort(codebook.begin(), codebook.end());
+	codebook.erase(std::unique(codebook.begin(), codebook.end()), codebook.end());
+	std::vector<std::uint16_t> codes;
+	codes.reserve(_values.size());
+	if(codebook.size() <= quantizeLevels) {
+		for(auto i(_values.cbegin()); i != _values.cend(); ++i) {
+			codes.push_back(std::lower_bound(codebook.cbegin(), codebook.cend(), *i) - codebook.cbegin());
+		}
+	} else {
+// too many distinct values; round to evenly spaced levels instead
+		const double low(codebook.front());
+		const double step((double(codebook.back()) - low) / (quantizeLevels - 1));
+		for(auto i(_values.cbegin()); i != _values.cend(); ++i) {
+			codes.push_back((std::uint16_t)std::llround((*i - low) / step));
+		}
+		codebook.resize(quantizeLevels);
+		for(unsigned int c(0); c < quantizeLevels; ++c) {
+			codebook[c] = value_T(low + c * step);
+		}
+	}
+	codebook.shrink_to_fit();
+	_codebook.swap(codebook);
+	_codes.swap(codes);
+	std::vector<value_T>().swap(_values);
+} // quantize
+
+template <class value_T>
+void Tri<value_T>::_dequantize() {
+	if(_codebook.empty()) {
+		return;
+	}
+	_values.reserve(_codes.size());
+	for(auto c(_codes.cbegin()); c != _codes.cend(); ++c) {
+		_values.push_back(_codebook[*c]);
+	}
+	std::vector<std::uint16_t>().swap(_codes);
+	std::vector<value_T>().swap(_codebook);
+} // _dequantize
+
 template <typename value_T>
 template <typename derived_T>
-std::vector<typename Tri<value_T>::TolerantResult> Tri<value_T>::tolerantFindWith(Searcher<derived_T>& searchf) const {
-
-// the stack is maintained here, the searcher does not do anything
-// except push things onto it
-/// \todo stack is using unique_ptr because we have to pass items
-// around. This is nice and safe, but probably a bad idea.
-// the Searcher exports an item type, which is the type of things we
-// store on the stack
-	std::stack< std::unique_ptr<typename Searcher<derived_T>::template item<State>::type>> s;
-// Searcher also provides a seed item to start with
-	for(s.push(std::move(searchf.initialItem(0, _v))); !s.empty();) {
-// now we just do a depth-first search of a graph, hoping that it will terminate
-		std::unique_ptr<typename Searcher<derived_T>::template item<State>::type> top = std::move(s.top());
+void Tri<value_T>::_runSearch(Searcher<derived_T>& searchf, typename Searcher<derived_T>::template stack<State>::type& s) const {
+	while(!s.empty()) {
+// now we just do a depth-first search of a graph, hoping that it will
+// terminate; the top is copied, as pushing may move the stack
+		const typename Searcher<derived_T>::template item<State>::type top(s.top());
 		s.pop();
 // this will put new items onto the stack
-		searchf.feedStack(s, _v, *top);
+		searchf.feedStack(s, _v, top);
 	}
-	// extract values for states and package up results
-	const typename Searcher<derived_T>::result_type intermediateResults(searchf.getResults());
+} // _runSearch
+
+template <typename value_T>
+std::vector<typename Tri<value_T>::TolerantResult> Tri<value_T>::_package(const typename CorrectionSearcher::result_type& intermediateResults) const {
 	std::vector<Tri<value_T>::TolerantResult> finalResults;
+	_package(intermediateResults, finalResults);
+	return finalResults;
+} // _package
+
+template <typename value_T>
+void Tri<value_T>::_package(const typename CorrectionSearcher::result_type& intermediateResults, std::vector<TolerantResult>& finalResults) const {
+	finalResults.clear();
+	finalResults.reserve(intermediateResults.size());
 // the Searcher does not need access to the Tris internal associated
 // values, so it only returns the state numbers of found keys, which
 // we use to extract the real values.
-	for(auto kv(intermediateResults.cbegin()); kv != intermediateResults.cend(); ++kv) {
-		finalResults.push_back(TolerantResult(kv->first, _values.at(kv->second.first), kv->second.second));
+	for(auto hit(intermediateResults.cbegin()); hit != intermediateResults.cend(); ++hit) {
+		finalResults.emplace_back(_spellResults ? _spell(hit->state) : std::string(), _value(hit->state),
+					  hit->editDistance, hit->cost);
+		finalResults.back().index = _v[hit->state].value;
 	}
-	return std::move(finalResults);
+} // _package
+
+template <typename value_T>
+template <typename derived_T>
+std::vector<typename Tri<value_T>::TolerantResult> Tri<value_T>::tolerantFindWith(Searcher<derived_T>& searchf) const {
+
+// the stack is maintained here, the searcher does not do anything
+// except push things onto it
+// the Searcher exports a stack type for its items
+	typename Searcher<derived_T>::template stack<State>::type s;
+// Searcher also provides a seed item to start with
+	s.push(searchf.initialItem(0, _v));
+	_runSearch(searchf, s);
+	// extract values for states and package up results
+	return _package(searchf.getResults());
 } // tolerantFindWith
 
+template <typename value_T>
+template <typename derived_T>
+std::vector<typename Tri<value_T>::TolerantResult> Tri<value_T>::tolerantFindWithin(Searcher<derived_T>& searchf, SearchBudget& budget) const {
+	return tolerantFindNearest(searchf, 0, &budget);
+} // tolerantFindWithin
+
+template <typename value_T>
+template <typename derived_T>
+std::vector<typename Tri<value_T>::TolerantResult> Tri<value_T>::tolerantFindNearest(Searcher<derived_T>& searchf, const unsigned int wanted, SearchBudget* budget) const {
+	typedef typename Searcher<derived_T>::template stack<State>::type stack_T;
+// a deque, because growing it never moves the stacks
+	std::deque<stack_T> byDistance(1);
+	byDistance[0].push(searchf.initialItem(0, _v));
+// the searcher pushes onto this; its items are then sorted into the
+// stacks by edit distance
+	stack_T fresh;
+	const bool timed(budget && budget->deadline != std::chrono::steady_clock::time_point::max());
+	const unsigned long maxItems(budget ? budget->maxItems : 0);
+	unsigned long expanded(0);
+// only unit edit costs rank keys by edit distance and then value; the
+// keys found at distance d are the results from seen on
+	const bool bounded(wanted && std::is_same<derived_T, CorrectionSearcher>::value);
+// items are only dropped by the best key below them with an index
+	const bool indexed(bounded && !_bestBelow.empty());
+	const SearchResults& results(searchf.getResults());
+	std::size_t need(wanted), seen(0);
+// the values of the best keys found at distance d, at most need, as a
+// heap with the least on top
+	std::vector<value_T> kept;
+	auto greater = [](const value_T& a, const value_T& b) { return b < a; };
+	for(unsigned int d(0); d < byDistance.size();) {
+		if(byDistance[d].empty()) {
+// every key within d edits has been found; the next distance can only
+// add keys that rank below them
+			if(wanted && results.size() >= wanted) {
+				break;
+			}
+			if(++d < byDistance.size() && bounded) {
+				need = wanted - results.size();
+				seen = results.size();
+				kept.clear();
+			}
+			continue;
+		}
+		if((maxItems && expanded >= maxItems)
+		   || (timed && expanded % budgetClockInterval == 0 && std::chrono::steady_clock::now() >= budget->deadline)) {
+			budget->exhausted = true;
+			budget->completeBelow = std::min(budget->completeBelow, d);
+			break;
+		}
+		const typename Searcher<derived_T>::template item<State>::type top(byDistance[d].top());
+		byDistance[d].pop();
+		if(indexed && kept.size() == need && _value(_bestBelow[top.state]) < kept.front()) {
+			continue;
+		}
+		++expanded;
+		searchf.feedStack(fresh, _v, top);
+		while(!fresh.empty()) {
+			const unsigned int e(fresh.top().editDistance);
+			if(e >= byDistance.size()) {
+				byDistance.resize(e + 1);
+			}
+			byDistance[e].push(fresh.top());
+			fresh.pop();
+		}
+		for(; bounded && seen < results.size(); ++seen) {
+			const value_T& value(_value((results.cbegin() + seen)->state));
+			if(kept.size() < need) {
+				kept.push_back(value);
+				std::push_heap(kept.begin(), kept.end(), greater);
+			} else if(kept.front() < value) {
+				std::pop_heap(kept.begin(), kept.end(), greater);
+				kept.back() = value;
+				std::push_heap(kept.begin(), kept.end(), greater);
+			}
+// the search stops after this distance
+			if(kept.size() == need) {
+				_lowerCutoff(static_cast<derived_T&>(searchf), d);
+			}
+		}
+	} // for
+	return _package(searchf.getResults());
+} // tolerantFindNearest
+
+template <typename value_T>
+std::vector<typename Tri<value_T>::TolerantResult> Tri<value_T>::tolerantFindParallel(const std::string& key, const unsigned int editDistance, ThreadPool& pool) const {
+	typedef CorrectionSearcher::item<State> item_T;
+	if(pool.size() < 2 || editDistance < parallelMinDistance) {
+		return tolerantFind(key, editDistance);
+	}
+// expand the top of the Tri on this thread; items that are deep
+// enough become the frontier that is shared out
+	CorrectionSearcher root(key, editDistance);
+	CorrectionSearcher::itemStack<State> s;
+	std::vector<item_T> frontier;
+	for(s.push(root.initialItem(0, _v)); !s.empty();) {
+		const item_T top(s.top());
+		s.pop();
+		if(top.depth >= parallelSplitDepth) {
+			frontier.push_back(top);
+		} else {
+			root.feedStack(s, _v, top);
+		}
+	}
+	if(frontier.size() < parallelMinFrontier) {
+// not worth the synchronization; finish on this thread
+		for(auto i(frontier.cbegin()); i != frontier.cend(); ++i) {
+			s.push(*i);
+		}
+		_runSearch(root, s);
+		return _package(root.getResults());
+	}
+
+// items next to each other in the frontier tend to have subtrees of
+// similar size, so they are dealt out round-robin
+	const std::size_t taskCount(std::min<std::size_t>(frontier.size(), 4 * pool.size()));
+	std::vector<std::unique_ptr<CorrectionSearcher>> searchers(taskCount);
+	std::vector<ThreadPool::task_T> tasks;
+	for(std::size_t t(0); t < taskCount; ++t) {
+		tasks.push_back([&, t]() {
+				searchers[t].reset(new CorrectionSearcher(key, editDistance));
+				CorrectionSearcher::itemStack<State> own;
+				for(std::size_t i(t); i < frontier.size(); i += taskCount) {
+					own.push(searchers[t]->adopt(frontier[i], root));
+				}
+				_runSearch(*searchers[t], own);
+			});
+	}
+	pool.run(tasks);
+
+// merge per-task results, keeping the lowest edit distance per key
+	CorrectionSearcher::result_type merged(root.getResults());
+	for(auto w(searchers.cbegin()); w != searchers.cend(); ++w) {
+		const auto& results((*w)->getResults());
+		for(auto hit(results.cbegin()); hit != results.cend(); ++hit) {
+			SearchHit* found(merged.find(hit->state));
+			if(!found) {
+				merged.insert(*hit);
+			} else if(found->cost > hit->cost) {
+				*found = *hit;
+			}
+		}
+	}
+	return _package(merged);
+} // tolerantFindParallel
+
+template <class value_T>
+void Tri<value_T>::indexCompletions() {
+	_bestBelow.assign(_v.size(), noKey);
+// children have greater names than their parents, so every subtree is
+// done before the State above it
+	for(state_T s(_v.size()); s-- > 0;) {
+		State& state(_v[s]);
+		state_T best(state.endState ? s : noKey);
+		for(auto t(state.transitions.cbegin()); t != state.transitions.cend(); ++t) {
+			const state_T below(_bestBelow[t->second]);
+			if(below != noKey && (best == noKey || _value(best) < _value(below))) {
+				best = below;
+			}
+		}
+		_bestBelow[s] = best;
+// every key lies below one of its States, so no child is noKey
+		state.transitions.sort([this](const typename transitions_T::value_type& a, const typename transitions_T::value_type& b) {
+				const value_T& va(_value(_bestBelow[a.second]));
+				const value_T& vb(_value(_bestBelow[b.second]));
+				if(va < vb || vb < va) return vb < va;
+				return a.first < b.first;
+			});
+	}
+} // indexCompletions
+
+template <class value_T>
+std::vector<typename Tri<value_T>::TolerantResult> Tri<value_T>::complete(const std::string& prefix, const unsigned int k, const unsigned int maxEdits) const {
+	if(_bestBelow.size() != _v.size()) {
+		throw std::runtime_error("error in Tri::complete: The Tri has changed since indexCompletions.");
+	}
+	std::vector<TolerantResult> results;
+// without keys, not even the start State has a best key
+	if(k == 0 || _bestBelow[0] == noKey) {
+		return results;
+	}
+// a subtree, or a single key, that the prefix matches with a number of
+// edits
+	struct Candidate {
+		unsigned int edits; /*!< Edit operations for the prefix. */
+		value_T value; /*!< The value of the best key in it. */
+		bool key; /*!< Whether this is just the key of state. */
+		state_T state; /*!< The root of the subtree, or the end
+				 State of the key. */
+	};
+// fewest edits first, then the greatest value; a key before a subtree
+// whose best key is just as good
+	auto worse = [](const Candidate& a, const Candidate& b) {
+		if(a.edits != b.edits) return a.edits > b.edits;
+		if(a.value < b.value || b.value < a.value) return a.value < b.value;
+		if(a.key != b.key) return b.key;
+		return a.state > b.state;
+	};
+	std::priority_queue<Candidate, std::vector<Candidate>, decltype(worse)> queue(worse);
+	std::vector<state_T> found;
+
+	const std::size_t n(prefix.size());
+// optimal string alignment distances between the prefix and the path
+// of the State being visited, one row per depth; the rows above it
+// are the ones of its ancestors
+	std::vector<std::vector<unsigned int>> rows(1, std::vector<unsigned int>(n + 1));
+	for(std::size_t j(0); j <= n; ++j) {
+		rows[0][j] = j;
+	}
+	std::string path;
+// bound: the edits of the closest match above the State, or more than
+// the edits searched for; only better matches are worth visiting
+	struct Step {
+		state_T state;
+		unsigned int depth;
+		unsigned char c;
+		unsigned int bound;
+	};
+	std::vector<Step> stack;
+// keys with more edits always rank below, so the matches of one number
+// of edits are only looked for if those with fewer did not give k keys
+	for(unsigned int edits(0); edits <= maxEdits && results.size() < k; ++edits) {
+		const unsigned int rootBound(n <= edits ? n : edits + 1);
+		if(n == edits) {
+			queue.push(Candidate{edits, _value(_bestBelow[0]), false, 0});
+		}
+		for(auto t(_v[0].transitions.crbegin()); t != _v[0].transitions.crend(); ++t) {
+			stack.push_back(Step{t->second, 1, t->first, rootBound});
+		}
+		while(!stack.empty()) {
+			const Step step(stack.back());
+			stack.pop_back();
+			if(rows.size() <= step.depth) {
+				rows.emplace_back(n + 1);
+			}
+			path.resize(step.depth);
+			path[step.depth - 1] = step.c;
+			const std::vector<unsigned int>& above(rows[step.depth - 1]);
+			std::vector<unsigned int>& row(rows[step.depth]);
+			row[0] = step.depth;
+			unsigned int least(row[0]);
+			for(std::size_t j(1); j <= n; ++j) {
+				unsigned int d(std::min(above[j - 1] + (prefix[j - 1] != (char)step.c), std::min(above[j], row[j - 1]) + 1));
+				if(step.depth > 1 && j > 1 && prefix[j - 1] == path[step.depth - 2] && prefix[j - 2] == (char)step.c) {
+					d = std::min(d, rows[step.depth - 2][j - 2] + 1);
+				}
+				row[j] = d;
+				least = std::min(least, d);
+			}
+			unsigned int bound(step.bound);
+			if(row[n] < bound) {
+				bound = row[n];
+				if(row[n] == edits) {
+					queue.push(Candidate{edits, _value(_bestBelow[step.state]), false, step.state});
+				}
+			}
+// the least distance of a row never shrinks further down
+			if(least < bound) {
+				const transitions_T& t(_v[step.state].transitions);
+				for(auto i(t.crbegin()); i != t.crend(); ++i) {
+					stack.push_back(Step{i->second, step.depth + 1, i->first, bound});
+				}
+			}
+		} // while stack
+
+		while(!queue.empty() && results.size() < k) {
+			const Candidate top(queue.top());
+			queue.pop();
+			if(top.key) {
+// a key below two matches comes out with the fewest edits first
+				if(std::find(found.cbegin(), found.cend(), top.state) == found.cend()) {
+					found.push_back(top.state);
+					results.emplace_back(_spellResults ? _spell(top.state) : std::string(), top.value, top.edits);
+					results.back().index = _v[top.state].value;
+				}
+				continue;
+			}
+			const State& state(_v[top.state]);
+			if(state.endState) {
+				queue.push(Candidate{top.edits, _value(top.state), true, top.state});
+			}
+			for(auto t(state.transitions.cbegin()); t != state.transitions.cend(); ++t) {
+				queue.push(Candidate{top.edits, _value(_bestBelow[t->second]), false, t->second});
+			}
+		} // while queue
+	} // for edits
+	return results;
+} // complete
+
 template <typename value_T>
 Tri<value_T> Tri<value_T>::makeCopy() const {
 	Tri<value_T> newTri;
 // careful, tri always has startstate 0 on creation
-	newTri._v[0] = std::unique_ptr<State>(&((new State)->copyFrom(*_v[0])));
+	newTri._v[0].copyFrom(_v[0]);
 // deep copy all the states, skip the first one
+	newTri._v.reserve(_v.size());
 	for(auto i(std::next(_v.cbegin())); i != _v.cend(); ++i) {
-		newTri._v.push_back(std::unique_ptr<State>((&(new State)->copyFrom(**i))));
+		newTri._v.emplace_back();
+		newTri._v.back().copyFrom(*i);
 	}
 
-// this will call the copy assignment operator of unordered_map
+// this will call the copy assignment operator of the values
 	newTri._values = _values;
-	return std::move(newTri);
+	newTri._codes = _codes;
+	newTri._codebook = _codebook;
+	newTri._links = _links;
+	newTri._spellResults = _spellResults;
+	newTri._bestBelow = _bestBelow;
+	return newTri;
 } // makeCopy
 
 template <typename value_T>
@@ -148,4 +654,13 @@ std::vector<typename Tri<value_T>::TolerantResult> Tri<value_T>::tolerantFind(co
 	std::unique_ptr<CorrectionSearcher> searchf(new CorrectionSearcher(key, editDistance));
 	return tolerantFindWith(*searchf);
 } // tolerantFind
+
+template <typename value_T>
+void Tri<value_T>::tolerantFind(const std::string& key, const unsigned int editDistance, Scratch& scratch, std::vector<TolerantResult>& results) const {
+	CorrectionSearcher& searchf(*scratch._searcher);
+	searchf.reset(key, editDistance);
+	scratch._stack.push(searchf.initialItem(0, _v));
+	_runSearch(searchf, scratch._stack);
+	_package(searchf.getResults(), results);
+} // tolerantFind
 	
@@ -0,0 +1,257 @@
+
+#include "Utf8.hpp"
+#include <algorithm>
+
+namespace {
+//! A base letter, a combining mark and the letter that composes both.
+struct Composition {
+	char32_t base; /*!< The base letter. */
+	char32_t mark; /*!< The combining mark following it. */
+	char32_t composed; /*!< The precomposed letter. */
+};
+
+/*! Canonical compositions of the ASCII letters with the common
+ *  combining marks, sorted by base letter and mark; written from the
+ *  Unicode character database with Python's unicodedata.normalize. */
+const Composition compositions[] = {
+	{0x41, 0x300, 0x0C0}, {0x41, 0x301, 0x0C1}, {0x41, 0x302, 0x0C2}, {0x41, 0x303, 0x0C3},
+	{0x41, 0x304, 0x100}, {0x41, 0x306, 0x102}, {0x41, 0x307, 0x226}, {0x41, 0x308, 0x0C4},
+	{0x41, 0x30A, 0x0C5}, {0x41, 0x30C, 0x1CD}, {0x41, 0x328, 0x104}, {0x43, 0x301, 0x106},
+	{0x43, 0x302, 0x108}, {0x43, 0x307, 0x10A}, {0x43, 0x30C, 0x10C}, {0x43, 0x327, 0x0C7},
+	{0x44, 0x30C, 0x10E}, {0x45, 0x300, 0x0C8}, {0x45, 0x301, 0x0C9}, {0x45, 0x302, 0x0CA},
+	{0x45, 0x304, 0x112}, {0x45, 0x306, 0x114}, {0x45, 0x307, 0x116}, {0x45, 0x308, 0x0CB},
+	{0x45, 0x30C, 0x11A}, {0x45, 0x327, 0x228}, {0x45, 0x328, 0x118}, {0x47, 0x301, 0x1F4},
+	{0x47, 0x302, 0x11C}, {0x47, 0x306, 0x11E}, {0x47, 0x307, 0x120}, {0x47, 0x30C, 0x1E6},
+	{0x47, 0x327, 0x122}, {0x48, 0x302, 0x124}, {0x48, 0x30C, 0x21E}, {0x49, 0x300, 0x0CC},
+	{0x49, 0x301, 0x0CD}, {0x49, 0x302, 0x0CE}, {0x49, 0x303, 0x128}, {0x49, 0x304, 0x12A},
+	{0x49, 0x306, 0x12C}, {0x49, 0x307, 0x130}, {0x49, 0x308, 0x0CF}, {0x49, 0x30C, 0x1CF},
+	{0x49, 0x328, 0x12E}, {0x4A, 0x302, 0x134}, {0x4B, 0x30C, 0x1E8}, {0x4B, 0x327, 0x136},
+	{0x4C, 0x301, 0x139}, {0x4C, 0x30C, 0x13D}, {0x4C, 0x327, 0x13B}, {0x4E, 0x300, 0x1F8},
+	{0x4E, 0x301, 0x143}, {0x4E, 0x303, 0x0D1}, {0x4E, 0x30C, 0x147}, {0x4E, 0x327, 0x145},
+	{0x4F, 0x300, 0x0D2}, {0x4F, 0x301, 0x0D3}, {0x4F, 0x302, 0x0D4}, {0x4F, 0x303, 0x0D5},
+	{0x4F, 0x304, 0x14C}, {0x4F, 0x306, 0x14E}, {0x4F, 0x307, 0x22E}, {0x4F, 0x308, 0x0D6},
+	{0x4F, 0x30B, 0x150}, {0x4F, 0x30C, 0x1D1}, {0x4F, 0x328, 0x1EA}, {0x52, 0x301, 0x154},
+	{0x52, 0x30C, 0x158}, {0x52, 0x327, 0x156}, {0x53, 0x301, 0x15A}, {0x53, 0x302, 0x15C},
+	{0x53, 0x30C, 0x160}, {0x53, 0x327, 0x15E}, {0x54, 0x30C, 0x164}, {0x54, 0x327, 0x162},
+	{0x55, 0x300, 0x0D9}, {0x55, 0x301, 0x0DA}, {0x55, 0x302, 0x0DB}, {0x55, 0x303, 0x168},
+	{0x55, 0x304, 0x16A}, {0x55, 0x306, 0x16C}, {0x55, 0x308, 0x0DC}, {0x55, 0x30A, 0x16E},
+	{0x55, 0x30B, 0x170}, {0x55, 0x30C, 0x1D3}, {0x55, 0x328, 0x172}, {0x57, 0x302, 0x174},
+	{0x59, 0x301, 0x0DD}, {0x59, 0x302, 0x176}, {0x59, 0x304, 0x232}, {0x59, 0x308, 0x178},
+	{0x5A, 0x301, 0x179}, {0x5A, 0x307, 0x17B}, {0x5A, 0x30C, 0x17D}, {0x61, 0x300, 0x0E0},
+	{0x61, 0x301, 0x0E1}, {0x61, 0x302, 0x0E2}, {0x61, 0x303, 0x0E3}, {0x61, 0x304, 0x101},
+	{0x61, 0x306, 0x103}, {0x61, 0x307, 0x227}, {0x61, 0x308, 0x0E4}, {0x61, 0x30A, 0x0E5},
+	{0x61, 0x30C, 0x1CE}, {0x61, 0x328, 0x105}, {0x63, 0x301, 0x107}, {0x63, 0x302, 0x109},
+	{0x63, 0x307, 0x10B}, {0x63, 0x30C, 0x10D}, {0x63, 0x327, 0x0E7}, {0x64, 0x30C, 0x10F},
+	{0x65, 0x300, 0x0E8}, {0x65, 0x301, 0x0E9}, {0x65, 0x302, 0x0EA}, {0x65, 0x304, 0x113},
+	{0x65, 0x306, 0x115}, {0x65, 0x307, 0x117}, {0x65, 0x308, 0x0EB}, {0x65, 0x30C, 0x11B},
+	{0x65, 0x327, 0x229}, {0x65, 0x328, 0x119}, {0x67, 0x301, 0x1F5}, {0x67, 0x302, 0x11D},
+	{0x67, 0x306, 0x11F}, {0x67, 0x307, 0x121}, {0x67, 0x30C, 0x1E7}, {0x67, 0x327, 0x123},
+	{0x68, 0x302, 0x125}, {0x68, 0x30C, 0x21F}, {0x69, 0x300, 0x0EC}, {0x69, 0x301, 0x0ED},
+	{0x69, 0x302, 0x0EE}, {0x69, 0x303, 0x129}, {0x69, 0x304, 0x12B}, {0x69, 0x306, 0x12D},
+	{0x69, 0x308, 0x0EF}, {0x69, 0x30C, 0x1D0}, {0x69, 0x328, 0x12F}, {0x6A, 0x302, 0x135},
+	{0x6A, 0x30C, 0x1F0}, {0x6B, 0x30C, 0x1E9}, {0x6B, 0x327, 0x137}, {0x6C, 0x301, 0x13A},
+	{0x6C, 0x30C, 0x13E}, {0x6C, 0x327, 0x13C}, {0x6E, 0x300, 0x1F9}, {0x6E, 0x301, 0x144},
+	{0x6E, 0x303, 0x0F1}, {0x6E, 0x30C, 0x148}, {0x6E, 0x327, 0x146}, {0x6F, 0x300, 0x0F2},
+	{0x6F, 0x301, 0x0F3}, {0x6F, 0x302, 0x0F4}, {0x6F, 0x303, 0x0F5}, {0x6F, 0x304, 0x14D},
+	{0x6F, 0x306, 0x14F}, {0x6F, 0x307, 0x22F}, {0x6F, 0x308, 0x0F6}, {0x6F, 0x30B, 0x151},
+	{0x6F, 0x30C, 0x1D2}, {0x6F, 0x328, 0x1EB}, {0x72, 0x301, 0x155}, {0x72, 0x30C, 0x159},
+	{0x72, 0x327, 0x157}, {0x73, 0x301, 0x15B}, {0x73, 0x302, 0x15D}, {0x73, 0x30C, 0x161},
+	{0x73, 0x327, 0x15F}, {0x74, 0x30C, 0x165}, {0x74, 0x327, 0x163}, {0x75, 0x300, 0x0F9},
+	{0x75, 0x301, 0x0FA}, {0x75, 0x302, 0x0FB}, {0x75, 0x303, 0x169}, {0x75, 0x304, 0x16B},
+	{0x75, 0x306, 0x16D}, {0x75, 0x308, 0x0FC}, {0x75, 0x30A, 0x16F}, {0x75, 0x30B, 0x171},
+	{0x75, 0x30C, 0x1D4}, {0x75, 0x328, 0x173}, {0x77, 0x302, 0x175}, {0x79, 0x301, 0x0FD},
+	{0x79, 0x302, 0x177}, {0x79, 0x304, 0x233}, {0x79, 0x308, 0x0FF}, {0x7A, 0x301, 0x17A},
+	{0x7A, 0x307, 0x17C}, {0x7A, 0x30C, 0x17E},
+};
+
+bool operator<(const Composition& c, const std::pair<char32_t, char32_t>& key) {
+	return c.base < key.first || (c.base == key.first && c.mark < key.second);
+}
+} // namespace
+
+/*! Overlong encodings, surrogates and code points beyond U+10FFFF are
+ *  malformed, as are truncated sequences.
+ \param i Points to the first byte of a code point; advanced past it,
+ or by one byte if the sequence is malformed.
+ \param end The end of the string.
+ \param codePoint Set to the decoded code point.
+ \return False if the bytes at i are not well-formed UTF-8.
+*/
+bool Utf8::next(std::string::const_iterator& i, const std::string::const_iterator end, char32_t& codePoint) {
+	const unsigned char lead(*i++);
+	if(lead < 0x80) {
+		codePoint = lead;
+		return true;
+	}
+	unsigned int length;
+	char32_t minimum;
+	if((lead & 0xE0) == 0xC0) {
+		length = 1;
+		minimum = 0x80;
+		codePoint = lead & 0x1F;
+	} else if((lead & 0xF0) == 0xE0) {
+		length = 2;
+		minimum = 0x800;
+		codePoint = lead & 0x0F;
+	} else if((lead & 0xF8) == 0xF0) {
+		length = 3;
+		minimum = 0x10000;
+		codePoint = lead & 0x07;
+	} else {
+		return false;
+	}
+	auto j(i);
+	for(unsigned int k(0); k < length; ++k, ++j) {
+		if(j == end || ((unsigned char)*j & 0xC0) != 0x80) {
+			return false;
+		}
+		codePoint = (codePoint << 6) | ((unsigned char)*j & 0x3F);
+	}
+	if(codePoint < minimum || codePoint > 0x10FFFF || (codePoint >= 0xD800 && codePoint <= 0xDFFF)) {
+		return false;
+	}
+	i = j;
+	return true;
+} // next
+
+void Utf8::append(std::string& s, const char32_t codePoint) {
+	if(codePoint < 0x80) {
+		s.push_back(char(codePoint));
+	} else if(codePoint < 0x800) {
+		s.push_back(char(0xC0 | (codePoint >> 6)));
+		s.push_back(char(0x80 | (codePoint & 0x3F)));
+	} else if(codePoint < 0x10000) {
+		s.push_back(char(0xE0 | (codePoint >> 12)));
+		s.push_back(char(0x80 | ((codePoint >> 6) & 0x3F)));
+		s.push_back(char(0x80 | (codePoint & 0x3F)));
+	} else {
+		s.push_back(char(0xF0 | (codePoint >> 18)));
+		s.push_back(char(0x80 | ((codePoint >> 12) & 0x3F)));
+		s.push_back(char(0x80 | ((codePoint >> 6) & 0x3F)));
+		s.push_back(char(0x80 | (codePoint & 0x3F)));
+	}
+} // append
+
+/*! Letters are the ASCII letters and the letters of the Latin-1,
+ *  Latin Extended-A/B, Greek and Cyrillic blocks; this covers the
+ *  languages of the corpora in data/, not all of Unicode. */
+bool Utf8::isLetter(const char32_t c) {
+	if(c < 0x80) {
+		return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+	}
+	return c == 0xAA || c == 0xB5 || c == 0xBA
+		|| (c >= 0xC0 && c <= 0x24F && c != 0xD7 && c != 0xF7)
+		|| c == 0x386 || (c >= 0x388 && c <= 0x3FF && c != 0x38B && c != 0x38D && c != 0x3A2)
+		|| (c >= 0x400 && c <= 0x481) || (c >= 0x48A && c <= 0x52F);
+} // isLetter
+
+bool Utf8::isMark(const char32_t c) {
+	return c >= 0x300 && c <= 0x36F;
+} // isMark
+
+/*! Simple (one to one) case folding for the blocks of isLetter; the
+ *  German sharp s stays as it is. */
+char32_t Utf8::foldCase(const char32_t c) {
+	if(c < 0x80) {
+		return c >= 'A' && c <= 'Z' ? c + 0x20 : c;
+	}
+	if(c >= 0xC0 && c <= 0xDE && c != 0xD7) {
+		return c + 0x20;
+	}
+	if(c >= 0x100 && c <= 0x17F) {
+// pairs of upper and lower case letters; most start on an even code
+// point, the runs around 0x140 and 0x17A on an odd one
+		if(c == 0x130) return 'i';
+		if(c == 0x178) return 0xFF;
+		if((c >= 0x139 && c <= 0x148) || (c >= 0x179 && c <= 0x17E)) {
+			return c % 2 == 1 ? c + 1 : c;
+		}
+		if(c < 0x138 || (c >= 0x14A && c <= 0x177)) {
+			return c % 2 == 0 ? c + 1 : c;
+		}
+		return c;
+	}
+	if(c >= 0x391 && c <= 0x3AB && c != 0x3A2) {
+		return c + 0x20;
+	}
+	if(c >= 0x410 && c <= 0x42F) {
+		return c + 0x20;
+	}
+	if(c >= 0x400 && c <= 0x40F) {
+		return c + 0x50;
+	}
+	return c;
+} // foldCase
+
+char32_t Utf8::compose(const char32_t base, const char32_t mark) {
+	const auto key(std::make_pair(base, mark));
+	const auto found(std::lower_bound(std::begin(compositions), std::end(compositions), key));
+	if(found != std::end(compositions) && found->base == base && found->mark == mark) {
+		return found->composed;
+	}
+	return 0;
+} // compose
+
+/*! Combining marks are composed with the letter before them where the
+ *  composition table has a precomposed letter, which gives the NFC
+ *  form for those letters; other marks are kept as they are.
+ \param in A UTF-8 string.
+ \param out Set to the code points of the normalized string.
+ \param foldCase Whether to fold upper case letters to lower case.
+ \return False if in is not well-formed UTF-8; out is then undefined.
+*/
+bool Utf8::normalize(const std::string& in, std::u32string& out, const bool foldCase) {
+	out.clear();
+	out.reserve(in.size());
+	for(auto i(in.cbegin()); i != in.cend();) {
+		char32_t c;
+		if(!next(i, in.cend(), c)) {
+			return false;
+		}
+		if(isMark(c) && !out.empty()) {
+			const char32_t composed(compose(out.back(), c));
+			if(composed) {
+				out.back() = composed;
+				continue;
+			}
+		}
+		out.push_back(c);
+	} // for
+	if(foldCase) {
+		for(auto c(out.begin()); c != out.end(); ++c) {
+			*c = Utf8::foldCase(*c);
+		}
+	}
+	return true;
+} // normalize
+
+/*! Words are the longest runs of letters and combining marks; a mark
+ *  at the start of a run does not start a word. Everything else,
+ *  including bytes that are not valid UTF-8, separates words.
+ \param text A UTF-8 string.
+ \param words Set to the byte offset and length of every word of
+ text, in order.
+*/
+void Utf8::findWords(const std::string& text, std::vector<std::pair<std::size_t, std::size_t>>& words) {
+	words.clear();
+	std::size_t start(0), length(0);
+	for(auto i(text.cbegin()); i != text.cend();) {
+		const auto before(i);
+		char32_t c(0);
+		if(next(i, text.cend(), c) && (isLetter(c) || (isMark(c) && length > 0))) {
+			if(length == 0) {
+				start = before - text.cbegin();
+			}
+			length += i - before;
+			continue;
+		}
+// anything else ends the word; next has skipped at least one byte
+		if(length > 0) {
+			words.push_back(std::make_pair(start, length));
+			length = 0;
+		}
+	} // for
+	if(length > 0) {
+		words.push_back(std::make_pair(start, length));
+	}
+} // findWords
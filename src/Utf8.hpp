@@ -0,0 +1,36 @@
+/* Utf8.hpp
+   Decoding, encoding and normalization of UTF-8 strings.
+*/
+
+#include <string>
+#include <vector>
+#include <utility>
+
+#ifndef __UTF8_HPP__
+#define __UTF8_HPP__
+
+/*! Functions for UTF-8 text, as far as dictionaries and queries need
+ *  them: code point decoding and encoding, letter classes, simple
+ *  case folding and the composition of letters with combining marks.
+ *  \sa Alphabet
+ */
+namespace Utf8 {
+//! Decodes the code point at i and advances i past it.
+	bool next(std::string::const_iterator& i, const std::string::const_iterator end, char32_t& codePoint);
+//! Appends the UTF-8 encoding of a code point to a string.
+	void append(std::string& s, const char32_t codePoint);
+//! Tells whether a code point is a letter that may appear in words.
+	bool isLetter(const char32_t c);
+//! Tells whether a code point is a combining diacritical mark.
+	bool isMark(const char32_t c);
+//! Maps upper case letters to lower case.
+	char32_t foldCase(const char32_t c);
+//! The precomposed form of a letter and a combining mark, or 0.
+	char32_t compose(const char32_t base, const char32_t mark);
+//! Decodes a string into normalized code points.
+	bool normalize(const std::string& in, std::u32string& out, const bool foldCase);
+//! Finds the words of a text as byte offsets and lengths.
+	void findWords(const std::string& text, std::vector<std::pair<std::size_t, std::size_t>>& words);
+} // namespace Utf8
+
+#endif
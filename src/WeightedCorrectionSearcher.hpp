@@ -0,0 +1,128 @@
+/* WeightedCorrectionSearcher.hpp
+   Beam-search for corrections with per-character edit costs.
+*/
+
+#include "Searcher.hpp"
+#include "CostMatrix.hpp"
+#include <string>
+#include <algorithm>
+
+#ifndef __WEIGHTEDCORRECTIONSEARCHER_HPP__
+#define __WEIGHTEDCORRECTIONSEARCHER_HPP__
+
+/*! Modular beam-search in tris with weighted edit operations.
+ *
+ * This Searcher works like CorrectionSearcher , but takes the cost of
+ * every edit operation from a CostMatrix instead of counting one per
+ * operation, and prunes the search on the summed cost rather than on
+ * the number of operations. A keyboard slip can then cost less than an
+ * unlikely substitution, so a tight cost budget finds the likely
+ * corrections while exploring much less of the Tri than a unit edit
+ * distance that is large enough to find them.
+ * The length and letter pre-filters of CorrectionSearcher are used as
+ * well, scaled by the lowest cost of the operations that could make
+ * up for the difference.
+ *
+ * Results carry both their summed cost and the number of edit
+ * operations of the cheapest way they were found.
+ * \sa CostMatrix
+ * \sa CorrectionSearcher
+ */
+class WeightedCorrectionSearcher : public Searcher<WeightedCorrectionSearcher> {
+public:
+//! Data tuples that are put on the stack to perform the search.
+	/*! These are the items of CorrectionSearcher with an
+	  additional summed cost.
+	*/
+	template<typename state_T>
+	struct item {
+		const state_T& stateData; /*!< Contains transition and
+					    end state information. */
+		const unsigned int state; /*!< The current state name
+					    (as a number). */
+		const unsigned int editDistance; /*!< Number of edit
+						   operations necessary for this
+						   item to have been produced. */
+		const double cost; /*!< Summed cost of those edit
+				     operations. */
+		std::string::const_iterator nextChar; /*!< Iterator
+						       * pointing to the next char in the original input
+						       * string. */
+		const unsigned int depth; /*!< The length of the
+					    correction candidate that has
+					    been built so far. */
+
+		item() = delete;
+//! All member fields must be provided with values.
+		item(const state_T& newStateData, const unsigned int newState, const unsigned int newEditDistance,
+		     const double newCost, std::string::const_iterator newNextChar, const unsigned int newDepth)
+			: stateData(newStateData), state(newState), editDistance(newEditDistance), cost(newCost),
+			  nextChar(newNextChar), depth(newDepth) {}
+	};
+//! The search stack, see Searcher::stack .
+	template <typename state_T>
+	using itemStack = std::stack<item<state_T>, std::vector<item<state_T>>>;
+
+private:
+	const std::string _word; /*!< The original input string,
+				   possibly misspelled. */
+	const CostMatrix& _costs; /*!< Costs of the edit operations. */
+	const double _maxCost; /*!< The highest summed cost for any
+				 item to be legal. */
+	const double _minLengthCost; /*!< Lowest cost of changing the
+				       length by one: min(insertion,
+				       deletion). */
+	const double _minReplaceCost; /*!< Lowest cost of getting rid
+					of an input character:
+					min(substitution, deletion). */
+	result_type _results; /*!< Successful corrections and their
+				data are stored here. */
+	SearchStats _stats; /*!< Instrumentation counters. */
+
+//! Checks the cost budget and pre-filters for a new item.
+	template <typename state_T>
+	bool _viable(const state_T& newStateData, std::string::const_iterator newNextChar, const double newCost);
+//! Creates an item and pushes it, if it is viable.
+	template <typename state_T>
+	void _push(itemStack<state_T>& s, const state_T& newStateData, const unsigned int newState,
+		   const item<state_T>& top, const unsigned int edits, const double opCost, std::string::const_iterator newNextChar, const unsigned int appended);
+
+public:
+	WeightedCorrectionSearcher() = delete;
+	WeightedCorrectionSearcher(const WeightedCorrectionSearcher&) = delete;
+/*! Creates a searcher for a word.
+  \param w The word to be corrected.
+  \param costs Costs of the edit operations; must outlive the searcher.
+  \param maxCost The highest summed cost of any result.
+*/
+	WeightedCorrectionSearcher(const std::string w, const CostMatrix& costs, const double maxCost)
+		: _word(w), _costs(costs), _maxCost(maxCost),
+		  _minLengthCost(std::min(costs.minInsertion(), costs.minDeletion())),
+		  _minReplaceCost(std::min(costs.minSubstitution(), costs.minDeletion())),
+		  _results(), _stats() {}
+
+//! Creates the initial item to seed a stack for further searching.
+	template <typename state_T>
+	item<state_T> initialItem(const unsigned int startState, const std::vector<state_T>& v) const;
+
+//! Examines the top item and pushes the items for all edit
+//! operations that stay within the cost budget.
+	template <typename state_T>
+	void feedStack(itemStack<state_T>& s, const std::vector<state_T>& v, const item<state_T>& top);
+//! Extract the end states of the corrections found during search.
+	const result_type& getResults() const {
+		return _results;
+	}
+//! Counters of the work done and pruned during search.
+	const SearchStats& getStats() const {
+		return _stats;
+	}
+}; // WeightedCorrectionSearcher
+
+#define item WeightedCorrectionSearcher::item
+
+#include "WeightedCorrectionSearcher.tpp.hpp"
+
+#undef item
+
+#endif
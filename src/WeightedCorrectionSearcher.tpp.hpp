@@ -0,0 +1,130 @@
+
+/*! Summed costs are compared with a little slack, so that e.g. two
+ *  operations of cost 0.5 still fit a budget of 1 after float rounding. */
+const double costTolerance = 1e-6;
+
+/*! Like CorrectionSearcher::_viable , but every character that the
+ *  length or letter filter says must be added or removed costs at
+ *  least the lowest cost of an operation that could do so.
+ \param newStateData The state the new item would be in.
+ \param newNextChar The input position the new item would be at.
+ \param newCost The summed cost of the new item.
+ \return False if the item cannot lead to a result within the budget.
+*/
+template <typename state_T>
+bool WeightedCorrectionSearcher::_viable(const state_T& newStateData, std::string::const_iterator newNextChar, const double newCost) {
+	if(newCost > _maxCost + costTolerance) {
+		return false;
+	}
+	const double budget(_maxCost + costTolerance - newCost);
+	const unsigned int remaining(_word.cend() - newNextChar);
+	if((remaining > newStateData.maxDepth && (remaining - newStateData.maxDepth) * _minLengthCost > budget)
+	   || (newStateData.minDepth > remaining && (newStateData.minDepth - remaining) * _minLengthCost > budget)) {
+		++_stats.prunedLength;
+		return false;
+	}
+	if(_minReplaceCost > 0) {
+		double missing(0);
+		for(auto c(newNextChar); c != _word.cend(); ++c) {
+			if(!(newStateData.letters & letterBit(*c)) && (missing += _minReplaceCost) > budget) {
+				++_stats.prunedLetters;
+				return false;
+			}
+		}
+	}
+	return true;
+} // _viable
+
+/*! \param s The stack.
+ \param newStateData State information of the new item.
+ \param newState The name(as number) of the state of the new item.
+ \param top The current item.
+ \param edits 1 for an edit operation, 0 for no-operation.
+ \param opCost The cost of the edit operation.
+ \param newNextChar The input position of the new item.
+ \param appended The number of characters appended to the candidate.
+*/
+template <typename state_T>
+void WeightedCorrectionSearcher::_push(itemStack<state_T>& s, const state_T& newStateData, const unsigned int newState,
+				       const item<state_T>& top, const unsigned int edits, const double opCost, std::string::const_iterator newNextChar, const unsigned int appended) {
+	const double newCost(top.cost + opCost);
+	if(!_viable(newStateData, newNextChar, newCost)) {
+		return;
+	}
+	++_stats.itemsPushed;
+	s.push(item<state_T>(newStateData,
+			     newState,
+			     top.editDistance + edits,
+			     newCost,
+			     newNextChar,
+			     top.depth + appended));
+} // _push
+
+template <typename state_T>
+item<state_T> WeightedCorrectionSearcher::initialItem(const unsigned int startState, const std::vector<state_T>& v) const {
+	return item<state_T>(v[startState],
+			     startState,
+			     0,
+			     0.0,
+			     _word.cbegin(),
+			     0);
+}
+
+/*! Pushes the same kinds of items as CorrectionSearcher::feedStack ,
+ *  each with the cost of its operation from the CostMatrix. A
+ *  substitution of a character by itself is not pushed, since the
+ *  no-operation item covers it. Results keep the lowest cost they were
+ *  found with.
+ \param s A stack of items; this will be updated destructively.
+ \param v A vector that provides a mapping from state numbers to state
+ data.
+ \param top The item that will be examined.
+*/
+template <typename state_T>
+void WeightedCorrectionSearcher::feedStack(itemStack<state_T>& s, const std::vector<state_T>& v, const item<state_T>& top) {
+	++_stats.itemsExpanded;
+	const bool atEnd(top.nextChar == _word.cend());
+	if(atEnd && top.stateData.endState) {
+		hit_type* found(_results.find(top.state));
+		if(!found) {
+			const hit_type hit = {top.state, top.editDistance, top.cost};
+			_results.insert(hit);
+		} else if(found->cost > top.cost + costTolerance
+			  || (found->cost >= top.cost - costTolerance && found->editDistance > top.editDistance)) {
+			found->editDistance = top.editDistance;
+			found->cost = top.cost;
+		}
+	} // if success
+
+	if(!atEnd) {
+		const unsigned char typed(*top.nextChar);
+// deletion of the typed character
+		_push(s, top.stateData, top.state, top, 1, _costs.deletion(typed), top.nextChar + 1, 0);
+	}
+	for(auto t(top.stateData.transitions.cbegin()); t != top.stateData.transitions.cend(); ++t) {
+		const unsigned char c(t->first);
+		const state_T& next(v[t->second]);
+// insertion of a character the writer left out
+		_push(s, next, t->second, top, 1, _costs.insertion(c), top.nextChar, 1);
+		if(atEnd) continue;
+		const unsigned char typed(*top.nextChar);
+		if(c != typed) {
+			_push(s, next, t->second, top, 1, _costs.substitution(typed, c), top.nextChar + 1, 1);
+		}
+// transposition: the input has typed, c; the word has c, typed
+		auto right(top.nextChar + 1);
+		if(right != _word.cend() && *right == c && c != typed) {
+			auto after(next.transitions.find(typed));
+			if(after != next.transitions.cend()) {
+				_push(s, v[after->second], after->second, top, 1, _costs.transposition(typed, c), top.nextChar + 2, 2);
+			}
+		}
+	} // for
+// no-operation last, so that it is expanded first
+	if(!atEnd) {
+		auto found(top.stateData.transitions.find(*top.nextChar));
+		if(found != top.stateData.transitions.end()) {
+			_push(s, v[found->second], found->second, top, 0, 0.0, top.nextChar + 1, 1);
+		}
+	}
+} // feedStack
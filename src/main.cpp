@@ -4,39 +4,75 @@
 */
 
 
-#include "Suggest.hpp"
+#include "Dictionaries.hpp"
+#include "CostMatrix.hpp"
+#include "BigramModel.hpp"
 #include <exception>
 #include <memory>
 #include <string>
+#include <vector>
 #include "IO.hpp"
 
 
 int main(int argc, char** argv) {
 	try {
-		std::string args("");
-		switch(argc) {
-		case 1:
+		if(argc == 1) {
 			std::cout << IO::Usage(argv[0], "No parameters given.");
 			return 0;
-		case 2:
-			args = "";
-			break;
-		case 3:
-			args = argv[1];
-			break;
-		default:
-			std::cerr << IO::Usage(argv[0], "Incorrect number of parameters.");
-			return 1;
-		} // switch
+		}
+// the last argument is the corpus; before it there may be one string
+// of short flags and any number of long options
+		std::string args("");
+		std::vector<std::string> longOptions;
+		for(int i(1); i < argc - 1; ++i) {
+			const std::string arg(argv[i]);
+			if(arg.compare(0, 2, "--") == 0) {
+				longOptions.push_back(arg);
+			} else if(args.empty()) {
+				args = arg;
+			} else {
+				std::cerr << IO::Usage(argv[0], "Incorrect number of parameters.");
+				return 1;
+			}
+		} // for
 		
 		IO::param_t params(IO::parseCmdLineArgs(args));
+		for(auto i(longOptions.cbegin()); i != longOptions.cend(); ++i) {
+			IO::parseLongOption(params, *i);
+		}
+		if((params.flags & IO::text) && (params.flags & (IO::tsv | IO::json | IO::sentences))) {
+			throw std::runtime_error("--text cannot be combined with -t, -j or --bigrams.");
+		}
+		if((params.flags & IO::completion) && (params.flags & (IO::text | IO::sentences | IO::budgeted))) {
+			throw std::runtime_error("--complete cannot be combined with --text, --bigrams, --max-items or --deadline.");
+		}
 		params.corpusFilename = std::string(argv[argc - 1]);
+		params.dictionaries.insert(params.dictionaries.begin(), std::make_pair(std::string("default"), params.corpusFilename));
+// the pool must outlive the dictionaries that search with it
+		std::unique_ptr<ThreadPool> pool(params.threads > 1 ? new ThreadPool(params.threads) : nullptr);
+		std::unique_ptr<CostMatrix> costs(params.costsFilename.empty() ? nullptr : new CostMatrix(params.costsFilename));
+		std::unique_ptr<BigramModel> bigrams(params.bigramsFilename.empty() ? nullptr : new BigramModel(params.bigramsFilename));
+		std::unique_ptr<Metrics> metrics(params.metricsSocket.empty() ? nullptr : new Metrics);
+		std::unique_ptr<QueryTracer> tracer(params.traceFilename.empty() ? nullptr : new QueryTracer(params.traceFilename, params.traceEvery));
 		if(params.flags & IO::probability) {
-			std::unique_ptr<ProbabilitySuggest> suggest(new ProbabilitySuggest(params.corpusFilename, params.maxEditDistance));
-			IO::loopSuggest(*suggest, params);
+			std::unique_ptr<Dictionaries<ProbabilityCorpusParser>> dictionaries(new Dictionaries<ProbabilityCorpusParser>);
+			IO::loadDictionaries(*dictionaries, params, pool.get(), costs.get(), bigrams.get());
+// the server reads the dictionaries, so it stops before they go
+			std::unique_ptr<MetricsServer> server;
+			if(metrics) {
+				IO::watchDictionaries(*metrics, *dictionaries);
+				server.reset(new MetricsServer(*metrics, params.metricsSocket));
+			}
+			IO::loopSuggest(*dictionaries, params, pool.get(), metrics.get(), tracer.get());
 		} else if(params.flags & IO::simple) {
-			std::unique_ptr<SimpleSuggest> suggest(new SimpleSuggest(params.corpusFilename, params.maxEditDistance));
-			IO::loopSuggest(*suggest, params);
+			std::unique_ptr<Dictionaries<SimpleCorpusParser>> dictionaries(new Dictionaries<SimpleCorpusParser>);
+			IO::loadDictionaries(*dictionaries, params, pool.get(), costs.get(), bigrams.get());
+			std::unique_ptr<MetricsServer> server;
+			if(metrics) {
+				IO::watchDictionaries(*metrics, *dictionaries);
+				server.reset(new MetricsServer(*metrics, params.metricsSocket));
+			}
+			IO::loopSuggest(*dictionaries, params, pool.get(), metrics.get(), tracer.get());
 		}
 	} catch(ParseError& E) {
 		// don't print usage info
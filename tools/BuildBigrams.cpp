@@ -0,0 +1,37 @@
+/* BuildBigrams.cpp
+   Compiles a bigram corpus into a model file for dym --bigrams.
+*/
+
+#include "../src/BigramModel.hpp"
+#include "../src/CorpusParser.hpp"
+#include <fstream>
+#include <iostream>
+
+int main(int argc, char** argv) {
+	if(argc != 3) {
+		std::cerr << "Usage: " << argv[0] << " BIGRAMFILE MODELFILE" << std::endl
+			  << "Reads lines PREVIOUS<TAB>NEXT<TAB>LOGPROB (see script/bigrams.py) and writes a model." << std::endl;
+		return 1;
+	}
+	std::ifstream in(argv[1]);
+	if(!in.is_open()) {
+		std::cerr << "Could not open '" << argv[1] << "'." << std::endl;
+		return 1;
+	}
+	std::ofstream out(argv[2], std::ios::binary);
+	if(!out.is_open()) {
+		std::cerr << "Could not create '" << argv[2] << "'." << std::endl;
+		return 1;
+	}
+	try {
+		BigramModel::build(in, argv[1], out);
+		out.close();
+		const BigramModel model(argv[2]);
+		std::cout << argv[2] << ": " << model.getWords() << " words, " << model.getPairs() << " pairs, "
+			  << model.getBytes() << " bytes" << std::endl;
+	} catch(std::exception& e) {
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,295 @@
+/* DiffSearch.cpp
+   Compares the suggestions of every search engine with those of a
+   brute-force reference, which measures the distance from a query to
+   every word of the corpus, on random queries at edit distances 0 to
+   3.
+*/
+
+#include "../src/Suggest.hpp"
+#include "../src/Utf8.hpp"
+#include <random>
+#include <map>
+#include <set>
+#include <functional>
+#include <iomanip>
+
+//! Words and their edit distances, as found by a search.
+typedef std::map<std::u32string, unsigned int> found_T;
+
+/*! The reference for all searches: every word of a corpus, compared
+ *  with the query one after the other. */
+class Oracle {
+private:
+	std::vector<std::u32string> _words; /*!< The normalized words of
+					      the corpus. */
+public:
+/*! Reads the words of a corpus with probabilities.
+  \param corpusFilename The corpus.
+*/
+	explicit Oracle(const std::string& corpusFilename) : _words() {
+		std::ifstream corpus(corpusFilename);
+		ProbabilityCorpusParser parser(corpusFilename);
+		for(std::string line; std::getline(corpus, line);) {
+			if(line.empty()) continue;
+			_words.emplace_back();
+			Utf8::normalize(parser.parseLine(line).first, _words.back(), false);
+		}
+	}
+/*! The fewest unit insertions, deletions, substitutions and swaps of
+ *  adjacent characters that turn a into b, where no character is
+ *  edited again after a swap (optimal string alignment). This is the
+ *  distance that the searches of the Tri find: an item that swaps two
+ *  characters moves past both of them.
+  \param a The code points of one word.
+  \param b The code points of another.
+  \param maxDistance Distances above this are not needed.
+  \return The distance, or maxDistance + 1 if it is greater than
+  maxDistance.
+*/
+	static unsigned int distance(const std::u32string& a, const std::u32string& b, const unsigned int maxDistance) {
+		const std::size_t n(a.size()), m(b.size());
+		if((n > m ? n - m : m - n) > maxDistance) {
+			return maxDistance + 1;
+		}
+		std::vector<std::vector<unsigned int>> rows(n + 1, std::vector<unsigned int>(m + 1));
+		for(std::size_t j(0); j <= m; ++j) {
+			rows[0][j] = j;
+		}
+		for(std::size_t i(1); i <= n; ++i) {
+			rows[i][0] = i;
+			unsigned int least(rows[i][0]);
+			for(std::size_t j(1); j <= m; ++j) {
+				unsigned int d(std::min(rows[i - 1][j - 1] + (a[i - 1] != b[j - 1]), std::min(rows[i - 1][j], rows[i][j - 1]) + 1));
+				if(i > 1 && j > 1 && a[i - 1] == b[j - 2] && a[i - 2] == b[j - 1]) {
+					d = std::min(d, rows[i - 2][j - 2] + 1);
+				}
+				rows[i][j] = d;
+				least = std::min(least, d);
+			}
+// a swap reaches back two rows, so both must be above the bound
+			if(least > maxDistance && (i < 2 || *std::min_element(rows[i - 1].cbegin(), rows[i - 1].cend()) > maxDistance)) {
+				return maxDistance + 1;
+			}
+		}
+		return std::min(rows[n][m], maxDistance + 1);
+	} // distance
+/*! Finds all words within an edit distance of a query.
+  \param query The normalized query.
+  \param maxDistance The edit distance.
+  \return The words with their distances.
+*/
+	found_T find(const std::u32string& query, const unsigned int maxDistance) const {
+		found_T found;
+		for(auto w(_words.cbegin()); w != _words.cend(); ++w) {
+			const unsigned int d(distance(query, *w, maxDistance));
+			if(d <= maxDistance) {
+				found[*w] = d;
+			}
+		}
+		return found;
+	} // find
+	const std::vector<std::u32string>& getWords() const {
+		return _words;
+	}
+}; // Oracle
+
+/*! Normalizes the words of search results like those of the Oracle.
+  \param results The results of a search.
+  \return Their words and edit distances.
+*/
+template <class iterator_T>
+static found_T normalized(iterator_T begin, const iterator_T end) {
+	found_T found;
+	for(; begin != end; ++begin) {
+		std::u32string w;
+		Utf8::normalize(begin->first, w, false);
+		found[w] = begin->editDistance;
+	}
+	return found;
+} // normalized
+
+//! A way to search, with the options it needs.
+struct Variant {
+	const char* name; /*!< For the output. */
+	std::function<void(SuggestOptions&)> configure; /*!< Changes the
+							  default options. */
+	std::function<found_T(const ProbabilitySuggest&, const std::string&)> ask; /*!< Searches for a query. */
+};
+
+/*! Makes a random query: a word of the corpus with up to four random
+ *  edit operations, or, once in a while, random letters.
+  \param words The words of the corpus.
+  \param letters The letters to insert and substitute.
+  \param rng The random number generator to use.
+  \return The query in UTF-8.
+*/
+static std::string randomQuery(const std::vector<std::u32string>& words, const std::u32string& letters, std::mt19937& rng) {
+	std::u32string q;
+	if(rng() % 10 == 0) {
+		for(unsigned int length(rng() % 6); length > 0; --length) {
+			q.push_back(letters[rng() % letters.size()]);
+		}
+	} else {
+		q = words[rng() % words.size()];
+		for(unsigned int edits(rng() % 5); edits > 0; --edits) {
+			const std::size_t at(q.empty() ? 0 : rng() % q.size());
+			const char32_t c(letters[rng() % letters.size()]);
+			switch(rng() % 4) {
+			case 0:
+				if(!q.empty()) q[at] = c;
+				break;
+			case 1:
+				q.insert(q.begin() + at, c);
+				break;
+			case 2:
+				if(!q.empty()) q.erase(q.begin() + at);
+				break;
+			default:
+				if(at + 1 < q.size()) std::swap(q[at], q[at + 1]);
+			}
+		}
+	}
+	std::string utf8;
+	for(auto c(q.cbegin()); c != q.cend(); ++c) {
+		Utf8::append(utf8, *c);
+	}
+	return utf8;
+} // randomQuery
+
+int main(int argc, char** argv) {
+	if(argc < 2) {
+		std::cerr << "Usage: " << argv[0] << " CORPUSFILE [QUERIES] [SEED]" << std::endl;
+		return 1;
+	}
+	const std::string corpusFilename(argv[1]);
+	const unsigned int queryCount(argc > 2 ? std::stoi(argv[2]) : 200);
+	const unsigned int seed(argc > 3 ? std::stoul(argv[3]) : 772451);
+	const unsigned int maxDistance(3);
+	if(!std::ifstream(corpusFilename).is_open()) {
+		std::cerr << "Could not open '" << corpusFilename << "'." << std::endl;
+		return 1;
+	}
+	const Oracle oracle(corpusFilename);
+	if(oracle.getWords().empty()) {
+		std::cerr << "No words in '" << corpusFilename << "'." << std::endl;
+		return 1;
+	}
+
+	std::u32string letters;
+	{
+		std::set<char32_t> seen;
+		for(auto w(oracle.getWords().cbegin()); w != oracle.getWords().cend(); ++w) {
+			seen.insert(w->cbegin(), w->cend());
+		}
+		letters.assign(seen.cbegin(), seen.cend());
+	}
+	std::mt19937 rng(seed);
+	std::vector<std::string> queries(1, std::string());
+	while(queries.size() < queryCount) {
+		queries.push_back(randomQuery(oracle.getWords(), letters, rng));
+	}
+// the reference results at the largest distance hold those of all
+// smaller ones
+	std::vector<found_T> expected;
+	for(auto q(queries.cbegin()); q != queries.cend(); ++q) {
+		std::u32string query;
+		Utf8::normalize(*q, query, false);
+		expected.push_back(oracle.find(query, maxDistance));
+	}
+
+	ThreadPool pool(4);
+	auto ranked = [](const ProbabilitySuggest& s, const std::string& q) {
+		const auto v(s.ranked(q));
+		return normalized(v.cbegin(), v.cend());
+	};
+	const Variant variants[] = {
+		{"trie", [](SuggestOptions&) {}, ranked},
+		{"split", [](SuggestOptions& o) { o.engine = Engine::split; }, ranked},
+		{"radix", [](SuggestOptions& o) { o.engine = Engine::radix; }, ranked},
+		{"parallel", [&pool](SuggestOptions& o) { o.pool = &pool; }, ranked},
+		{"quantized", [](SuggestOptions& o) { o.quantize = true; }, ranked},
+		{"qgrams", [](SuggestOptions& o) { o.qgrams = 2; }, ranked},
+		{"misscache", [](SuggestOptions& o) { o.missCache = 1000; },
+		 [](const ProbabilitySuggest& s, const std::string& q) {
+// the second time, a miss is answered from the cache
+				s.ranked(q);
+				const auto v(s.ranked(q));
+				return normalized(v.cbegin(), v.cend());
+			}},
+		{"budget", [](SuggestOptions&) {},
+		 [](const ProbabilitySuggest& s, const std::string& q) {
+				SearchBudget unlimited;
+				const auto v(s.ranked(q, unlimited));
+				return normalized(v.cbegin(), v.cend());
+			}},
+		{"nearest", [](SuggestOptions&) {},
+		 [](const ProbabilitySuggest& s, const std::string& q) {
+				const auto v(s.top(q, ~0u));
+				return normalized(v.cbegin(), v.cend());
+			}},
+		{"shared", [](SuggestOptions&) {},
+		 [](const ProbabilitySuggest& s, const std::string& q) {
+				const auto v(s.rankedShared(q));
+				return normalized(v->cbegin(), v->cend());
+			}},
+		{"buffer", [](SuggestOptions&) {},
+		 [](const ProbabilitySuggest& s, const std::string& q) {
+// one Buffer for all queries, as a thread would keep it
+				static ProbabilitySuggest::Buffer buffer;
+				s.all(q, buffer);
+				found_T found;
+				for(auto r(buffer.results.cbegin()); r != buffer.results.cend(); ++r) {
+					std::u32string w;
+					Utf8::normalize(*r->word, w, false);
+					found[w] = r->editDistance;
+				}
+				return found;
+			}}
+	};
+
+	std::cout << corpusFilename << ": " << oracle.getWords().size() << " words, " << queries.size()
+		  << " queries, seed " << seed << std::endl;
+	std::cout << "engine\tdist\tresults\tdiffering" << std::endl;
+	unsigned long differing(0), reported(0);
+	for(auto variant(std::begin(variants)); variant != std::end(variants); ++variant) {
+		for(unsigned int d(0); d <= maxDistance; ++d) {
+			SuggestOptions options(d);
+			variant->configure(options);
+			const ProbabilitySuggest dictionary(corpusFilename, options);
+			unsigned long results(0), wrong(0);
+			for(std::size_t q(0); q < queries.size(); ++q) {
+				found_T want;
+				for(auto e(expected[q].cbegin()); e != expected[q].cend(); ++e) {
+					if(e->second <= d) want.insert(*e);
+				}
+				const found_T got(variant->ask(dictionary, queries[q]));
+				results += got.size();
+				if(got == want) continue;
+				++wrong;
+				if(reported++ >= 20) continue;
+// name the first word that is missing, extra or at another distance
+				std::cout << variant->name << " at " << d << ", '" << queries[q] << "': ";
+				auto g(got.cbegin());
+				auto w(want.cbegin());
+				while(g != got.cend() && w != want.cend() && *g == *w) {
+					++g;
+					++w;
+				}
+				const bool missing(g == got.cend() || (w != want.cend() && w->first <= g->first));
+				const std::pair<const std::u32string, unsigned int>& entry(missing ? *w : *g);
+				std::string word;
+				for(auto c(entry.first.cbegin()); c != entry.first.cend(); ++c) {
+					Utf8::append(word, *c);
+				}
+				std::cout << (missing ? "expected '" : "did not expect '") << word << "' at " << entry.second
+					  << std::endl;
+			} // for q
+			std::cout << variant->name << '\t' << d << '\t' << results << '\t' << wrong << std::endl;
+			differing += wrong;
+		} // for d
+	} // for variant
+	if(differing) {
+		std::cout << differing << " searches differ from the reference" << std::endl;
+	}
+	return differing ? 1 : 0;
+}
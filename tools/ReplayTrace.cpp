@@ -0,0 +1,197 @@
+/* ReplayTrace.cpp
+   Runs the queries of a trace written by dym --trace against a
+   dictionary, with the options of dym, as fast as possible or at the
+   times they were recorded, and reports latency percentiles.
+*/
+
+#include "../src/Dictionaries.hpp"
+#include "../src/CostMatrix.hpp"
+#include "../src/IO.hpp"
+#include <algorithm>
+#include <iomanip>
+#include <thread>
+
+//! The names of the QueryModes, for the output.
+static const char* const modeNames[queryModes] = {"all", "best", "complete"};
+
+//! The latencies of a set of queries.
+struct Latencies {
+	std::vector<double> replayed; /*!< Microseconds, as replayed. */
+	std::vector<double> recorded; /*!< Microseconds, as recorded. */
+	unsigned long failed; /*!< Queries that failed in the replay. */
+	unsigned long differing; /*!< Queries with another number of
+				   results than recorded. */
+};
+
+/*! The latency below which a share of the queries are.
+ \param sorted Latencies, ascending.
+ \param q The share, between 0 and 1.
+ \return The latency, or 0 if there are none.
+*/
+static double percentile(const std::vector<double>& sorted, const double q) {
+	if(sorted.empty()) {
+		return 0;
+	}
+	const std::size_t rank(std::size_t(std::ceil(q * sorted.size())));
+	return sorted[rank ? rank - 1 : 0];
+} // percentile
+
+/*! Answers a query of a trace like dym would, without printing.
+ \param dictionaries The dictionaries.
+ \param record The query.
+ \param maxEditDistance The edit distance of completions.
+ \return The number of suggestions.
+*/
+template <typename parser_T>
+static std::size_t answer(const Dictionaries<parser_T>& dictionaries, const TraceRecord& record, const unsigned int maxEditDistance) {
+	std::string names, word;
+	IO::splitRequest(record.line, names, word);
+	const auto selection(dictionaries.select(names));
+	switch(record.mode) {
+	case QueryMode::complete:
+		return dictionaries.complete(selection, word, record.count ? record.count : 10, maxEditDistance).size();
+	case QueryMode::best:
+		if(selection.size() == 1) {
+			return selection.front()->best(word).empty() ? 0 : 1;
+		}
+		return std::min<std::size_t>(dictionaries.ranked(selection, word, nullptr, 1).size(), 1);
+	default:
+		if(selection.size() == 1) {
+			return selection.front()->all(word).size();
+		}
+		return dictionaries.ranked(selection, word).size();
+	}
+} // answer
+
+/*! Replays a trace and prints its latencies.
+ \param trace The queries of the trace.
+ \param params The options of dym to load the dictionaries with.
+ \param original Whether to keep the times of the trace; otherwise the
+ queries run one after the other.
+*/
+template <typename parser_T>
+static void replay(const std::vector<TraceRecord>& trace, const IO::param_t& params, const bool original) {
+	std::unique_ptr<ThreadPool> pool(params.threads > 1 ? new ThreadPool(params.threads) : nullptr);
+	std::unique_ptr<CostMatrix> costs(params.costsFilename.empty() ? nullptr : new CostMatrix(params.costsFilename));
+	Dictionaries<parser_T> dictionaries;
+	IO::loadDictionaries(dictionaries, params, pool.get(), costs.get(), nullptr);
+
+	Latencies byMode[queryModes + 1];
+	for(unsigned int m(0); m <= queryModes; ++m) {
+		byMode[m].failed = byMode[m].differing = 0;
+	}
+	const auto started(std::chrono::steady_clock::now());
+	for(auto r(trace.cbegin()); r != trace.cend(); ++r) {
+// at the original times, a query that has to wait for the one before
+// is late, and its latency counts from when it should have started;
+// one that is early waits, and counts from when it wakes up, as
+// sleeping is not exact
+		auto start(std::chrono::steady_clock::now());
+		if(original) {
+			const auto due(started + r->at - trace.front().at);
+			if(due > start) {
+				std::this_thread::sleep_until(due);
+				start = std::chrono::steady_clock::now();
+			} else {
+				start = due;
+			}
+		}
+		std::size_t results(0);
+		bool failed(false);
+		try {
+			results = answer(dictionaries, *r, params.maxEditDistance);
+		} catch(std::runtime_error&) {
+			failed = true;
+		}
+		const std::chrono::duration<double, std::micro> latency(std::chrono::steady_clock::now() - start);
+		for(Latencies* l : {&byMode[static_cast<unsigned int>(r->mode)], &byMode[queryModes]}) {
+			l->replayed.push_back(latency.count());
+			l->recorded.push_back(r->latency.count() * 1e-3);
+			l->failed += failed;
+			l->differing += !failed && results != r->results;
+		}
+	} // for r
+	const std::chrono::duration<double> took(std::chrono::steady_clock::now() - started);
+
+	std::cout << "replayed in " << std::fixed << std::setprecision(2) << took.count() << " s, "
+		  << (original ? "at the recorded times" : "one query after the other") << std::endl;
+	std::cout << "mode\tqueries\tfailed\tdiffer\tp50 us\tp90 us\tp99 us\tp99.9 us\tmax us\tmean us\trecorded p50\trecorded p99"
+		  << std::endl;
+	for(unsigned int m(0); m <= queryModes; ++m) {
+		Latencies& l(byMode[m]);
+		if(l.replayed.empty()) continue;
+		std::sort(l.replayed.begin(), l.replayed.end());
+		std::sort(l.recorded.begin(), l.recorded.end());
+		double sum(0);
+		for(auto t(l.replayed.cbegin()); t != l.replayed.cend(); ++t) {
+			sum += *t;
+		}
+		std::cout << (m < queryModes ? modeNames[m] : "total") << '\t' << l.replayed.size() << '\t' << l.failed << '\t'
+			  << l.differing << std::setprecision(1);
+		for(const double q : {0.5, 0.9, 0.99, 0.999}) {
+			std::cout << '\t' << percentile(l.replayed, q);
+		}
+		std::cout << '\t' << l.replayed.back() << '\t' << sum / l.replayed.size() << '\t' << percentile(l.recorded, 0.5)
+			  << '\t' << percentile(l.recorded, 0.99) << std::endl;
+	}
+} // replay
+
+int main(int argc, char** argv) {
+	if(argc < 3) {
+		std::cerr << "Usage: " << argv[0] << " [-seN] [--OPTION=VALUE ...] [--timing=fast|original] TRACEFILE CORPUSFILE"
+			  << std::endl;
+		return 1;
+	}
+	try {
+		std::string args;
+		bool original(false);
+		std::vector<std::string> longOptions;
+		for(int i(1); i < argc - 2; ++i) {
+			const std::string arg(argv[i]);
+			if(arg == "--timing=original" || arg == "--timing=fast") {
+				original = arg == "--timing=original";
+			} else if(arg.compare(0, 2, "--") == 0) {
+				longOptions.push_back(arg);
+			} else if(args.empty()) {
+				args = arg;
+			} else {
+				throw std::runtime_error("Incorrect number of parameters.");
+			}
+		}
+		IO::param_t params(IO::parseCmdLineArgs(args));
+		for(auto i(longOptions.cbegin()); i != longOptions.cend(); ++i) {
+			IO::parseLongOption(params, *i);
+		}
+		params.corpusFilename = argv[argc - 1];
+		params.dictionaries.insert(params.dictionaries.begin(), std::make_pair(std::string("default"), params.corpusFilename));
+
+		std::vector<TraceRecord> trace;
+		TraceReader reader(argv[argc - 2]);
+		unsigned int maxDistance(0);
+		for(TraceRecord r; reader.next(r);) {
+			maxDistance = std::max(maxDistance, r.distance);
+			trace.push_back(r);
+		}
+		if(trace.empty()) {
+			std::cerr << "No queries in '" << argv[argc - 2] << "'." << std::endl;
+			return 1;
+		}
+// without -eN, the dictionaries search as far as the trace did
+		if(args.find('e') == std::string::npos) {
+			params.maxEditDistance = maxDistance;
+		}
+		const std::chrono::duration<double> span(trace.back().at - trace.front().at);
+		std::cout << argv[argc - 2] << ": " << trace.size() << " queries over " << std::fixed << std::setprecision(2)
+			  << span.count() << " s; " << params.corpusFilename << " at edit distance " << params.maxEditDistance
+			  << std::endl;
+		if(params.flags & IO::simple) {
+			replay<SimpleCorpusParser>(trace, params, original);
+		} else {
+			replay<ProbabilityCorpusParser>(trace, params, original);
+		}
+	} catch(std::exception& e) {
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+	return 0;
+}